@@ -11,10 +11,16 @@
  * @warning Для корректной работы требуется русская локаль
  */
 #include "RouteCipher.h"
+#include "RouteKernels.h"
+#include "../BufferArena.h"
+#include "../LatencyHistogram.h"
 #include <algorithm>
 #include <cctype>
 #include <locale>
 #include <iostream>
+#include <thread>
+#include <cstdint>
+#include <type_traits>
 
 /**
  * @brief Конструктор класса RouteCipher
@@ -26,18 +32,29 @@ RouteCipher::RouteCipher(int Key) {
     Columns = Key;
 }
 
+/**
+ * @brief Задаёт сторону блока при транспонировании таблицы
+ * @param Size Сторона блока в символах
+ * @throws CipherError если Size равен 0
+ */
+void RouteCipher::SetTile(size_t Size) {
+    if (Size == 0) {
+        throw CipherError("Размер блока должен быть положительным");
+    }
+    Tile = Size;
+}
+
 /**
  * @brief Проверяет корректность ключа шифрования
  * @param Key Проверяемый ключ
- * @throws CipherError если ключ ≤ 0 или > 50
+ * @throws CipherError если ключ ≤ 0
+ * @details Верхнего предела нет: таблица хранится одной строкой и
+ *          транспонируется блоками, поэтому широкие таблицы не хуже узких
  */
 void RouteCipher::ValidateKey(int Key) {
     if (Key <= 0) {
         throw CipherError("Ключ должен быть положительным числом");
     }
-    if (Key > 50) {
-        throw CipherError("Слишком большой ключ");
-    }
 }
 
 /**
@@ -62,7 +79,7 @@ std::wstring RouteCipher::CleanText(const std::wstring& Text) {
     std::wstring Result;
     for (wchar_t c : Text) {
         // Убираем только пробелы, табуляции, новые строки
-        if (c != L' ' && c != L'\t' && c != L'\n' && c != L'\r') {
+        if (!IsBlank(c)) {
             Result += c;
         }
     }
@@ -83,19 +100,8 @@ std::wstring RouteCipher::ToUpperCase(const std::wstring& Text) {
     std::wstring Result = Text;
     
     for (wchar_t& c : Result) {
-        // Английские буквы
-        if (c >= L'a' && c <= L'z') {
-            c = c - L'a' + L'A';
-        }
-        // Русские буквы
-        else if (c >= L'а' && c <= L'я') {
-            c = c - L'а' + L'А';
-        }
-        // Особые русские буквы
-        else if (c == L'ё') {
-            c = L'Ё';
-        }
-        // Все остальные символы (цифры, знаки препинания) остаются как есть
+        // Цифры и знаки препинания остаются как есть
+        c = UpperChar(c);
     }
     
     return Result;
@@ -115,6 +121,218 @@ std::wstring RouteCipher::PrepareText(const std::wstring& Text) {
     return ToUpperCase(Cleaned);
 }
 
+/**
+ * @brief Подготавливает текст и дополняет его до полной таблицы
+ * @param Text Исходный текст
+ * @param Rows Результат: количество строк таблицы
+ * @param Length Результат: длина подготовленного текста
+ * @return Таблица Rows×Columns, записанная по строкам, с заполнителем 'X'
+ * @throws CipherError если текст пустой или содержит только пробелы
+ */
+std::wstring RouteCipher::PrepareTable(const std::wstring& Text, size_t& Rows, size_t& Length) {
+    ValidateText(Text);
+    std::wstring Table = PrepareText(Text);
+    size_t Cols = static_cast<size_t>(Columns);
+    Length = Table.length();
+    Rows = (Length + Cols - 1) / Cols; // Округление вверх
+    Table.resize(Rows * Cols, L'X');
+    return Table;
+}
+
+/**
+ * @brief Проверяет наличие суррогатных пар в тексте UTF-16
+ * @param Text Текст
+ * @return true, если в тексте есть символы вне BMP
+ */
+static bool HasSurrogates(const std::u16string& Text) {
+    for (char16_t c : Text) {
+        if (c >= 0xD800 && c <= 0xDFFF) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Перевод текста UTF-16 в std::wstring с объединением суррогатных пар
+ * @param Text Текст в UTF-16
+ * @return Текст по одному wchar_t на символ
+ */
+static std::wstring FromUtf16(const std::u16string& Text) {
+    std::wstring Result;
+    Result.reserve(Text.size());
+    for (size_t i = 0; i < Text.size(); i++) {
+        char32_t c = Text[i];
+        if (c >= 0xD800 && c <= 0xDBFF && i + 1 < Text.size() &&
+            Text[i + 1] >= 0xDC00 && Text[i + 1] <= 0xDFFF) {
+            c = 0x10000 + ((c - 0xD800) << 10) + (Text[++i] - 0xDC00);
+        }
+        Result += static_cast<wchar_t>(c);
+    }
+    return Result;
+}
+
+/**
+ * @brief Перевод std::wstring в UTF-16
+ * @param Text Текст по одному wchar_t на символ
+ * @return Текст в UTF-16
+ */
+static std::u16string ToUtf16(const std::wstring& Text) {
+    std::u16string Result;
+    Result.reserve(Text.size());
+    for (wchar_t w : Text) {
+        char32_t c = static_cast<char32_t>(w);
+        if (c >= 0x10000) {
+            c -= 0x10000;
+            Result += static_cast<char16_t>(0xD800 + (c >> 10));
+            Result += static_cast<char16_t>(0xDC00 + (c & 0x3FF));
+        } else {
+            Result += static_cast<char16_t>(c);
+        }
+    }
+    return Result;
+}
+
+/**
+ * @brief Подготавливает текст в 16-битные ячейки таблицы
+ * @param Text Исходный текст
+ * @param Size Длина текста
+ * @param Cells Результат: текст без пробелов, в верхнем регистре
+ * @return true, если все символы из BMP и помещаются в char16_t
+ * @throws CipherError если после очистки текст стал пустым
+ */
+template <class Char>
+bool RouteCipher::PrepareNarrow(const Char* Text, size_t Size, std::u16string& Cells) {
+    if (Size == 0) {
+        throw CipherError("Текст не может быть пустым");
+    }
+    Cells.resize(Size);
+    size_t Length = 0;
+    uint32_t Wide = 0;
+    for (size_t i = 0; i < Size; i++) {
+        wchar_t c = static_cast<wchar_t>(Text[i]);
+        if (!IsBlank(c)) {
+            c = UpperChar(c);
+            Wide |= static_cast<uint32_t>(c);
+            Cells[Length++] = static_cast<char16_t>(c);
+        }
+    }
+    if (Length == 0) {
+        throw CipherError("После удаления пробелов текст пуст");
+    }
+    Cells.resize(Length);
+    return Wide <= 0xFFFF;
+}
+
+/**
+ * @brief Переставляет подготовленный текст маршрутом по умолчанию
+ * @param Cells Подготовленный текст; дополняется 'X' до полной таблицы
+ * @param Decrypting true для дешифрования
+ * @return Переставленный текст из Rows×Columns символов
+ */
+template <class Char>
+std::basic_string<Char> RouteCipher::Transpose(std::basic_string<Char>& Cells, bool Decrypting) const {
+    size_t Cols = static_cast<size_t>(Columns);
+    size_t Rows = (Cells.size() + Cols - 1) / Cols; // Округление вверх
+    Cells.resize(Rows * Cols, Char('X'));
+
+    std::basic_string<Char> Result(Cells.size(), Char('X'));
+    if (Decrypting) {
+        // Заполняем таблицу по столбцам сверху вниз, справа налево
+        WriteColumns(Cells.data(), Rows, Cols, &Result[0], Tile);
+    } else {
+        // Читаем по столбцам сверху вниз, справа налево
+        ReadColumns(Cells.data(), Rows, Cols, &Result[0], Tile);
+    }
+    return Result;
+}
+
+/**
+ * @brief Блочное чтение таблицы по столбцам справа налево
+ * @param Table Таблица, записанная по строкам
+ * @param Rows Количество строк
+ * @param Columns Количество столбцов
+ * @param Result Результат: Rows×Columns символов
+ * @param Block Сторона квадратного блока
+ * @param Slots Места столбцов в результате или nullptr для порядка справа налево
+ */
+template <class Char>
+void RouteCipher::ReadColumns(const Char* Table, size_t Rows, size_t Columns, Char* Result, size_t Block,
+                              const size_t* Slots) {
+    if constexpr (std::is_same<Char, char16_t>::value) {
+        // Для 2-16 столбцов - ядро с перестановкой регистров
+        RouteKernel16 Kernel = Slots == nullptr ? FindReadKernel(Columns) : nullptr;
+        if (Kernel != nullptr) {
+            Kernel(Table, Rows, Result);
+            return;
+        }
+    }
+    for (size_t i0 = 0; i0 < Rows; i0 += Block) {
+        size_t i1 = std::min(Rows, i0 + Block);
+        for (size_t j0 = 0; j0 < Columns; j0 += Block) {
+            size_t j1 = std::min(Columns, j0 + Block);
+            for (size_t j = j0; j < j1; j++) {
+                Char* Out = &Result[(Slots != nullptr ? Slots[j] : Columns - 1 - j) * Rows];
+                for (size_t i = i0; i < i1; i++) {
+                    Out[i] = Table[i * Columns + j];
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Блочная запись таблицы по столбцам справа налево
+ * @param Text Текст, записываемый по столбцам
+ * @param Rows Количество строк
+ * @param Columns Количество столбцов
+ * @param Table Результат: таблица, записанная по строкам
+ * @param Block Сторона квадратного блока
+ * @param Slots Места столбцов в тексте или nullptr для порядка справа налево
+ */
+template <class Char>
+void RouteCipher::WriteColumns(const Char* Text, size_t Rows, size_t Columns, Char* Table, size_t Block,
+                               const size_t* Slots) {
+    if constexpr (std::is_same<Char, char16_t>::value) {
+        RouteKernel16 Kernel = Slots == nullptr ? FindWriteKernel(Columns) : nullptr;
+        if (Kernel != nullptr) {
+            Kernel(Text, Rows, Table);
+            return;
+        }
+    }
+    for (size_t i0 = 0; i0 < Rows; i0 += Block) {
+        size_t i1 = std::min(Rows, i0 + Block);
+        for (size_t j0 = 0; j0 < Columns; j0 += Block) {
+            size_t j1 = std::min(Columns, j0 + Block);
+            for (size_t j = j0; j < j1; j++) {
+                const Char* In = &Text[(Slots != nullptr ? Slots[j] : Columns - 1 - j) * Rows];
+                for (size_t i = i0; i < i1; i++) {
+                    Table[i * Columns + j] = In[i];
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Перестановка столбцов таблицы по карте
+ * @param Cells Таблица по строкам (шифрование) или текст по столбцам (дешифрование)
+ * @param Rows Количество строк
+ * @param Slots Slots[j] - место столбца j в тексте по столбцам
+ * @param Decrypting true для дешифрования
+ * @return Переставленный текст
+ */
+std::wstring RouteCipher::PermuteColumns(const std::wstring& Cells, size_t Rows,
+                                         const std::vector<size_t>& Slots, bool Decrypting) const {
+    std::wstring Result(Cells.size(), L'X');
+    if (Decrypting) {
+        WriteColumns(Cells.data(), Rows, Slots.size(), &Result[0], Tile, Slots.data());
+    } else {
+        ReadColumns(Cells.data(), Rows, Slots.size(), &Result[0], Tile, Slots.data());
+    }
+    return Result;
+}
+
 /**
  * @brief Шифрует текст методом маршрутной перестановки
  * @param Text Исходный текст для шифрования
@@ -122,12 +340,11 @@ std::wstring RouteCipher::PrepareText(const std::wstring& Text) {
  * @throws CipherError если текст пустой или содержит только пробелы
  * 
  * Алгоритм:
- * 1. Подготавливается текст (очистка + верхний регистр)
+ * 1. Подготавливается текст (очистка + верхний регистр) в 16-битные ячейки
  * 2. Вычисляется количество строк: Rows = ceil(TextLength / Columns)
- * 3. Создается таблица Rows×Columns
- * 4. Таблица заполняется по строкам слева направо
- * 5. Пустые ячейки заполняются символом 'X'
- * 6. Таблица считывается по столбцам справа налево, сверху вниз
+ * 3. Текст дополняется символом 'X' до Rows×Columns и служит таблицей,
+ *    записанной по строкам слева направо
+ * 4. Таблица считывается по столбцам справа налево, сверху вниз
  * 
  * Пример для Text="HELLO", Columns=3:
  *   TextLength=5, Rows=2
@@ -137,36 +354,26 @@ std::wstring RouteCipher::PrepareText(const std::wstring& Text) {
  *   Результат: "LXOLHE"
  */
 std::wstring RouteCipher::Encrypt(const std::wstring& Text) {
-    ValidateText(Text);
-    std::wstring PreparedText = PrepareText(Text);
-    
-    int TextLength = PreparedText.length();
-    int Rows = (TextLength + Columns - 1) / Columns; // Округление вверх
-    
-    // Создаем таблицу и заполняем по строкам слева направо
-    std::vector<std::vector<wchar_t>> Table(Rows, std::vector<wchar_t>(Columns));
-    
-    int index = 0;
-    for (int i = 0; i < Rows; i++) {
-        for (int j = 0; j < Columns; j++) {
-            if (index < TextLength) {
-                Table[i][j] = PreparedText[index++];
-            } else {
-                // Заполняем оставшиеся ячейки специальным символом
-                Table[i][j] = L'X';
-            }
-        }
-    }
-    
-    // Читаем по столбцам сверху вниз, справа налево
-    std::wstring Result;
-    for (int j = Columns - 1; j >= 0; j--) {
-        for (int i = 0; i < Rows; i++) {
-            Result += Table[i][j];
-        }
+    return Encrypt(Text, ColumnsRightToLeft());
+}
+
+/**
+ * @brief Шифрует текст по маршруту по умолчанию
+ * @param Text Исходный текст для шифрования
+ * @param Route Маршрут чтения таблицы
+ * @return Зашифрованный текст
+ * @throws CipherError если текст пустой или содержит только пробелы
+ */
+std::wstring RouteCipher::Encrypt(const std::wstring& Text, const ColumnsRightToLeft&) {
+    LatencyTimer Timer(LatencyOp::RouteEncrypt, Text.size() * sizeof(char16_t));
+    std::u16string Cells;
+    if (PrepareNarrow(Text.data(), Text.size(), Cells)) {
+        std::u16string Result = Transpose(Cells, false);
+        return std::wstring(Result.begin(), Result.end());
     }
-    
-    return Result;
+    // Символы вне BMP: 32-битные ячейки
+    std::wstring Wide = PrepareText(Text);
+    return Transpose(Wide, false);
 }
 
 /**
@@ -179,43 +386,452 @@ std::wstring RouteCipher::Encrypt(const std::wstring& Text) {
  * 1. Подготавливается шифротекст
  * 2. Вычисляется количество строк
  * 3. Таблица заполняется по столбцам справа налево, сверху вниз
- * 4. Таблица считывается по строкам слева направо
- * 5. Удаляются символы 'X', добавленные при шифровании
+ *    и сразу хранится по строкам, так что чтение по строкам - это она сама
+ * 4. Удаляются символы 'X', добавленные при шифровании
  */
 std::wstring RouteCipher::Decrypt(const std::wstring& Text) {
-    ValidateText(Text);
-    std::wstring PreparedText = PrepareText(Text);
-    
-    int TextLength = PreparedText.length();
-    int Rows = (TextLength + Columns - 1) / Columns;
-    
-    // Создаем пустую таблицу
-    std::vector<std::vector<wchar_t>> Table(Rows, std::vector<wchar_t>(Columns));
-    
-    // Заполняем таблицу по столбцам сверху вниз, справа налево
-    int index = 0;
-    for (int j = Columns - 1; j >= 0; j--) {
-        for (int i = 0; i < Rows; i++) {
-            if (index < TextLength) {
-                Table[i][j] = PreparedText[index++];
+    return Decrypt(Text, ColumnsRightToLeft());
+}
+
+/**
+ * @brief Дешифрует текст по маршруту по умолчанию
+ * @param Text Зашифрованный текст
+ * @param Route Маршрут чтения таблицы
+ * @return Расшифрованный текст
+ * @throws CipherError если текст пустой или содержит только пробелы
+ */
+std::wstring RouteCipher::Decrypt(const std::wstring& Text, const ColumnsRightToLeft&) {
+    LatencyTimer Timer(LatencyOp::RouteDecrypt, Text.size() * sizeof(char16_t));
+    std::u16string Cells;
+    if (PrepareNarrow(Text.data(), Text.size(), Cells)) {
+        std::u16string Result = Transpose(Cells, true);
+        // Убираем добавленные символы 'X' в конце
+        StripPadding(Result);
+        return std::wstring(Result.begin(), Result.end());
+    }
+    std::wstring Wide = PrepareText(Text);
+    std::wstring Result = Transpose(Wide, true);
+    StripPadding(Result);
+    return Result;
+}
+
+/**
+ * @brief Шифрует текст в UTF-16 методом маршрутной перестановки
+ * @param Text Исходный текст для шифрования
+ * @return Зашифрованный текст
+ * @throws CipherError если текст пустой или содержит только пробелы
+ */
+std::u16string RouteCipher::Encrypt(const std::u16string& Text) {
+    if (HasSurrogates(Text)) {
+        return ToUtf16(Encrypt(FromUtf16(Text)));
+    }
+    LatencyTimer Timer(LatencyOp::RouteEncrypt, Text.size() * sizeof(char16_t));
+    std::u16string Cells;
+    PrepareNarrow(Text.data(), Text.size(), Cells);
+    return Transpose(Cells, false);
+}
+
+/**
+ * @brief Дешифрует текст в UTF-16
+ * @param Text Зашифрованный текст
+ * @return Расшифрованный текст
+ * @throws CipherError если текст пустой или содержит только пробелы
+ */
+std::u16string RouteCipher::Decrypt(const std::u16string& Text) {
+    if (HasSurrogates(Text)) {
+        return ToUtf16(Decrypt(FromUtf16(Text)));
+    }
+    LatencyTimer Timer(LatencyOp::RouteDecrypt, Text.size() * sizeof(char16_t));
+    std::u16string Cells;
+    PrepareNarrow(Text.data(), Text.size(), Cells);
+    std::u16string Result = Transpose(Cells, true);
+    StripPadding(Result);
+    return Result;
+}
+
+/**
+ * @brief Дешифрует текст известной длины
+ * @param Text Зашифрованный текст
+ * @param Length Длина подготовленного открытого текста
+ * @return Расшифрованный текст ровно из Length символов
+ * @throws CipherError если текст пустой или короче Length
+ */
+std::wstring RouteCipher::DecryptExact(const std::wstring& Text, size_t Length) {
+    std::u16string Cells;
+    bool Narrow = PrepareNarrow(Text.data(), Text.size(), Cells);
+    if (Length > Cells.size()) {
+        throw CipherError("Шифротекст короче заявленной длины");
+    }
+    if (Narrow) {
+        std::u16string Result = Transpose(Cells, true);
+        return std::wstring(Result.begin(), Result.begin() + Length);
+    }
+    std::wstring Wide = PrepareText(Text);
+    std::wstring Result = Transpose(Wide, true);
+    Result.resize(Length);
+    return Result;
+}
+
+/**
+ * @brief Подготавливает текст в таблицу из памяти арены
+ * @param Text Исходный текст
+ * @param Arena Арена для таблицы
+ * @param Rows Результат: количество строк таблицы
+ * @return Таблица Rows×Columns, записанная по строкам, с заполнителем 'X'
+ * @throws CipherError если текст пустой или содержит только пробелы
+ * @details Удаление пробелов и перевод в верхний регистр выполняются
+ *          за один проход; таблица выделяется по длине исходного текста
+ *          с запасом до полной строки
+ */
+wchar_t* RouteCipher::PrepareBulk(std::wstring_view Text, BufferArena& Arena, size_t& Rows) {
+    if (Text.empty()) {
+        throw CipherError("Текст не может быть пустым");
+    }
+    size_t Cols = static_cast<size_t>(Columns);
+    wchar_t* Table = Arena.allocateArray<wchar_t>((Text.size() + Cols - 1) / Cols * Cols);
+    size_t Length = 0;
+    for (wchar_t c : Text) {
+        if (!IsBlank(c)) {
+            Table[Length++] = UpperChar(c);
+        }
+    }
+    if (Length == 0) {
+        throw CipherError("После удаления пробелов текст пуст");
+    }
+    Rows = (Length + Cols - 1) / Cols;
+    std::fill(Table + Length, Table + Rows * Cols, L'X');
+    return Table;
+}
+
+/**
+ * @brief Пакетное шифрование в память арены
+ * @param Text Исходный текст для шифрования
+ * @param Arena Арена для таблицы и результата
+ * @return Зашифрованный текст; действителен до Arena.reset()
+ * @throws CipherError если текст пустой или содержит только пробелы
+ */
+std::wstring_view RouteCipher::EncryptBulk(std::wstring_view Text, BufferArena& Arena) {
+    LatencyTimer Timer(LatencyOp::RouteBulk, Text.size() * sizeof(char16_t));
+    size_t Rows;
+    wchar_t* Table = PrepareBulk(Text, Arena, Rows);
+    size_t Cells = Rows * static_cast<size_t>(Columns);
+    wchar_t* Result = Arena.allocateArray<wchar_t>(Cells);
+    ReadColumns(Table, Rows, Columns, Result, Tile);
+    return std::wstring_view(Result, Cells);
+}
+
+/**
+ * @brief Пакетное дешифрование в память арены
+ * @param Text Зашифрованный текст
+ * @param Arena Арена для таблицы и результата
+ * @return Расшифрованный текст; действителен до Arena.reset()
+ * @throws CipherError если текст пустой или содержит только пробелы
+ */
+std::wstring_view RouteCipher::DecryptBulk(std::wstring_view Text, BufferArena& Arena) {
+    LatencyTimer Timer(LatencyOp::RouteBulk, Text.size() * sizeof(char16_t));
+    size_t Rows;
+    wchar_t* Cells = PrepareBulk(Text, Arena, Rows);
+    size_t Length = Rows * static_cast<size_t>(Columns);
+    wchar_t* Result = Arena.allocateArray<wchar_t>(Length);
+    WriteColumns(Cells, Rows, Columns, Result, Tile);
+    while (Length > 0 && Result[Length - 1] == L'X') {
+        Length--;
+    }
+    return std::wstring_view(Result, Length);
+}
+
+/**
+ * @brief Проверяет параметры кадрового режима
+ * @param FrameRows Количество строк кадра
+ * @param Threads Количество потоков (0 - по числу ядер)
+ * @return Количество потоков для работы
+ * @throws CipherError если FrameRows равен 0
+ */
+unsigned RouteCipher::FrameThreads(size_t FrameRows, unsigned Threads) {
+    if (FrameRows == 0) {
+        throw CipherError("Количество строк кадра должно быть положительным");
+    }
+    if (Threads == 0) {
+        Threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return Threads;
+}
+
+/**
+ * @brief Перестановка последовательности кадров
+ * @param In Подготовленные символы, Cells кратно Columns
+ * @param Cells Количество символов
+ * @param FrameRows Количество строк полного кадра
+ * @param Out Результат: Cells символов
+ * @param Decrypting true для дешифрования
+ * @param Threads Количество потоков
+ */
+template <class Char>
+void RouteCipher::TransformFrames(const Char* In, size_t Cells, size_t FrameRows, Char* Out,
+                                  bool Decrypting, unsigned Threads) const {
+    size_t Cols = static_cast<size_t>(Columns);
+    size_t FrameCells = FrameRows * Cols;
+    size_t Frames = (Cells + FrameCells - 1) / FrameCells;
+    size_t Block = Tile;
+
+    auto Run = [=](size_t First, size_t Last) {
+        for (size_t f = First; f < Last; f++) {
+            size_t Offset = f * FrameCells;
+            size_t Rows = std::min(FrameCells, Cells - Offset) / Cols;
+            if (Decrypting) {
+                WriteColumns(In + Offset, Rows, Cols, Out + Offset, Block);
             } else {
-                Table[i][j] = L'X';
+                ReadColumns(In + Offset, Rows, Cols, Out + Offset, Block);
             }
         }
+    };
+
+    size_t Workers = std::min<size_t>(Threads, Frames);
+    if (Workers <= 1) {
+        Run(0, Frames);
+        return;
     }
-    
-    // Читаем по строкам слева направо
-    std::wstring Result;
-    for (int i = 0; i < Rows; i++) {
-        for (int j = 0; j < Columns; j++) {
-            Result += Table[i][j];
+    std::vector<std::thread> Pool;
+    Pool.reserve(Workers - 1);
+    for (size_t k = 1; k < Workers; k++) {
+        Pool.emplace_back(Run, Frames * k / Workers, Frames * (k + 1) / Workers);
+    }
+    Run(0, Frames / Workers);
+    for (std::thread& t : Pool) {
+        t.join();
+    }
+}
+
+/**
+ * @brief Концевик кадрового шифротекста
+ * @param Padding Количество заполнителей в последнем кадре
+ * @return L'#' и 8 шестнадцатеричных цифр
+ */
+std::wstring RouteCipher::MakeTrailer(size_t Padding) {
+    static const wchar_t Digits[] = L"0123456789ABCDEF";
+    std::wstring Trailer(FrameTrailer, L'#');
+    for (size_t i = FrameTrailer; i-- > 1;) {
+        Trailer[i] = Digits[Padding & 0xF];
+        Padding >>= 4;
+    }
+    return Trailer;
+}
+
+/**
+ * @brief Разбор концевика кадрового шифротекста
+ * @param Trailer Последние FrameTrailer символов шифротекста
+ * @return Количество заполнителей в последнем кадре
+ * @throws CipherError если концевик повреждён
+ */
+template <class Char>
+size_t RouteCipher::ParseTrailer(const Char* Trailer) {
+    if (Trailer[0] != '#') {
+        throw CipherError("Повреждён концевик кадрового шифротекста");
+    }
+    size_t Padding = 0;
+    for (size_t i = 1; i < FrameTrailer; i++) {
+        Char c = Trailer[i];
+        size_t Digit;
+        if (c >= '0' && c <= '9') {
+            Digit = c - '0';
+        } else if (c >= 'A' && c <= 'F') {
+            Digit = c - 'A' + 10;
+        } else {
+            throw CipherError("Повреждён концевик кадрового шифротекста");
         }
+        Padding = Padding * 16 + Digit;
     }
-    
-    // Убираем добавленные символы 'X' в конце
-    while (!Result.empty() && Result.back() == L'X') {
-        Result.pop_back();
+    return Padding;
+}
+
+/**
+ * @brief Кадровое шифрование или дешифрование подготовленного текста
+ * @param Cells Подготовленный текст (при дешифровании - с концевиком)
+ * @param FrameRows Количество строк кадра
+ * @param Decrypting true для дешифрования
+ * @param Threads Количество потоков
+ * @return Шифротекст с концевиком или открытый текст исходной длины
+ * @throws CipherError если концевик повреждён
+ */
+template <class Char>
+std::basic_string<Char> RouteCipher::TransformFramed(std::basic_string<Char>& Cells, size_t FrameRows,
+                                                     bool Decrypting, unsigned Threads) const {
+    size_t Cols = static_cast<size_t>(Columns);
+    if (!Decrypting) {
+        size_t Length = Cells.size();
+        Cells.resize((Length + Cols - 1) / Cols * Cols, Char('X'));
+        std::basic_string<Char> Result(Cells.size(), Char('X'));
+        TransformFrames(Cells.data(), Cells.size(), FrameRows, &Result[0], false, Threads);
+        std::wstring Trailer = MakeTrailer(Cells.size() - Length);
+        Result.append(Trailer.begin(), Trailer.end());
+        return Result;
     }
-    
+
+    if (Cells.size() <= FrameTrailer) {
+        throw CipherError("Кадровый шифротекст слишком короткий");
+    }
+    size_t Count = Cells.size() - FrameTrailer;
+    size_t Padding = ParseTrailer(Cells.data() + Count);
+    if (Count % Cols != 0 || Padding >= Cols || Padding >= Count) {
+        throw CipherError("Длина кадрового шифротекста не соответствует ключу");
+    }
+    std::basic_string<Char> Result(Count, Char('X'));
+    TransformFrames(Cells.data(), Count, FrameRows, &Result[0], true, Threads);
+    Result.resize(Count - Padding);
     return Result;
 }
+
+/**
+ * @brief Шифрует текст в кадровом режиме
+ * @param Text Исходный текст для шифрования
+ * @param FrameRows Количество строк в кадре
+ * @param Threads Количество потоков (0 - по числу ядер)
+ * @return Зашифрованный текст
+ * @throws CipherError если текст пустой, содержит только пробелы
+ *         или FrameRows равен 0
+ */
+std::wstring RouteCipher::EncryptFramed(const std::wstring& Text, size_t FrameRows, unsigned Threads) {
+    Threads = FrameThreads(FrameRows, Threads);
+    std::u16string Cells;
+    if (PrepareNarrow(Text.data(), Text.size(), Cells)) {
+        std::u16string Result = TransformFramed(Cells, FrameRows, false, Threads);
+        return std::wstring(Result.begin(), Result.end());
+    }
+    std::wstring Wide = PrepareText(Text);
+    return TransformFramed(Wide, FrameRows, false, Threads);
+}
+
+/**
+ * @brief Дешифрует текст, зашифрованный в кадровом режиме
+ * @param Text Зашифрованный текст с концевиком
+ * @param FrameRows Количество строк в кадре (как при шифровании)
+ * @param Threads Количество потоков (0 - по числу ядер)
+ * @return Расшифрованный текст ровно исходной длины
+ * @throws CipherError если текст пустой, концевик повреждён
+ *         или FrameRows равен 0
+ */
+std::wstring RouteCipher::DecryptFramed(const std::wstring& Text, size_t FrameRows, unsigned Threads) {
+    Threads = FrameThreads(FrameRows, Threads);
+    std::u16string Cells;
+    if (PrepareNarrow(Text.data(), Text.size(), Cells)) {
+        std::u16string Result = TransformFramed(Cells, FrameRows, true, Threads);
+        return std::wstring(Result.begin(), Result.end());
+    }
+    std::wstring Wide = PrepareText(Text);
+    return TransformFramed(Wide, FrameRows, true, Threads);
+}
+
+/**
+ * @brief Потоковое шифрование в кадровом режиме
+ * @param In Поток открытого текста
+ * @param Out Поток шифротекста
+ * @param FrameRows Количество строк в кадре
+ * @param Threads Количество потоков (0 - по числу ядер)
+ * @return Количество символов подготовленного открытого текста
+ * @throws CipherError если поток пуст, FrameRows равен 0 или запись не удалась
+ */
+size_t RouteCipher::EncryptStream(std::wistream& In, std::wostream& Out, size_t FrameRows, unsigned Threads) {
+    Threads = FrameThreads(FrameRows, Threads);
+    size_t Cols = static_cast<size_t>(Columns);
+    size_t BatchCells = FrameRows * Cols * Threads;
+    std::vector<wchar_t> Batch(BatchCells);
+    std::vector<wchar_t> Output(BatchCells);
+    wchar_t Raw[4096];
+    size_t Filled = 0;
+    size_t Total = 0;
+
+    for (;;) {
+        In.read(Raw, sizeof(Raw) / sizeof(Raw[0]));
+        size_t Got = static_cast<size_t>(In.gcount());
+        if (Got == 0) {
+            break;
+        }
+        for (size_t i = 0; i < Got; i++) {
+            if (IsBlank(Raw[i])) {
+                continue;
+            }
+            Batch[Filled++] = UpperChar(Raw[i]);
+            if (Filled == BatchCells) {
+                TransformFrames(Batch.data(), BatchCells, FrameRows, Output.data(), false, Threads);
+                Out.write(Output.data(), BatchCells);
+                Total += BatchCells;
+                Filled = 0;
+            }
+        }
+    }
+    if (Total + Filled == 0) {
+        throw CipherError("Текст не может быть пустым");
+    }
+
+    size_t Cells = (Filled + Cols - 1) / Cols * Cols;
+    std::fill(Batch.begin() + Filled, Batch.begin() + Cells, L'X');
+    TransformFrames(Batch.data(), Cells, FrameRows, Output.data(), false, Threads);
+    Out.write(Output.data(), Cells);
+    Out << MakeTrailer(Cells - Filled);
+    if (!Out) {
+        throw CipherError("Ошибка записи шифротекста");
+    }
+    return Total + Filled;
+}
+
+/**
+ * @brief Потоковое дешифрование в кадровом режиме
+ * @param In Поток шифротекста с концевиком
+ * @param Out Поток открытого текста
+ * @param FrameRows Количество строк в кадре (как при шифровании)
+ * @param Threads Количество потоков (0 - по числу ядер)
+ * @return Количество символов расшифрованного текста
+ * @throws CipherError если поток пуст, концевик повреждён,
+ *         FrameRows равен 0 или запись не удалась
+ */
+size_t RouteCipher::DecryptStream(std::wistream& In, std::wostream& Out, size_t FrameRows, unsigned Threads) {
+    Threads = FrameThreads(FrameRows, Threads);
+    size_t Cols = static_cast<size_t>(Columns);
+    size_t BatchCells = FrameRows * Cols * Threads;
+    // Пакет плюс придержанный возможный концевик
+    std::vector<wchar_t> Batch(BatchCells + FrameTrailer);
+    std::vector<wchar_t> Output(BatchCells);
+    wchar_t Raw[4096];
+    size_t Filled = 0;
+    size_t Total = 0;
+
+    for (;;) {
+        In.read(Raw, sizeof(Raw) / sizeof(Raw[0]));
+        size_t Got = static_cast<size_t>(In.gcount());
+        if (Got == 0) {
+            break;
+        }
+        for (size_t i = 0; i < Got; i++) {
+            if (IsBlank(Raw[i])) {
+                continue;
+            }
+            if (Filled == Batch.size()) {
+                // Пришёл символ после полного пакета, значит пакет - не конец текста
+                TransformFrames(Batch.data(), BatchCells, FrameRows, Output.data(), true, Threads);
+                Out.write(Output.data(), BatchCells);
+                Total += BatchCells;
+                std::copy(Batch.begin() + BatchCells, Batch.end(), Batch.begin());
+                Filled = FrameTrailer;
+            }
+            Batch[Filled++] = UpperChar(Raw[i]);
+        }
+    }
+    if (Total + Filled == 0) {
+        throw CipherError("Текст не может быть пустым");
+    }
+    if (Filled < FrameTrailer) {
+        throw CipherError("Кадровый шифротекст слишком короткий");
+    }
+
+    size_t Count = Filled - FrameTrailer;
+    size_t Padding = ParseTrailer(Batch.data() + Count);
+    if (Count % Cols != 0 || Padding >= Cols || (Padding > 0 && Padding >= Count) || Total + Count == 0) {
+        throw CipherError("Длина кадрового шифротекста не соответствует ключу");
+    }
+    TransformFrames(Batch.data(), Count, FrameRows, Output.data(), true, Threads);
+    Out.write(Output.data(), Count - Padding);
+    if (!Out) {
+        throw CipherError("Ошибка записи открытого текста");
+    }
+    return Total + Count - Padding;
+}
@@ -12,9 +12,17 @@
  */
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
 #include <stdexcept>
 #include <map>
+#include <cstddef>
+#include <iosfwd>
+#include <algorithm>
+#include <type_traits>
+#include "RoutePatterns.h"
+
+class BufferArena;
 
 /**
  * @class CipherError
@@ -51,16 +59,32 @@ public:
  * 2. Символы записываются в таблицу по строкам слева направо
  * 3. Таблица считывается по столбцам сверху вниз, начиная с правого столбца
  * 4. Дешифрование выполняет обратную операцию
+ *
+ * Вместо маршрута по умолчанию можно передать другой маршрут
+ * (см. RoutePatterns.h) в шаблонные варианты Encrypt и Decrypt.
+ *
+ * Маршрут по умолчанию хранит таблицу в 16-битных ячейках (char16_t):
+ * все поддерживаемые символы лежат в BMP, а транспонирование таблицы
+ * упирается в пропускную способность памяти. Если в тексте встретился
+ * символ вне BMP, используется прежний 32-битный путь.
+ *
+ * Маршруты по столбцам (SnakeColumns, KeyedColumns) используют то же
+ * блочное транспонирование с картой столбцов и учитывают SetTile; ядра
+ * для узких таблиц есть только у маршрута по умолчанию. Спираль и
+ * диагонали обходятся отрезками из ForEachRun без вектора порядка, но
+ * без разбиения на блоки, поэтому на таблицах, не помещающихся в кэш,
+ * они медленнее.
  */
 class RouteCipher {
 private:
     int Columns; ///< Количество столбцов таблицы (ключ шифрования)
+    size_t Tile = 32; ///< Сторона квадратного блока при транспонировании таблицы
     
     /**
      * @brief Проверяет корректность ключа шифрования
      * @param Key Проверяемый ключ
      * @throws CipherError если ключ некорректен
-     * @details Ключ должен быть положительным числом и не превышать 50
+     * @details Ключ должен быть положительным числом
      */
     void ValidateKey(int Key);
     
@@ -71,14 +95,6 @@ private:
      */
     void ValidateText(const std::wstring& Text);
     
-    /**
-     * @brief Подготавливает текст к шифрованию
-     * @param Text Исходный текст
-     * @return Подготовленный текст (без пробелов, в верхнем регистре)
-     * @throws CipherError если после очистки текст стал пустым
-     */
-    std::wstring PrepareText(const std::wstring& Text);
-    
     /**
      * @brief Очищает текст от пробелов и управляющих символов
      * @param Text Исходный текст
@@ -93,8 +109,194 @@ private:
      * @details Поддерживает русские и английские буквы
      */
     std::wstring ToUpperCase(const std::wstring& Text);
+
+    /**
+     * @brief Проверяет, удаляется ли символ при подготовке текста
+     * @param c Символ
+     * @return true для пробела, табуляции и перевода строки
+     */
+    static bool IsBlank(wchar_t c) {
+        return c == L' ' || c == L'\t' || c == L'\n' || c == L'\r';
+    }
+
+    /**
+     * @brief Преобразует символ к верхнему регистру
+     * @param c Символ
+     * @return Символ в верхнем регистре (русские и английские буквы)
+     */
+    static wchar_t UpperChar(wchar_t c) {
+        if (c >= L'a' && c <= L'z') {
+            return c - L'a' + L'A';
+        }
+        if (c >= L'а' && c <= L'я') {
+            return c - L'а' + L'А';
+        }
+        return c == L'ё' ? L'Ё' : c;
+    }
+
+    /**
+     * @brief Подготавливает текст в таблицу из памяти арены
+     * @param Text Исходный текст
+     * @param Arena Арена для таблицы
+     * @param Rows Результат: количество строк таблицы
+     * @return Таблица Rows×Columns, записанная по строкам, с заполнителем 'X'
+     * @throws CipherError если текст пустой или содержит только пробелы
+     */
+    wchar_t* PrepareBulk(std::wstring_view Text, BufferArena& Arena, size_t& Rows);
+
+    /**
+     * @brief Подготавливает текст и дополняет его до полной таблицы
+     * @param Text Исходный текст
+     * @param Rows Результат: количество строк таблицы
+     * @param Length Результат: длина подготовленного текста
+     * @return Таблица Rows×Columns, записанная по строкам, с заполнителем 'X'
+     * @throws CipherError если текст пустой или содержит только пробелы
+     */
+    std::wstring PrepareTable(const std::wstring& Text, size_t& Rows, size_t& Length);
+
+    /**
+     * @brief Подготавливает текст в 16-битные ячейки таблицы
+     * @param Text Исходный текст
+     * @param Size Длина текста
+     * @param Cells Результат: текст без пробелов, в верхнем регистре
+     * @return true, если все символы из BMP и помещаются в char16_t
+     * @throws CipherError если после очистки текст стал пустым
+     * @details Очистка, перевод в верхний регистр и сужение выполняются
+     *          за один проход; при false Cells не имеет смысла и текст
+     *          нужно обрабатывать 32-битным путём
+     */
+    template <class Char>
+    static bool PrepareNarrow(const Char* Text, size_t Size, std::u16string& Cells);
+
+    /**
+     * @brief Переставляет подготовленный текст маршрутом по умолчанию
+     * @tparam Char char16_t или wchar_t
+     * @param Cells Подготовленный текст; дополняется 'X' до полной таблицы
+     * @param Decrypting true для дешифрования
+     * @return Переставленный текст из Rows×Columns символов
+     */
+    template <class Char>
+    std::basic_string<Char> Transpose(std::basic_string<Char>& Cells, bool Decrypting) const;
+
+    /**
+     * @brief Кадровое шифрование или дешифрование подготовленного текста
+     * @tparam Char char16_t или wchar_t
+     * @param Cells Подготовленный текст (при дешифровании - с концевиком)
+     * @param FrameRows Количество строк кадра
+     * @param Decrypting true для дешифрования
+     * @param Threads Количество потоков
+     * @return Шифротекст с концевиком или открытый текст исходной длины
+     * @throws CipherError если концевик повреждён
+     */
+    template <class Char>
+    std::basic_string<Char> TransformFramed(std::basic_string<Char>& Cells, size_t FrameRows,
+                                            bool Decrypting, unsigned Threads) const;
+
+    /**
+     * @brief Удаляет заполнители 'X' в конце расшифрованного текста
+     * @param Text Расшифрованный текст
+     */
+    template <class String>
+    static void StripPadding(String& Text) {
+        while (!Text.empty() && Text.back() == 'X') {
+            Text.pop_back();
+        }
+    }
+
+    /**
+     * @brief Блочное чтение таблицы по столбцам справа налево
+     * @param Table Таблица, записанная по строкам
+     * @param Rows Количество строк
+     * @param Columns Количество столбцов
+     * @param Result Результат: Rows×Columns символов
+     * @param Block Сторона квадратного блока
+     * @param Slots Места столбцов в результате или nullptr для порядка справа налево
+     * @details Таблица обходится квадратными блоками, чтобы и чтение,
+     *          и запись шли по нескольким соседним строкам кэша даже при
+     *          очень большом количестве столбцов. Ядра для узких таблиц
+     *          используются только без карты столбцов
+     */
+    template <class Char>
+    static void ReadColumns(const Char* Table, size_t Rows, size_t Columns, Char* Result, size_t Block,
+                            const size_t* Slots = nullptr);
+
+    /**
+     * @brief Блочная запись таблицы по столбцам справа налево
+     * @param Text Текст, записываемый по столбцам
+     * @param Rows Количество строк
+     * @param Columns Количество столбцов
+     * @param Table Результат: таблица, записанная по строкам
+     * @param Block Сторона квадратного блока
+     * @param Slots Места столбцов в тексте или nullptr для порядка справа налево
+     */
+    template <class Char>
+    static void WriteColumns(const Char* Text, size_t Rows, size_t Columns, Char* Table, size_t Block,
+                             const size_t* Slots = nullptr);
+
+    /**
+     * @brief Блочная перестановка столбцов таблицы по карте
+     * @param Cells Таблица по строкам (шифрование) или текст по столбцам (дешифрование)
+     * @param Rows Количество строк
+     * @param Slots Slots[j] - место столбца j в тексте по столбцам
+     * @param Decrypting true для дешифрования
+     * @return Переставленный текст
+     */
+    std::wstring PermuteColumns(const std::wstring& Cells, size_t Rows,
+                                const std::vector<size_t>& Slots, bool Decrypting) const;
+
+    /**
+     * @brief Перестановка последовательности кадров
+     * @param In Подготовленные символы, Cells кратно Columns
+     * @param Cells Количество символов
+     * @param FrameRows Количество строк полного кадра
+     * @param Out Результат: Cells символов
+     * @param Decrypting true для дешифрования
+     * @param Threads Количество потоков
+     * @details Полные кадры распределяются между потоками непрерывными
+     *          диапазонами; последний кадр может быть короче
+     */
+    template <class Char>
+    void TransformFrames(const Char* In, size_t Cells, size_t FrameRows, Char* Out,
+                         bool Decrypting, unsigned Threads) const;
+
+    /**
+     * @brief Проверяет параметры кадрового режима
+     * @param FrameRows Количество строк кадра
+     * @param Threads Количество потоков (0 - по числу ядер)
+     * @return Количество потоков для работы
+     * @throws CipherError если FrameRows равен 0
+     */
+    static unsigned FrameThreads(size_t FrameRows, unsigned Threads);
+
+    /**
+     * @brief Концевик кадрового шифротекста
+     * @param Padding Количество заполнителей в последнем кадре
+     * @return L'#' и 8 шестнадцатеричных цифр
+     */
+    static std::wstring MakeTrailer(size_t Padding);
+
+    /**
+     * @brief Разбор концевика кадрового шифротекста
+     * @param Trailer Последние FrameTrailer символов шифротекста
+     * @return Количество заполнителей в последнем кадре
+     * @throws CipherError если концевик повреждён
+     */
+    template <class Char>
+    static size_t ParseTrailer(const Char* Trailer);
     
 public:
+    static const size_t FrameTrailer = 9; ///< Длина концевика кадрового шифротекста
+
+    /**
+     * @brief Подготавливает текст к шифрованию
+     * @param Text Исходный текст
+     * @return Подготовленный текст (без пробелов, в верхнем регистре)
+     * @throws CipherError если после очистки текст стал пустым
+     * @details Encrypt и Decrypt подготавливают текст сами; повторная
+     *          подготовка не меняет текст
+     */
+    std::wstring PrepareText(const std::wstring& Text);
+
     /**
      * @brief Конструктор класса
      * @param Key Количество столбцов таблицы
@@ -124,10 +326,236 @@ public:
      * @throws CipherError если текст пустой или содержит только пробелы
      */
     std::wstring Decrypt(const std::wstring& Text);
+
+    /**
+     * @brief Шифрует текст по маршруту по умолчанию
+     * @param Text Исходный текст для шифрования
+     * @param Route Маршрут чтения таблицы
+     * @return Зашифрованный текст
+     * @throws CipherError если текст пустой или содержит только пробелы
+     */
+    std::wstring Encrypt(const std::wstring& Text, const ColumnsRightToLeft& Route);
+
+    /**
+     * @brief Дешифрует текст по маршруту по умолчанию
+     * @param Text Зашифрованный текст
+     * @param Route Маршрут чтения таблицы
+     * @return Расшифрованный текст
+     * @throws CipherError если текст пустой или содержит только пробелы
+     */
+    std::wstring Decrypt(const std::wstring& Text, const ColumnsRightToLeft& Route);
+
+    /**
+     * @brief Шифрует текст в UTF-16 методом маршрутной перестановки
+     * @param Text Исходный текст для шифрования
+     * @return Зашифрованный текст
+     * @throws CipherError если текст пустой или содержит только пробелы
+     * @details Текст без суррогатных пар обрабатывается без перевода в
+     *          wchar_t. Символ вне BMP (суррогатная пара) занимает одну
+     *          ячейку таблицы, как в Encrypt для std::wstring
+     */
+    std::u16string Encrypt(const std::u16string& Text);
+
+    /**
+     * @brief Дешифрует текст в UTF-16
+     * @param Text Зашифрованный текст
+     * @return Расшифрованный текст
+     * @throws CipherError если текст пустой или содержит только пробелы
+     */
+    std::u16string Decrypt(const std::u16string& Text);
+
+    /**
+     * @brief Дешифрует текст известной длины
+     * @param Text Зашифрованный текст
+     * @param Length Длина подготовленного открытого текста
+     * @return Расшифрованный текст ровно из Length символов
+     * @throws CipherError если текст пустой или короче Length
+     * @details В отличие от Decrypt не отбрасывает символы 'X' в конце,
+     *          поэтому открытый текст, оканчивающийся на 'X', восстанавливается
+     *          без потерь
+     */
+    std::wstring DecryptExact(const std::wstring& Text, size_t Length);
+
+    /**
+     * @brief Пакетное шифрование в память арены
+     * @param Text Исходный текст для шифрования
+     * @param Arena Арена для таблицы и результата
+     * @return Зашифрованный текст; действителен до Arena.reset()
+     * @throws CipherError если текст пустой или содержит только пробелы
+     * @details Результат совпадает с Encrypt(Text). Подготовка текста
+     *          выполняется за один проход сразу в таблицу, а таблица и
+     *          результат берутся из арены и переиспользуются между вызовами
+     */
+    std::wstring_view EncryptBulk(std::wstring_view Text, BufferArena& Arena);
+
+    /**
+     * @brief Пакетное дешифрование в память арены
+     * @param Text Зашифрованный текст
+     * @param Arena Арена для таблицы и результата
+     * @return Расшифрованный текст; действителен до Arena.reset()
+     * @throws CipherError если текст пустой или содержит только пробелы
+     */
+    std::wstring_view DecryptBulk(std::wstring_view Text, BufferArena& Arena);
+
+    /**
+     * @brief Шифрует текст в кадровом режиме
+     * @param Text Исходный текст для шифрования
+     * @param FrameRows Количество строк в кадре
+     * @param Threads Количество потоков (0 - по числу ядер)
+     * @return Зашифрованный текст
+     * @throws CipherError если текст пустой, содержит только пробелы
+     *         или FrameRows равен 0
+     * @details Подготовленный текст делится на кадры по FrameRows×Columns
+     *          символов, каждый кадр переставляется независимо маршрутом по
+     *          умолчанию. Последний кадр содержит столько строк, сколько
+     *          нужно для остатка, и дополняется 'X'; в конец добавляется
+     *          концевик '#' и 8 шестнадцатеричных цифр с числом заполнителей,
+     *          поэтому дешифрование восстанавливает текст точно. Кадры не
+     *          зависят друг от друга, что позволяет обрабатывать их потоком
+     *          и параллельно
+     */
+    std::wstring EncryptFramed(const std::wstring& Text, size_t FrameRows, unsigned Threads = 1);
+
+    /**
+     * @brief Дешифрует текст, зашифрованный в кадровом режиме
+     * @param Text Зашифрованный текст с концевиком
+     * @param FrameRows Количество строк в кадре (как при шифровании)
+     * @param Threads Количество потоков (0 - по числу ядер)
+     * @return Расшифрованный текст ровно исходной длины
+     * @throws CipherError если текст пустой, концевик повреждён
+     *         или FrameRows равен 0
+     */
+    std::wstring DecryptFramed(const std::wstring& Text, size_t FrameRows, unsigned Threads = 1);
+
+    /**
+     * @brief Потоковое шифрование в кадровом режиме
+     * @param In Поток открытого текста
+     * @param Out Поток шифротекста
+     * @param FrameRows Количество строк в кадре
+     * @param Threads Количество потоков (0 - по числу ядер)
+     * @return Количество символов подготовленного открытого текста
+     * @throws CipherError если поток пуст, FrameRows равен 0 или запись не удалась
+     * @details Результат совпадает с EncryptFramed. В памяти держится не
+     *          больше Threads кадров, которые переставляются параллельно
+     */
+    size_t EncryptStream(std::wistream& In, std::wostream& Out, size_t FrameRows, unsigned Threads = 1);
+
+    /**
+     * @brief Потоковое дешифрование в кадровом режиме
+     * @param In Поток шифротекста с концевиком
+     * @param Out Поток открытого текста
+     * @param FrameRows Количество строк в кадре (как при шифровании)
+     * @param Threads Количество потоков (0 - по числу ядер)
+     * @return Количество символов расшифрованного текста
+     * @throws CipherError если поток пуст, концевик повреждён,
+     *         FrameRows равен 0 или запись не удалась
+     * @details Последние FrameTrailer символов придерживаются до конца
+     *          потока, так как концевик становится известен только там
+     */
+    size_t DecryptStream(std::wistream& In, std::wostream& Out, size_t FrameRows, unsigned Threads = 1);
+
+    /**
+     * @brief Шифрует текст по заданному маршруту
+     * @tparam Route Класс маршрута (см. RoutePatterns.h)
+     * @param Text Исходный текст для шифрования
+     * @param Pattern Маршрут чтения таблицы
+     * @return Зашифрованный текст
+     * @throws CipherError если текст пустой или маршрут некорректен
+     * @details Маршрут по столбцам переставляется блоками по карте
+     *          ColumnSlots, после чего столбцы, читаемые снизу вверх,
+     *          разворачиваются на месте. Остальные маршруты собирают ячейки
+     *          по отрезкам ForEachRun
+     */
+    template <class Route>
+    std::wstring Encrypt(const std::wstring& Text, const Route& Pattern);
+
+    /**
+     * @brief Дешифрует текст, зашифрованный по заданному маршруту
+     * @tparam Route Класс маршрута (см. RoutePatterns.h)
+     * @param Text Зашифрованный текст
+     * @param Pattern Маршрут чтения таблицы
+     * @return Расшифрованный текст
+     * @throws CipherError если текст пустой или маршрут некорректен
+     * @details Обратная раскладка теми же способами, что и в Encrypt
+     */
+    template <class Route>
+    std::wstring Decrypt(const std::wstring& Text, const Route& Pattern);
     
     /**
      * @brief Возвращает текущее значение ключа
      * @return Количество столбцов таблицы
      */
     int GetColumns() const { return Columns; }
+
+    /**
+     * @brief Задаёт сторону блока при транспонировании таблицы
+     * @param Size Сторона блока в символах
+     * @throws CipherError если Size равен 0
+     * @details Влияет на скорость маршрутов по столбцам, результат
+     *          шифрования от размера блока не зависит
+     */
+    void SetTile(size_t Size);
+
+    /**
+     * @brief Возвращает сторону блока при транспонировании таблицы
+     * @return Сторона блока в символах
+     */
+    size_t GetTile() const { return Tile; }
 };
+
+template <class Route>
+std::wstring RouteCipher::Encrypt(const std::wstring& Text, const Route& Pattern) {
+    size_t Rows, Length;
+    std::wstring Table = PrepareTable(Text, Rows, Length);
+    size_t Cols = static_cast<size_t>(Columns);
+    if constexpr (IsColumnRoute<Route>::value) {
+        std::vector<size_t> Slots;
+        Pattern.ColumnSlots(Cols, Slots);
+        std::wstring Result = PermuteColumns(Table, Rows, Slots, false);
+        for (size_t s = 0; s < Cols; s++) {
+            if (Pattern.Upward(s)) {
+                std::reverse(Result.begin() + s * Rows, Result.begin() + (s + 1) * Rows);
+            }
+        }
+        return Result;
+    } else {
+        std::wstring Result(Table.size(), L'X');
+        size_t p = 0;
+        Pattern.ForEachRun(Rows, Cols, [&](size_t Start, std::ptrdiff_t Step, size_t Count) {
+            std::ptrdiff_t Cell = static_cast<std::ptrdiff_t>(Start);
+            for (size_t k = 0; k < Count; k++, Cell += Step) {
+                Result[p++] = Table[Cell];
+            }
+        });
+        return Result;
+    }
+}
+
+template <class Route>
+std::wstring RouteCipher::Decrypt(const std::wstring& Text, const Route& Pattern) {
+    size_t Rows, Length;
+    std::wstring Cells = PrepareTable(Text, Rows, Length);
+    size_t Cols = static_cast<size_t>(Columns);
+    std::wstring Result;
+    if constexpr (IsColumnRoute<Route>::value) {
+        std::vector<size_t> Slots;
+        Pattern.ColumnSlots(Cols, Slots);
+        for (size_t s = 0; s < Cols; s++) {
+            if (Pattern.Upward(s)) {
+                std::reverse(Cells.begin() + s * Rows, Cells.begin() + (s + 1) * Rows);
+            }
+        }
+        Result = PermuteColumns(Cells, Rows, Slots, true);
+    } else {
+        Result.assign(Cells.size(), L'X');
+        size_t p = 0;
+        Pattern.ForEachRun(Rows, Cols, [&](size_t Start, std::ptrdiff_t Step, size_t Count) {
+            std::ptrdiff_t Cell = static_cast<std::ptrdiff_t>(Start);
+            for (size_t k = 0; k < Count; k++, Cell += Step) {
+                Result[Cell] = Cells[p++];
+            }
+        });
+    }
+    StripPadding(Result);
+    return Result;
+}
@@ -0,0 +1,190 @@
+/**
+ * @file RouteKernels.cpp
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 17.12.2025
+ * @brief Реализация специализированных ядер транспонирования
+ * @copyright ИБСТ ПГУ
+ * @details Таблица обрабатывается группами по 8 строк: группа из
+ *          8×Columns ячеек занимает ровно Columns регистров по 8 ячеек.
+ *          При шифровании регистр j результата собирает столбец j группы,
+ *          при дешифровании регистр v собирает v-ю восьмёрку ячеек по
+ *          строкам. Каждая восьмёрка собирается из нескольких исходных
+ *          регистров командой pshufb с маской, вычисленной на этапе
+ *          компиляции; пары регистров, не дающие ни одной ячейки,
+ *          отбрасываются при развёртке циклов. Оставшиеся строки
+ *          (меньше 8) переставляются поэлементно.
+ */
+#include "RouteKernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <tmmintrin.h>
+
+/**
+ * @brief Маски pshufb для таблицы из Columns столбцов
+ * @tparam Columns Количество столбцов
+ */
+template <int Columns>
+struct ShuffleMasks {
+    alignas(16) unsigned char Read[Columns][Columns][16]; ///< Read[j][v]: ячейки столбца j из регистра v
+    alignas(16) unsigned char Write[Columns][Columns][16]; ///< Write[v][j]: ячейки регистра v из столбца j
+    bool ReadUsed[Columns][Columns]; ///< Регистр v содержит ячейки столбца j
+    bool WriteUsed[Columns][Columns]; ///< Столбец j содержит ячейки регистра v
+
+    constexpr ShuffleMasks() : Read(), Write(), ReadUsed(), WriteUsed() {
+        for (int a = 0; a < Columns; a++) {
+            for (int b = 0; b < Columns; b++) {
+                for (int k = 0; k < 16; k++) {
+                    Read[a][b][k] = 0x80;
+                    Write[a][b][k] = 0x80;
+                }
+            }
+        }
+        // Ячейка r*Columns + j группы - строка r, столбец j;
+        // в исходных регистрах по строкам она лежит в регистре Cell / 8
+        for (int r = 0; r < 8; r++) {
+            for (int j = 0; j < Columns; j++) {
+                int Cell = r * Columns + j;
+                int v = Cell / 8;
+                int Lane = Cell % 8;
+                Read[j][v][2 * r] = static_cast<unsigned char>(2 * Lane);
+                Read[j][v][2 * r + 1] = static_cast<unsigned char>(2 * Lane + 1);
+                ReadUsed[j][v] = true;
+                Write[v][j][2 * Lane] = static_cast<unsigned char>(2 * r);
+                Write[v][j][2 * Lane + 1] = static_cast<unsigned char>(2 * r + 1);
+                WriteUsed[v][j] = true;
+            }
+        }
+    }
+};
+
+template <int Columns>
+constexpr ShuffleMasks<Columns> Masks{};
+
+/**
+ * @brief Чтение таблицы по столбцам справа налево
+ * @tparam Columns Количество столбцов
+ * @param In Таблица, записанная по строкам
+ * @param Rows Количество строк
+ * @param Out Результат: столбцы справа налево, каждый из Rows ячеек
+ */
+template <int Columns>
+__attribute__((target("ssse3")))
+void ReadKernel(const char16_t* In, size_t Rows, char16_t* Out) {
+    const ShuffleMasks<Columns>& M = Masks<Columns>;
+    size_t i0 = 0;
+    for (; i0 + 8 <= Rows; i0 += 8) {
+        const char16_t* Group = In + i0 * Columns;
+        __m128i Cells[Columns];
+#pragma GCC unroll 16
+        for (int v = 0; v < Columns; v++) {
+            Cells[v] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Group + 8 * v));
+        }
+#pragma GCC unroll 16
+        for (int j = 0; j < Columns; j++) {
+            __m128i Acc = _mm_setzero_si128();
+#pragma GCC unroll 16
+            for (int v = 0; v < Columns; v++) {
+                if (M.ReadUsed[j][v]) {
+                    __m128i Mask = _mm_load_si128(reinterpret_cast<const __m128i*>(M.Read[j][v]));
+                    Acc = _mm_or_si128(Acc, _mm_shuffle_epi8(Cells[v], Mask));
+                }
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(Out + (Columns - 1 - j) * Rows + i0), Acc);
+        }
+    }
+    for (; i0 < Rows; i0++) {
+        for (int j = 0; j < Columns; j++) {
+            Out[(Columns - 1 - j) * Rows + i0] = In[i0 * Columns + j];
+        }
+    }
+}
+
+/**
+ * @brief Запись таблицы по столбцам справа налево
+ * @tparam Columns Количество столбцов
+ * @param In Столбцы справа налево, каждый из Rows ячеек
+ * @param Rows Количество строк
+ * @param Out Результат: таблица, записанная по строкам
+ */
+template <int Columns>
+__attribute__((target("ssse3")))
+void WriteKernel(const char16_t* In, size_t Rows, char16_t* Out) {
+    const ShuffleMasks<Columns>& M = Masks<Columns>;
+    size_t i0 = 0;
+    for (; i0 + 8 <= Rows; i0 += 8) {
+        __m128i Cells[Columns];
+#pragma GCC unroll 16
+        for (int j = 0; j < Columns; j++) {
+            Cells[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(In + (Columns - 1 - j) * Rows + i0));
+        }
+        char16_t* Group = Out + i0 * Columns;
+#pragma GCC unroll 16
+        for (int v = 0; v < Columns; v++) {
+            __m128i Acc = _mm_setzero_si128();
+#pragma GCC unroll 16
+            for (int j = 0; j < Columns; j++) {
+                if (M.WriteUsed[v][j]) {
+                    __m128i Mask = _mm_load_si128(reinterpret_cast<const __m128i*>(M.Write[v][j]));
+                    Acc = _mm_or_si128(Acc, _mm_shuffle_epi8(Cells[j], Mask));
+                }
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(Group + 8 * v), Acc);
+        }
+    }
+    for (; i0 < Rows; i0++) {
+        for (int j = 0; j < Columns; j++) {
+            Out[i0 * Columns + j] = In[(Columns - 1 - j) * Rows + i0];
+        }
+    }
+}
+
+/**
+ * @brief Ядра чтения по количеству столбцов
+ */
+static const RouteKernel16 ReadKernels[MaxKernelColumns + 1] = {
+    nullptr, nullptr,
+    ReadKernel<2>, ReadKernel<3>, ReadKernel<4>, ReadKernel<5>,
+    ReadKernel<6>, ReadKernel<7>, ReadKernel<8>, ReadKernel<9>,
+    ReadKernel<10>, ReadKernel<11>, ReadKernel<12>, ReadKernel<13>,
+    ReadKernel<14>, ReadKernel<15>, ReadKernel<16>
+};
+
+/**
+ * @brief Ядра записи по количеству столбцов
+ */
+static const RouteKernel16 WriteKernels[MaxKernelColumns + 1] = {
+    nullptr, nullptr,
+    WriteKernel<2>, WriteKernel<3>, WriteKernel<4>, WriteKernel<5>,
+    WriteKernel<6>, WriteKernel<7>, WriteKernel<8>, WriteKernel<9>,
+    WriteKernel<10>, WriteKernel<11>, WriteKernel<12>, WriteKernel<13>,
+    WriteKernel<14>, WriteKernel<15>, WriteKernel<16>
+};
+
+/**
+ * @brief Проверяет поддержку SSSE3 процессором
+ */
+static bool HasSsse3() {
+    static const bool Supported = __builtin_cpu_supports("ssse3");
+    return Supported;
+}
+
+RouteKernel16 FindReadKernel(size_t Columns) {
+    return Columns <= MaxKernelColumns && HasSsse3() ? ReadKernels[Columns] : nullptr;
+}
+
+RouteKernel16 FindWriteKernel(size_t Columns) {
+    return Columns <= MaxKernelColumns && HasSsse3() ? WriteKernels[Columns] : nullptr;
+}
+
+#else
+
+RouteKernel16 FindReadKernel(size_t) {
+    return nullptr;
+}
+
+RouteKernel16 FindWriteKernel(size_t) {
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,48 @@
+/**
+ * @file RouteKernels.h
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 17.12.2025
+ * @brief Специализированные ядра транспонирования для малого числа столбцов
+ * @copyright ИБСТ ПГУ
+ * @details Для 2-16 столбцов маршрут по умолчанию - фиксированная
+ *          перестановка 16-битных ячеек внутри группы из 8 строк. Ядро
+ *          для каждого числа столбцов порождается шаблоном, маски pshufb
+ *          вычисляются на этапе компиляции, а выбор ядра по числу
+ *          столбцов - обращение к таблице указателей. Ядра требуют SSSE3
+ *          и проверяют его при первом обращении; без него (и на других
+ *          архитектурах) таблица пуста и используется общий путь.
+ */
+#pragma once
+#include <cstddef>
+
+/**
+ * @brief Ядро транспонирования таблицы из 16-битных ячеек
+ * @param In Исходные ячейки
+ * @param Rows Количество строк таблицы
+ * @param Out Результат: Rows×Columns ячеек
+ */
+typedef void (*RouteKernel16)(const char16_t* In, size_t Rows, char16_t* Out);
+
+/**
+ * @brief Наибольшее количество столбцов со специализированным ядром
+ */
+const size_t MaxKernelColumns = 16;
+
+/**
+ * @brief Ядро чтения таблицы по столбцам справа налево
+ * @param Columns Количество столбцов
+ * @return Ядро или nullptr, если для Columns его нет или процессор
+ *         не поддерживает SSSE3
+ * @details Результат совпадает с RouteCipher::ReadColumns
+ */
+RouteKernel16 FindReadKernel(size_t Columns);
+
+/**
+ * @brief Ядро записи таблицы по столбцам справа налево
+ * @param Columns Количество столбцов
+ * @return Ядро или nullptr, если для Columns его нет или процессор
+ *         не поддерживает SSSE3
+ * @details Результат совпадает с RouteCipher::WriteColumns
+ */
+RouteKernel16 FindWriteKernel(size_t Columns);
@@ -0,0 +1,109 @@
+/**
+ * @file RoutePatterns.cpp
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 17.12.2025
+ * @brief Реализация маршрутов чтения таблицы
+ * @copyright ИБСТ ПГУ
+ */
+#include "RouteCipher.h"
+
+/**
+ * @brief Вектор порядка обхода по отрезкам маршрута
+ * @param Pattern Маршрут
+ * @param Rows Количество строк таблицы
+ * @param Columns Количество столбцов таблицы
+ * @param Order Результат: Order[p] - номер (по строкам) p-й считанной ячейки
+ */
+template <class Route>
+static void FillOrder(const Route& Pattern, size_t Rows, size_t Columns, std::vector<size_t>& Order) {
+    Order.resize(Rows * Columns);
+    size_t p = 0;
+    Pattern.ForEachRun(Rows, Columns, [&](size_t Start, std::ptrdiff_t Step, size_t Count) {
+        for (size_t k = 0; k < Count; k++) {
+            Order[p++] = Start + static_cast<size_t>(static_cast<std::ptrdiff_t>(k) * Step);
+        }
+    });
+}
+
+/**
+ * @brief Места столбцов при чтении справа налево
+ */
+void ColumnsRightToLeft::ColumnSlots(size_t Columns, std::vector<size_t>& Slots) const {
+    Slots.resize(Columns);
+    for (size_t j = 0; j < Columns; j++) {
+        Slots[j] = Columns - 1 - j;
+    }
+}
+
+/**
+ * @brief Порядок обхода по столбцам сверху вниз, справа налево
+ */
+void ColumnsRightToLeft::BuildOrder(size_t Rows, size_t Columns, std::vector<size_t>& Order) const {
+    FillOrder(*this, Rows, Columns, Order);
+}
+
+/**
+ * @brief Места столбцов «змейки»: справа налево, как у маршрута по умолчанию
+ */
+void SnakeColumns::ColumnSlots(size_t Columns, std::vector<size_t>& Slots) const {
+    ColumnsRightToLeft().ColumnSlots(Columns, Slots);
+}
+
+/**
+ * @brief Порядок обхода «змейкой» по столбцам справа налево
+ */
+void SnakeColumns::BuildOrder(size_t Rows, size_t Columns, std::vector<size_t>& Order) const {
+    FillOrder(*this, Rows, Columns, Order);
+}
+
+/**
+ * @brief Порядок обхода по спирали по часовой стрелке
+ */
+void SpiralRoute::BuildOrder(size_t Rows, size_t Columns, std::vector<size_t>& Order) const {
+    FillOrder(*this, Rows, Columns, Order);
+}
+
+/**
+ * @brief Порядок обхода по диагоналям
+ */
+void DiagonalRoute::BuildOrder(size_t Rows, size_t Columns, std::vector<size_t>& Order) const {
+    FillOrder(*this, Rows, Columns, Order);
+}
+
+/**
+ * @brief Проверка, что ключ - перестановка столбцов
+ * @throws CipherError если ключ не является перестановкой столбцов
+ */
+void KeyedColumns::CheckColumns(size_t Columns) const {
+    if (ColumnOrder.size() != Columns) {
+        throw CipherError("Порядок столбцов не соответствует ключу");
+    }
+    std::vector<bool> Seen(Columns, false);
+    for (size_t Column : ColumnOrder) {
+        if (Column >= Columns || Seen[Column]) {
+            throw CipherError("Порядок столбцов должен быть перестановкой");
+        }
+        Seen[Column] = true;
+    }
+}
+
+/**
+ * @brief Места столбцов в порядке ключа
+ * @throws CipherError если ключ не является перестановкой столбцов
+ */
+void KeyedColumns::ColumnSlots(size_t Columns, std::vector<size_t>& Slots) const {
+    CheckColumns(Columns);
+    Slots.resize(Columns);
+    for (size_t k = 0; k < Columns; k++) {
+        Slots[ColumnOrder[k]] = k;
+    }
+}
+
+/**
+ * @brief Порядок обхода по столбцам в порядке ключа
+ * @throws CipherError если ключ не является перестановкой столбцов
+ */
+void KeyedColumns::BuildOrder(size_t Rows, size_t Columns, std::vector<size_t>& Order) const {
+    FillOrder(*this, Rows, Columns, Order);
+}
@@ -0,0 +1,278 @@
+/**
+ * @file RoutePatterns.h
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 17.12.2025
+ * @brief Маршруты чтения таблицы для шифра маршрутной перестановки
+ * @copyright ИБСТ ПГУ
+ * @details Маршрут - класс-политика с шаблонным методом ForEachRun,
+ *          который перечисляет ячейки таблицы отрезками: отрезок - начальная
+ *          ячейка, шаг и длина. Текст всегда записывается в таблицу по
+ *          строкам слева направо, а маршрут задаёт порядок, в котором ячейки
+ *          считываются в шифротекст. Отрезки порождаются на лету, так что
+ *          обходу не нужна память под порядок ячеек.
+ *
+ * Маршруты, которые читают каждый столбец целиком (ColumnsRightToLeft,
+ * SnakeColumns, KeyedColumns), дополнительно задают ColumnSlots - место
+ * каждого столбца в шифротексте - и Upward - направление чтения столбца.
+ * Для них RouteCipher выполняет блочное транспонирование с картой
+ * столбцов, как и для маршрута по умолчанию. BuildOrder строит полный
+ * вектор порядка (8 байт на ячейку) и оставлен для проверок и отладки.
+ */
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * @class ColumnsRightToLeft
+ * @brief Маршрут по умолчанию: по столбцам сверху вниз, справа налево
+ * @details RouteCipher выполняет этот маршрут блочным транспонированием,
+ *          а для 2-16 столбцов - специализированными ядрами
+ */
+class ColumnsRightToLeft {
+public:
+    /**
+     * @brief Обход маршрута отрезками
+     * @param Rows Количество строк таблицы
+     * @param Columns Количество столбцов таблицы
+     * @param Run Вызывается как Run(Start, Step, Count) для каждого отрезка:
+     *            ячейки (по строкам) Start, Start + Step, ... - всего Count
+     */
+    template <class Visit>
+    void ForEachRun(size_t Rows, size_t Columns, Visit&& Run) const {
+        for (size_t j = Columns; j-- > 0;) {
+            Run(j, static_cast<std::ptrdiff_t>(Columns), Rows);
+        }
+    }
+
+    /**
+     * @brief Места столбцов в шифротексте
+     * @param Columns Количество столбцов таблицы
+     * @param Slots Результат: Slots[j] - номер, под которым читается столбец j
+     */
+    void ColumnSlots(size_t Columns, std::vector<size_t>& Slots) const;
+
+    /**
+     * @brief Направление чтения столбца
+     * @param Slot Номер столбца в порядке чтения
+     * @return true, если столбец читается снизу вверх
+     */
+    bool Upward(size_t) const { return false; }
+
+    /**
+     * @brief Построение порядка обхода
+     * @param Rows Количество строк таблицы
+     * @param Columns Количество столбцов таблицы
+     * @param Order Результат: Order[p] - номер (по строкам) p-й считанной ячейки
+     */
+    void BuildOrder(size_t Rows, size_t Columns, std::vector<size_t>& Order) const;
+};
+
+/**
+ * @class SnakeColumns
+ * @brief Маршрут «змейкой» по столбцам справа налево
+ * @details Правый столбец читается сверху вниз, следующий - снизу вверх
+ *          и так далее
+ */
+class SnakeColumns {
+public:
+    /**
+     * @brief Обход маршрута отрезками
+     * @param Rows Количество строк таблицы
+     * @param Columns Количество столбцов таблицы
+     * @param Run Вызывается как Run(Start, Step, Count) для каждого отрезка:
+     *            ячейки (по строкам) Start, Start + Step, ... - всего Count
+     */
+    template <class Visit>
+    void ForEachRun(size_t Rows, size_t Columns, Visit&& Run) const {
+        std::ptrdiff_t Step = static_cast<std::ptrdiff_t>(Columns);
+        for (size_t j = Columns; j-- > 0;) {
+            if (Upward(Columns - 1 - j)) {
+                Run((Rows - 1) * Columns + j, -Step, Rows);
+            } else {
+                Run(j, Step, Rows);
+            }
+        }
+    }
+
+    /**
+     * @brief Места столбцов в шифротексте
+     * @param Columns Количество столбцов таблицы
+     * @param Slots Результат: Slots[j] - номер, под которым читается столбец j
+     */
+    void ColumnSlots(size_t Columns, std::vector<size_t>& Slots) const;
+
+    /**
+     * @brief Направление чтения столбца
+     * @param Slot Номер столбца в порядке чтения
+     * @return true, если столбец читается снизу вверх
+     */
+    bool Upward(size_t Slot) const { return Slot % 2 == 1; }
+
+    /**
+     * @brief Построение порядка обхода
+     * @param Rows Количество строк таблицы
+     * @param Columns Количество столбцов таблицы
+     * @param Order Результат: Order[p] - номер (по строкам) p-й считанной ячейки
+     */
+    void BuildOrder(size_t Rows, size_t Columns, std::vector<size_t>& Order) const;
+};
+
+/**
+ * @class SpiralRoute
+ * @brief Маршрут по спирали по часовой стрелке от левого верхнего угла
+ * @details Каждое кольцо - четыре отрезка: верхняя строка, правый
+ *          столбец, нижняя строка справа налево, левый столбец снизу вверх
+ */
+class SpiralRoute {
+public:
+    /**
+     * @brief Обход маршрута отрезками
+     * @param Rows Количество строк таблицы
+     * @param Columns Количество столбцов таблицы
+     * @param Run Вызывается как Run(Start, Step, Count) для каждого отрезка:
+     *            ячейки (по строкам) Start, Start + Step, ... - всего Count
+     */
+    template <class Visit>
+    void ForEachRun(size_t Rows, size_t Columns, Visit&& Run) const {
+        std::ptrdiff_t Down = static_cast<std::ptrdiff_t>(Columns);
+        size_t Top = 0, Bottom = Rows, Left = 0, Right = Columns;
+        while (Top < Bottom && Left < Right) {
+            Run(Top * Columns + Left, 1, Right - Left);
+            if (Bottom - Top > 1) {
+                Run((Top + 1) * Columns + Right - 1, Down, Bottom - Top - 1);
+                if (Right - Left > 1) {
+                    Run((Bottom - 1) * Columns + Right - 2, -1, Right - Left - 1);
+                    if (Bottom - Top > 2) {
+                        Run((Bottom - 2) * Columns + Left, -Down, Bottom - Top - 2);
+                    }
+                }
+            }
+            Top++;
+            Bottom--;
+            Left++;
+            Right--;
+        }
+    }
+
+    /**
+     * @brief Построение порядка обхода
+     * @param Rows Количество строк таблицы
+     * @param Columns Количество столбцов таблицы
+     * @param Order Результат: Order[p] - номер (по строкам) p-й считанной ячейки
+     */
+    void BuildOrder(size_t Rows, size_t Columns, std::vector<size_t>& Order) const;
+};
+
+/**
+ * @class DiagonalRoute
+ * @brief Маршрут по диагоналям
+ * @details Диагонали с постоянной суммой номеров строки и столбца
+ *          читаются начиная с левого верхнего угла, каждая - сверху вниз
+ */
+class DiagonalRoute {
+public:
+    /**
+     * @brief Обход маршрута отрезками
+     * @param Rows Количество строк таблицы
+     * @param Columns Количество столбцов таблицы
+     * @param Run Вызывается как Run(Start, Step, Count) для каждого отрезка:
+     *            ячейки (по строкам) Start, Start + Step, ... - всего Count
+     */
+    template <class Visit>
+    void ForEachRun(size_t Rows, size_t Columns, Visit&& Run) const {
+        for (size_t d = 0; d + 1 < Rows + Columns; d++) {
+            size_t First = d + 1 > Columns ? d + 1 - Columns : 0;
+            size_t Last = d < Rows - 1 ? d : Rows - 1;
+            Run(First * Columns + (d - First), static_cast<std::ptrdiff_t>(Columns) - 1, Last - First + 1);
+        }
+    }
+
+    /**
+     * @brief Построение порядка обхода
+     * @param Rows Количество строк таблицы
+     * @param Columns Количество столбцов таблицы
+     * @param Order Результат: Order[p] - номер (по строкам) p-й считанной ячейки
+     */
+    void BuildOrder(size_t Rows, size_t Columns, std::vector<size_t>& Order) const;
+};
+
+/**
+ * @class KeyedColumns
+ * @brief Маршрут по столбцам в порядке, заданном ключом
+ * @details Каждый столбец читается сверху вниз, столбцы - в порядке
+ *          перечисления в ключе
+ */
+class KeyedColumns {
+private:
+    std::vector<size_t> ColumnOrder; ///< Номера столбцов в порядке чтения
+
+    /**
+     * @brief Проверка ключа
+     * @param Columns Количество столбцов таблицы
+     * @throws CipherError если ключ не является перестановкой столбцов
+     */
+    void CheckColumns(size_t Columns) const;
+
+public:
+    /**
+     * @brief Конструктор маршрута
+     * @param ColumnOrder Перестановка номеров столбцов 0..Columns-1
+     */
+    explicit KeyedColumns(const std::vector<size_t>& ColumnOrder) : ColumnOrder(ColumnOrder) {}
+
+    /**
+     * @brief Обход маршрута отрезками
+     * @param Rows Количество строк таблицы
+     * @param Columns Количество столбцов таблицы
+     * @param Run Вызывается как Run(Start, Step, Count) для каждого отрезка:
+     *            ячейки (по строкам) Start, Start + Step, ... - всего Count
+     * @throws CipherError если ключ не является перестановкой столбцов
+     */
+    template <class Visit>
+    void ForEachRun(size_t Rows, size_t Columns, Visit&& Run) const {
+        CheckColumns(Columns);
+        for (size_t j : ColumnOrder) {
+            Run(j, static_cast<std::ptrdiff_t>(Columns), Rows);
+        }
+    }
+
+    /**
+     * @brief Места столбцов в шифротексте
+     * @param Columns Количество столбцов таблицы
+     * @param Slots Результат: Slots[j] - номер, под которым читается столбец j
+     * @throws CipherError если ключ не является перестановкой столбцов
+     */
+    void ColumnSlots(size_t Columns, std::vector<size_t>& Slots) const;
+
+    /**
+     * @brief Направление чтения столбца
+     * @param Slot Номер столбца в порядке чтения
+     * @return true, если столбец читается снизу вверх
+     */
+    bool Upward(size_t) const { return false; }
+
+    /**
+     * @brief Построение порядка обхода
+     * @param Rows Количество строк таблицы
+     * @param Columns Количество столбцов таблицы
+     * @param Order Результат: Order[p] - номер (по строкам) p-й считанной ячейки
+     * @throws CipherError если ключ не является перестановкой столбцов
+     */
+    void BuildOrder(size_t Rows, size_t Columns, std::vector<size_t>& Order) const;
+};
+
+/**
+ * @brief Признак маршрута по столбцам
+ * @tparam Route Класс маршрута
+ * @details Истинен для маршрутов с методами ColumnSlots и Upward
+ */
+template <class Route, class = void>
+struct IsColumnRoute : std::false_type {};
+
+/**
+ * @brief Признак маршрута по столбцам (маршрут с ColumnSlots)
+ */
+template <class Route>
+struct IsColumnRoute<Route, std::void_t<decltype(&Route::ColumnSlots)>> : std::true_type {};
@@ -11,7 +11,9 @@
  * @warning Для корректной работы требуется русская локаль
  */
 #include "RouteCipher.h"
+#include "../BufferArena.h"
 #include <iostream>
+#include <sstream>
 #include <locale>
 #include <cwchar>
 
@@ -185,6 +187,243 @@ void runTests() {
         std::cout << "✗ 3.3 Decrypt('') - НЕВЕРНОЕ ИСКЛЮЧЕНИЕ" << std::endl;
     }
     
+    // ТЕСТ 4: Маршруты
+    std::cout << "\n4. Тесты маршрутов:" << std::endl;
+    
+    // 4.1 Маршрут «змейкой»
+    try {
+        total++;
+        RouteCipher cipher(3);
+        // Таблица: [A B C] [D E F], столбцы справа налево: C F, E B, A D
+        std::wstring result = cipher.Encrypt(L"ABCDEF", SnakeColumns());
+        
+        if (result == L"CFEBAD") {
+            std::wcout << L"✓ 4.1 Encrypt('ABCDEF', змейка) = " << result << std::endl;
+            passed++;
+        } else {
+            std::wcout << L"✗ 4.1 Ожидалось 'CFEBAD', получено: " << result << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cout << "✗ 4.1 Змейка - ОШИБКА: " << e.what() << std::endl;
+    }
+    
+    // 4.2 Полный цикл для спирали, диагоналей и порядка столбцов по ключу
+    try {
+        total++;
+        RouteCipher cipher(4);
+        std::wstring original = L"ПРИВЕТМИР";
+        KeyedColumns keyed({2, 0, 3, 1});
+        bool ok = cipher.Decrypt(cipher.Encrypt(original, SpiralRoute()), SpiralRoute()) == original &&
+                  cipher.Decrypt(cipher.Encrypt(original, DiagonalRoute()), DiagonalRoute()) == original &&
+                  cipher.Decrypt(cipher.Encrypt(original, keyed), keyed) == original;
+        
+        if (ok) {
+            std::cout << "✓ 4.2 Спираль, диагонали, порядок по ключу - OK" << std::endl;
+            passed++;
+        } else {
+            std::cout << "✗ 4.2 Спираль, диагонали, порядок по ключу - ОШИБКА" << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cout << "✗ 4.2 Маршруты - ОШИБКА: " << e.what() << std::endl;
+    }
+    
+    // 4.3 Порядок столбцов, не являющийся перестановкой (должно быть исключение)
+    try {
+        total++;
+        RouteCipher cipher(3);
+        cipher.Encrypt(L"ABCDEF", KeyedColumns({0, 0, 1}));
+        std::cout << "✗ 4.3 Порядок {0,0,1} - ОШИБКА (должно быть исключение)" << std::endl;
+    } catch (const CipherError& e) {
+        std::cout << "✓ 4.3 Порядок {0,0,1} - OK: " << e.what() << std::endl;
+        passed++;
+    } catch (...) {
+        std::cout << "✗ 4.3 Порядок {0,0,1} - НЕВЕРНОЕ ИСКЛЮЧЕНИЕ" << std::endl;
+    }
+    
+    // 4.4 Широкая таблица (больше 50 столбцов)
+    try {
+        total++;
+        RouteCipher cipher(1000);
+        std::wstring original;
+        for (int i = 0; i < 5000; i++) {
+            original += static_cast<wchar_t>(L'А' + i % 32);
+        }
+        
+        if (cipher.Decrypt(cipher.Encrypt(original)) == original) {
+            std::cout << "✓ 4.4 Ключ=1000 - OK" << std::endl;
+            passed++;
+        } else {
+            std::cout << "✗ 4.4 Ключ=1000 - ОШИБКА" << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cout << "✗ 4.4 Ключ=1000 - ОШИБКА: " << e.what() << std::endl;
+    }
+    
+    // 4.5 Размер блока транспонирования не влияет на результат
+    try {
+        total++;
+        RouteCipher tiled(37);
+        RouteCipher plain(37);
+        tiled.SetTile(5);
+        std::wstring original;
+        for (int i = 0; i < 2000; i++) {
+            original += static_cast<wchar_t>(L'А' + i % 32);
+        }
+        
+        std::wstring encrypted = tiled.Encrypt(original);
+        if (encrypted == plain.Encrypt(original) && tiled.Decrypt(encrypted) == original) {
+            std::cout << "✓ 4.5 Блок 5x5 - OK" << std::endl;
+            passed++;
+        } else {
+            std::cout << "✗ 4.5 Блок 5x5 - ОШИБКА" << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cout << "✗ 4.5 Блок 5x5 - ОШИБКА: " << e.what() << std::endl;
+    }
+    
+    // 4.6 Пакетный режим совпадает с обычным
+    try {
+        total++;
+        RouteCipher cipher(7);
+        BufferArena arena;
+        std::wstring original = L"пакетная обработка\tбольших текстов";
+        std::wstring encrypted = cipher.Encrypt(original);
+        
+        bool same = cipher.EncryptBulk(original, arena) == encrypted;
+        bool back = cipher.DecryptBulk(encrypted, arena) == cipher.Decrypt(encrypted);
+        if (same && back) {
+            std::cout << "✓ 4.6 Пакетный режим - OK" << std::endl;
+            passed++;
+        } else {
+            std::cout << "✗ 4.6 Пакетный режим - ОШИБКА" << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cout << "✗ 4.6 Пакетный режим - ОШИБКА: " << e.what() << std::endl;
+    }
+    
+    // 4.7 Кадровый режим: точное восстановление, потоки и параллельная обработка
+    try {
+        total++;
+        RouteCipher cipher(4);
+        std::wstring original = L"кадровый режим шифрования заканчивается на XX";
+        std::wstring encrypted = cipher.EncryptFramed(original, 3);
+        std::wstring prepared = cipher.PrepareText(original);
+        
+        bool exact = cipher.DecryptFramed(encrypted, 3) == prepared;
+        bool parallel = cipher.EncryptFramed(original, 3, 4) == encrypted &&
+                        cipher.DecryptFramed(encrypted, 3, 4) == prepared;
+        std::wistringstream in(original);
+        std::wostringstream out;
+        cipher.EncryptStream(in, out, 3, 2);
+        std::wistringstream back(out.str());
+        std::wostringstream restored;
+        cipher.DecryptStream(back, restored, 3);
+        bool stream = out.str() == encrypted && restored.str() == prepared;
+        if (exact && parallel && stream) {
+            std::cout << "✓ 4.7 Кадровый режим - OK" << std::endl;
+            passed++;
+        } else {
+            std::cout << "✗ 4.7 Кадровый режим - ОШИБКА" << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cout << "✗ 4.7 Кадровый режим - ОШИБКА: " << e.what() << std::endl;
+    }
+    
+    // 4.8 Вход UTF-16 и символы вне BMP
+    try {
+        total++;
+        RouteCipher cipher(3);
+        std::u16string narrow = u"маршрут в utf-16";
+        std::wstring wide = L"маршрут в utf-16";
+        std::u16string encrypted = cipher.Encrypt(narrow);
+        bool same = std::wstring(encrypted.begin(), encrypted.end()) == cipher.Encrypt(wide) &&
+                    cipher.Decrypt(encrypted) == u"МАРШРУТВUTF-16";
+        
+        std::wstring astral = L"ключ\U0001F511замок";
+        std::u16string astral16 = u"ключ\U0001F511замок";
+        bool outside = cipher.Decrypt(cipher.Encrypt(astral)) == L"КЛЮЧ\U0001F511ЗАМОК" &&
+                       cipher.Decrypt(cipher.Encrypt(astral16)) == u"КЛЮЧ\U0001F511ЗАМОК";
+        if (same && outside) {
+            std::cout << "✓ 4.8 UTF-16 и символы вне BMP - OK" << std::endl;
+            passed++;
+        } else {
+            std::cout << "✗ 4.8 UTF-16 и символы вне BMP - ОШИБКА" << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cout << "✗ 4.8 UTF-16 и символы вне BMP - ОШИБКА: " << e.what() << std::endl;
+    }
+    
+    // 4.9 Специализированные ядра для 2-16 столбцов совпадают с общим маршрутом
+    try {
+        total++;
+        std::wstring original;
+        for (int i = 0; i < 203; i++) {
+            original += static_cast<wchar_t>(L'А' + (i * 7) % 32);
+        }
+        bool same = true;
+        for (int columns = 2; columns <= 17; columns++) {
+            RouteCipher cipher(columns);
+            std::wstring encrypted = cipher.Encrypt(original);
+            same = same && cipher.Decrypt(encrypted) == original;
+            std::vector<size_t> order(columns);
+            for (int j = 0; j < columns; j++) {
+                order[j] = columns - 1 - j;
+            }
+            same = same && encrypted == cipher.Encrypt(original, KeyedColumns(order));
+        }
+        if (same) {
+            std::cout << "✓ 4.9 Ядра для 2-16 столбцов - OK" << std::endl;
+            passed++;
+        } else {
+            std::cout << "✗ 4.9 Ядра для 2-16 столбцов - ОШИБКА" << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cout << "✗ 4.9 Ядра для 2-16 столбцов - ОШИБКА: " << e.what() << std::endl;
+    }
+    
+    // 4.10 Блочные маршруты и обход отрезками совпадают с вектором порядка
+    try {
+        total++;
+        std::wstring original;
+        for (int i = 0; i < 1001; i++) {
+            original += static_cast<wchar_t>(L'А' + (i * 5) % 32);
+        }
+        bool same = true;
+        for (int columns : {1, 3, 17, 40}) {
+            RouteCipher cipher(columns);
+            size_t rows = (original.size() + columns - 1) / columns;
+            std::wstring table = original;
+            table.resize(rows * columns, L'X');
+            std::vector<size_t> key(columns);
+            for (int j = 0; j < columns; j++) {
+                key[j] = (j + columns / 2) % columns;
+            }
+            auto check = [&](const auto& route) {
+                std::vector<size_t> order;
+                route.BuildOrder(rows, columns, order);
+                std::wstring expected(order.size(), L'X');
+                for (size_t p = 0; p < order.size(); p++) {
+                    expected[p] = table[order[p]];
+                }
+                std::wstring encrypted = cipher.Encrypt(original, route);
+                return encrypted == expected && cipher.Decrypt(encrypted, route) == original;
+            };
+            for (size_t tile : {size_t(1), size_t(7), size_t(32)}) {
+                cipher.SetTile(tile);
+                same = same && check(SnakeColumns()) && check(KeyedColumns(key)) &&
+                       check(SpiralRoute()) && check(DiagonalRoute());
+            }
+        }
+        if (same) {
+            std::cout << "✓ 4.10 Блочные маршруты и отрезки - OK" << std::endl;
+            passed++;
+        } else {
+            std::cout << "✗ 4.10 Блочные маршруты и отрезки - ОШИБКА" << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cout << "✗ 4.10 Блочные маршруты и отрезки - ОШИБКА: " << e.what() << std::endl;
+    }
+    
     // ИТОГИ тестирования
     std::cout << "\n==========================================" << std::endl;
     std::cout << "ИТОГИ ТЕСТИРОВАНИЯ:" << std::endl;
@@ -0,0 +1,525 @@
+/**
+ * @file AutoTuner.cpp
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Реализация автоматического выбора реализации шифров
+ * @copyright ИБСТ ПГУ
+ */
+
+#include "AutoTuner.h"
+#include "2/RouteKernels.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <cerrno>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+
+const char* const profileMagic = "lb4-autotune"; ///< Первое слово профиля
+const int profileVersion = 1; ///< Версия формата профиля
+
+/**
+ * @brief Запуск функции в нескольких потоках с передачей исключения
+ * @param [in] threads Количество потоков
+ * @param [in] work Функция от номера потока
+ * @details Первое исключение из потоков перевыбрасывается после join
+ */
+template <typename Work>
+void runThreads(unsigned threads, Work work)
+{
+    vector<exception_ptr> errors(threads);
+    vector<thread> pool;
+    pool.reserve(threads);
+    for (unsigned k = 0; k < threads; ++k) {
+        pool.emplace_back([&, k]() {
+            try {
+                work(k);
+            } catch (...) {
+                errors[k] = current_exception();
+            }
+        });
+    }
+    for (thread& t : pool) {
+        t.join();
+    }
+    for (const exception_ptr& error : errors) {
+        if (error) {
+            rethrow_exception(error);
+        }
+    }
+}
+
+/**
+ * @brief Количество аппаратных потоков (не меньше 1)
+ */
+unsigned hardwareThreads()
+{
+    unsigned n = thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+}
+
+/**
+ * @brief Лучшее время из нескольких запусков, в наносекундах
+ */
+template <typename Work>
+double bestTime(int repeats, Work work)
+{
+    double best = 1e300;
+    for (int r = 0; r < repeats; ++r) {
+        auto start = chrono::steady_clock::now();
+        work();
+        auto stop = chrono::steady_clock::now();
+        best = min(best, chrono::duration<double, nano>(stop - start).count());
+    }
+    return best;
+}
+
+/**
+ * @brief Объединение соседних точек сетки с одинаковым выбором
+ */
+vector<TuningRange> mergeRanges(const vector<TuningRange>& points)
+{
+    vector<TuningRange> merged;
+    for (const TuningRange& point : points) {
+        if (!merged.empty() && merged.back().kernel == point.kernel && merged.back().param == point.param) {
+            merged.back().maxSize = point.maxSize;
+        } else {
+            merged.push_back(point);
+        }
+    }
+    return merged;
+}
+
+} // namespace
+
+/**
+ * @brief Конструктор
+ * @param [in] path Путь к файлу профиля
+ */
+AutoTuner::AutoTuner(const string& path) : profilePath(path)
+{
+}
+
+/**
+ * @brief Путь к профилю по умолчанию
+ */
+string AutoTuner::defaultProfilePath()
+{
+    const char* cache = getenv("XDG_CACHE_HOME");
+    if (cache != nullptr && cache[0] == '/') {
+        return string(cache) + "/lb4/autotune.profile";
+    }
+    const char* home = getenv("HOME");
+    if (home != nullptr && home[0] != '\0') {
+        return string(home) + "/.cache/lb4/autotune.profile";
+    }
+    return "autotune.profile";
+}
+
+/**
+ * @brief Загрузка или калибровка профиля при первом вызове
+ * @details Вызывается под lock
+ */
+void AutoTuner::ensureReady()
+{
+    if (ready) {
+        return;
+    }
+    if (!readProfile()) {
+        measure();
+        writeProfile();
+    }
+    ready = true;
+}
+
+/**
+ * @brief Калибровка и сохранение профиля
+ */
+void AutoTuner::calibrate()
+{
+    lock_guard<mutex> guard(lock);
+    measure();
+    writeProfile();
+    ready = true;
+}
+
+/**
+ * @brief Замеры и построение порогов
+ * @details Сетка размеров от 1 КиБ до 4 МиБ с шагом 4. Для шифра Гронсфельда
+ *          сравниваются эталонная и однопроходная реализации и однопроходная
+ *          в 2, 4, ... потоках; для перестановки - обход столбцов без блоков
+ *          и блочное транспонирование с разной стороной блока на квадратной
+ *          таблице, где доступ к памяти хуже всего.
+ */
+void AutoTuner::measure()
+{
+    const size_t minSize = 1 << 10;
+    const size_t maxSize = 1 << 22;
+    const size_t tiles[] = {8, 16, 32, 64, 128};
+
+    vector<unsigned> threadCounts;
+    for (unsigned n = 2; n <= min(hardwareThreads(), 16u); n *= 2) {
+        threadCounts.push_back(n);
+    }
+    if (hardwareThreads() > 2 && hardwareThreads() <= 16 && threadCounts.back() != hardwareThreads()) {
+        threadCounts.push_back(hardwareThreads());
+    }
+
+    modAlphaCipher cipher("АВТОНАСТРОЙКА");
+    RouteCipher route(2);
+    vector<TuningRange> gronsfeldPoints;
+    vector<TuningRange> routePoints;
+
+    for (size_t size = minSize; size <= maxSize; size *= 4) {
+        int repeats = static_cast<int>(max<size_t>(3, min<size_t>(30, maxSize / size)));
+
+        // Шифр Гронсфельда: size байт русских букв
+        string text;
+        text.reserve(size);
+        static const char letters[] = "ПРИВЕТМИРШИФРЁЖ";
+        for (size_t i = 0; text.size() + 2 <= size; i = (i + 2) % (sizeof(letters) - 1)) {
+            text.append(letters + i, 2);
+        }
+
+        TuningRange best;
+        best.maxSize = size;
+        best.kernel = static_cast<unsigned>(GronsfeldKernel::Reference);
+        double bestNs = bestTime(repeats, [&]() { cipher.encrypt(text); });
+
+        double fusedNs = bestTime(repeats, [&]() {
+            size_t phase = 0;
+            cipher.encryptChunk(text, phase);
+        });
+        if (fusedNs < bestNs) {
+            bestNs = fusedNs;
+            best.kernel = static_cast<unsigned>(GronsfeldKernel::Fused);
+        }
+        for (unsigned threads : threadCounts) {
+            double ns = bestTime(repeats, [&]() { parallelTransform(cipher, text, threads, false); });
+            if (ns < bestNs) {
+                bestNs = ns;
+                best.kernel = static_cast<unsigned>(GronsfeldKernel::Fused);
+                best.param = threads;
+            }
+        }
+        gronsfeldPoints.push_back(best);
+
+        // Перестановка: size символов в почти квадратной таблице. Столбцов
+        // больше MaxKernelColumns, иначе вызов уходит в ядро pshufb, на
+        // которое сторона блока не влияет
+        size_t chars = size / 4;
+        wstring wide(chars, L'А');
+        for (size_t i = 0; i < chars; ++i) {
+            wide[i] = static_cast<wchar_t>(L'А' + i % 32);
+        }
+        route = RouteCipher(static_cast<int>(max<size_t>(MaxKernelColumns + 1,
+                                                          static_cast<size_t>(sqrt(static_cast<double>(chars))))));
+
+        TuningRange bestRoute;
+        bestRoute.maxSize = chars;
+        bestRoute.kernel = static_cast<unsigned>(RouteKernel::Ordered);
+        double bestRouteNs = bestTime(repeats, [&]() { runRoute(route, wide, bestRoute, false); });
+        for (size_t tile : tiles) {
+            TuningRange candidate;
+            candidate.maxSize = chars;
+            candidate.kernel = static_cast<unsigned>(RouteKernel::Blocked);
+            candidate.param = tile;
+            double ns = bestTime(repeats, [&]() { runRoute(route, wide, candidate, false); });
+            if (ns < bestRouteNs) {
+                bestRouteNs = ns;
+                bestRoute = candidate;
+            }
+        }
+        routePoints.push_back(bestRoute);
+    }
+
+    gronsfeldRanges = mergeRanges(gronsfeldPoints);
+    routeRanges = mergeRanges(routePoints);
+}
+
+/**
+ * @brief Загрузка профиля
+ * @return false если профиля нет, он поврежден или снят на другой машине
+ */
+bool AutoTuner::load()
+{
+    lock_guard<mutex> guard(lock);
+    if (!readProfile()) {
+        return false;
+    }
+    ready = true;
+    return true;
+}
+
+/**
+ * @brief Сохранение профиля
+ * @return false если файл записать не удалось
+ */
+bool AutoTuner::save() const
+{
+    lock_guard<mutex> guard(lock);
+    return writeProfile();
+}
+
+/**
+ * @brief Чтение профиля в пороги без блокировки
+ * @details Пороги заменяются только если профиль прочитан целиком
+ */
+bool AutoTuner::readProfile()
+{
+    ifstream in(profilePath);
+    if (!in) {
+        return false;
+    }
+
+    string magic, word;
+    int version = 0;
+    unsigned hardware = 0;
+    if (!(in >> magic >> version) || magic != profileMagic || version != profileVersion) {
+        return false;
+    }
+    if (!(in >> word >> hardware) || word != "hardware" || hardware != hardwareThreads()) {
+        return false;
+    }
+
+    vector<TuningRange> gronsfeld, routes;
+    TuningRange range;
+    while (in >> word >> range.maxSize >> range.kernel >> range.param) {
+        if (word == "gronsfeld" && range.kernel <= static_cast<unsigned>(GronsfeldKernel::Fused)
+            && range.param >= 1) {
+            gronsfeld.push_back(range);
+        } else if (word == "route" && range.kernel <= static_cast<unsigned>(RouteKernel::Blocked)
+                   && range.param >= 1) {
+            routes.push_back(range);
+        } else {
+            return false;
+        }
+    }
+    if (!in.eof() || gronsfeld.empty() || routes.empty()) {
+        return false;
+    }
+
+    gronsfeldRanges = gronsfeld;
+    routeRanges = routes;
+    return true;
+}
+
+/**
+ * @brief Запись порогов в профиль без блокировки
+ * @details Временный файл создаётся mkstemp рядом с профилем: у каждого
+ *          писателя свой файл, и rename подменяет профиль целиком
+ */
+bool AutoTuner::writeProfile() const
+{
+    error_code error;
+    filesystem::path path(profilePath);
+    if (path.has_parent_path()) {
+        filesystem::create_directories(path.parent_path(), error);
+    }
+
+    ostringstream out;
+    out << profileMagic << ' ' << profileVersion << '\n';
+    out << "hardware " << hardwareThreads() << '\n';
+    for (const TuningRange& range : gronsfeldRanges) {
+        out << "gronsfeld " << range.maxSize << ' ' << range.kernel << ' ' << range.param << '\n';
+    }
+    for (const TuningRange& range : routeRanges) {
+        out << "route " << range.maxSize << ' ' << range.kernel << ' ' << range.param << '\n';
+    }
+
+    string temp = profilePath + ".XXXXXX";
+    int fd = mkstemp(&temp[0]);
+    if (fd < 0) {
+        return false;
+    }
+    string text = out.str();
+    size_t done = 0;
+    while (done < text.size()) {
+        ssize_t n = write(fd, text.data() + done, text.size() - done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        done += static_cast<size_t>(n);
+    }
+    // mkstemp создаёт файл с правами 0600; профиль остаётся читаемым, как раньше
+    bool ok = done == text.size() && fchmod(fd, 0644) == 0;
+    ok = close(fd) == 0 && ok;
+    if (!ok || rename(temp.c_str(), profilePath.c_str()) != 0) {
+        unlink(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Выбор варианта для размера текста
+ * @details Берется первый диапазон, покрывающий размер; тексты больше
+ *          сетки калибровки используют вариант для самого большого размера
+ */
+const TuningRange& AutoTuner::pick(const vector<TuningRange>& ranges, size_t size)
+{
+    for (const TuningRange& range : ranges) {
+        if (size <= range.maxSize) {
+            return range;
+        }
+    }
+    return ranges.back();
+}
+
+/**
+ * @brief Выбранный вариант шифра Гронсфельда
+ */
+TuningRange AutoTuner::gronsfeldChoice(size_t bytes)
+{
+    lock_guard<mutex> guard(lock);
+    ensureReady();
+    return pick(gronsfeldRanges, bytes);
+}
+
+/**
+ * @brief Выбранный вариант перестановки
+ */
+TuningRange AutoTuner::routeChoice(size_t chars)
+{
+    lock_guard<mutex> guard(lock);
+    ensureReady();
+    return pick(routeRanges, chars);
+}
+
+/**
+ * @brief Шифр Гронсфельда выбранной реализацией
+ */
+string AutoTuner::runGronsfeld(modAlphaCipher& cipher, const string& text,
+                               const TuningRange& choice, bool decrypting)
+{
+    if (choice.kernel == static_cast<unsigned>(GronsfeldKernel::Reference)) {
+        return decrypting ? cipher.decrypt(text) : cipher.encrypt(text);
+    }
+    if (text.empty()) {
+        throw cipher_error(decrypting ? "Empty cipher text" : "Empty open text");
+    }
+
+    string result;
+    if (choice.param > 1) {
+        result = parallelTransform(cipher, text, static_cast<unsigned>(choice.param), decrypting);
+    } else {
+        size_t phase = 0;
+        result = decrypting ? cipher.decryptChunk(text, phase) : cipher.encryptChunk(text, phase);
+    }
+    if (result.empty()) {
+        throw cipher_error(decrypting ? "Empty cipher text" : "Empty open text");
+    }
+    return result;
+}
+
+/**
+ * @brief Перестановка выбранной реализацией
+ * @details Вариант Ordered - обход столбцов без разбиения на блоки:
+ *          сторона блока не меньше длины текста. Сторона блока задаётся
+ *          копии шифра: объект вызывающего не меняется и может
+ *          использоваться из нескольких потоков
+ */
+wstring AutoTuner::runRoute(RouteCipher& cipher, const wstring& text,
+                            const TuningRange& choice, bool decrypting)
+{
+    RouteCipher tiled(cipher);
+    if (choice.kernel == static_cast<unsigned>(RouteKernel::Ordered)) {
+        tiled.SetTile(max<size_t>({text.size(), static_cast<size_t>(cipher.GetColumns()), 1}));
+    } else {
+        tiled.SetTile(choice.param);
+    }
+    return decrypting ? tiled.Decrypt(text) : tiled.Encrypt(text);
+}
+
+/**
+ * @brief Шифрование текста шифром Гронсфельда
+ */
+string AutoTuner::encrypt(modAlphaCipher& cipher, const string& open_text)
+{
+    return runGronsfeld(cipher, open_text, gronsfeldChoice(open_text.size()), false);
+}
+
+/**
+ * @brief Дешифрование текста шифром Гронсфельда
+ */
+string AutoTuner::decrypt(modAlphaCipher& cipher, const string& cipher_text)
+{
+    return runGronsfeld(cipher, cipher_text, gronsfeldChoice(cipher_text.size()), true);
+}
+
+/**
+ * @brief Шифрование маршрутной перестановкой
+ */
+wstring AutoTuner::encryptRoute(RouteCipher& cipher, const wstring& open_text)
+{
+    return runRoute(cipher, open_text, routeChoice(open_text.size()), false);
+}
+
+/**
+ * @brief Дешифрование маршрутной перестановкой
+ */
+wstring AutoTuner::decryptRoute(RouteCipher& cipher, const wstring& cipher_text)
+{
+    return runRoute(cipher, cipher_text, routeChoice(cipher_text.size()), true);
+}
+
+/**
+ * @brief Шифр Гронсфельда в нескольких потоках
+ */
+string AutoTuner::parallelTransform(const modAlphaCipher& cipher, const string& text,
+                                    unsigned threads, bool decrypting)
+{
+    threads = max(1u, threads);
+
+    // Границы фрагментов сдвигаются вперед до начала символа UTF-8
+    vector<size_t> bounds(threads + 1, text.size());
+    bounds[0] = 0;
+    for (unsigned k = 1; k < threads; ++k) {
+        size_t b = max(bounds[k - 1], text.size() / threads * k);
+        while (b < text.size() && (static_cast<unsigned char>(text[b]) & 0xC0) == 0x80) {
+            ++b;
+        }
+        bounds[k] = b;
+    }
+
+    vector<string> parts(threads);
+    vector<size_t> phases(threads + 1, 0);
+    runThreads(threads, [&](unsigned k) {
+        parts[k].assign(text, bounds[k], bounds[k + 1] - bounds[k]);
+        phases[k + 1] = cipher.countLetters(parts[k]);
+    });
+    for (unsigned k = 0; k < threads; ++k) {
+        phases[k + 1] = (phases[k + 1] + phases[k]) % cipher.keyLength();
+    }
+
+    runThreads(threads, [&](unsigned k) {
+        size_t phase = phases[k];
+        parts[k] = decrypting ? cipher.decryptChunk(parts[k], phase) : cipher.encryptChunk(parts[k], phase);
+    });
+
+    size_t total = 0;
+    for (const string& part : parts) {
+        total += part.size();
+    }
+    string result;
+    result.reserve(total);
+    for (const string& part : parts) {
+        result += part;
+    }
+    return result;
+}
@@ -0,0 +1,223 @@
+/**
+ * @file AutoTuner.h
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Автоматический выбор реализации шифров по размеру текста
+ * @copyright ИБСТ ПГУ
+ * @details При первом вызове (или явном calibrate) замеряет доступные
+ *          реализации modAlphaCipher и RouteCipher на сетке размеров
+ *          текста, сохраняет пороги переключения в профиль и затем
+ *          выбирает для каждого вызова самый быстрый вариант.
+ *
+ * Профиль - текстовый файл $XDG_CACHE_HOME/lb4/autotune.profile
+ * (или ~/.cache/lb4/autotune.profile):
+ *
+ *   lb4-autotune 1
+ *   hardware <количество аппаратных потоков>
+ *   gronsfeld <макс. размер в байтах> <вариант> <потоков>
+ *   route <макс. размер в символах> <вариант> <сторона блока>
+ *
+ * Профиль, снятый на машине с другим количеством потоков, не
+ * используется и калибровка выполняется заново.
+ */
+
+#ifndef AUTOTUNER_H
+#define AUTOTUNER_H
+
+#include "modAlphaCipher.h"
+#include "2/RouteCipher.h"
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstddef>
+
+/**
+ * @brief Реализация шифра Гронсфельда
+ */
+enum class GronsfeldKernel : unsigned {
+    Reference = 0, ///< modAlphaCipher::encrypt через вектор индексов
+    Fused = 1      ///< encryptChunk: декодирование, сдвиг и запись за один проход
+};
+
+/**
+ * @brief Реализация маршрута по умолчанию в RouteCipher
+ */
+enum class RouteKernel : unsigned {
+    Ordered = 0, ///< Обход по столбцам без разбиения на блоки
+    Blocked = 1  ///< Блочное транспонирование с заданной стороной блока
+};
+
+/**
+ * @brief Вариант реализации для диапазона размеров текста
+ */
+struct TuningRange {
+    size_t maxSize = 0; ///< Верхняя граница размера (включительно)
+    unsigned kernel = 0; ///< Номер реализации (GronsfeldKernel или RouteKernel)
+    size_t param = 1; ///< Количество потоков для Гронсфельда или сторона блока для перестановки
+};
+
+/**
+ * @brief Автонастройка реализаций шифров
+ * @details Методы шифрования дают тот же результат, что и прямые вызовы
+ *          modAlphaCipher и RouteCipher, и отличаются только скоростью.
+ *          Для длинных текстов шифр Гронсфельда выполняется в нескольких
+ *          потоках: фаза ключа каждого фрагмента вычисляется по числу букв
+ *          в предыдущих фрагментах.
+ *
+ * calibrate, load, save и методы шифрования можно вызывать из нескольких
+ * потоков: пороги читаются и заменяются под lock, а вызов шифрования
+ * копирует выбранный вариант и выполняется без блокировки. Калибровка
+ * выполняется один раз.
+ */
+class AutoTuner
+{
+private:
+    std::string profilePath; ///< Путь к файлу профиля
+    bool ready = false; ///< Профиль загружен или откалиброван
+    mutable std::mutex lock; ///< Защита порогов и однократной калибровки
+    std::vector<TuningRange> gronsfeldRanges; ///< Пороги для шифра Гронсфельда по размеру в байтах
+    std::vector<TuningRange> routeRanges; ///< Пороги для перестановки по размеру в символах
+
+    /**
+     * @brief Загрузка или калибровка профиля при первом вызове
+     * @details Вызывается под lock
+     */
+    void ensureReady();
+
+    /**
+     * @brief Чтение профиля в пороги без блокировки
+     */
+    bool readProfile();
+
+    /**
+     * @brief Запись порогов в профиль без блокировки
+     */
+    bool writeProfile() const;
+
+    /**
+     * @brief Выбор варианта для размера текста
+     */
+    static const TuningRange& pick(const std::vector<TuningRange>& ranges, size_t size);
+
+    /**
+     * @brief Шифр Гронсфельда выбранной реализацией
+     */
+    static std::string runGronsfeld(modAlphaCipher& cipher, const std::string& text,
+                                    const TuningRange& choice, bool decrypting);
+
+    /**
+     * @brief Перестановка выбранной реализацией
+     */
+    static std::wstring runRoute(RouteCipher& cipher, const std::wstring& text,
+                                 const TuningRange& choice, bool decrypting);
+
+    /**
+     * @brief Замеры и построение порогов без блокировки
+     */
+    void measure();
+
+public:
+    /**
+     * @brief Конструктор
+     * @param [in] path Путь к файлу профиля
+     * @details Профиль читается лениво, при первом шифровании
+     */
+    explicit AutoTuner(const std::string& path = defaultProfilePath());
+
+    /**
+     * @brief Путь к профилю по умолчанию
+     * @return $XDG_CACHE_HOME/lb4/autotune.profile, ~/.cache/lb4/autotune.profile
+     *         или autotune.profile в текущем каталоге, если HOME не задан
+     */
+    static std::string defaultProfilePath();
+
+    /**
+     * @brief Калибровка и сохранение профиля
+     * @details Занимает порядка секунды; результат сохраняется, поэтому
+     *          повторные запуски программы калибровку не выполняют
+     */
+    void calibrate();
+
+    /**
+     * @brief Загрузка профиля
+     * @return false если профиля нет, он поврежден или снят на другой машине
+     */
+    bool load();
+
+    /**
+     * @brief Сохранение профиля
+     * @return false если файл записать не удалось
+     * @details Файл заменяется атомарно через временный файл с
+     *          уникальным именем (mkstemp) в каталоге профиля, поэтому
+     *          процессы с общим профилем не смешивают записи
+     */
+    bool save() const;
+
+    /**
+     * @brief Шифрование текста шифром Гронсфельда
+     * @param [in] cipher Шифр с ключом
+     * @param [in] open_text Открытый текст
+     * @return Результат, совпадающий с cipher.encrypt(open_text)
+     * @throw cipher_error если текст пуст или содержит недопустимые символы
+     */
+    std::string encrypt(modAlphaCipher& cipher, const std::string& open_text);
+
+    /**
+     * @brief Дешифрование текста шифром Гронсфельда
+     * @param [in] cipher Шифр с ключом
+     * @param [in] cipher_text Зашифрованный текст
+     * @return Результат, совпадающий с cipher.decrypt(cipher_text)
+     * @throw cipher_error если текст пуст или содержит недопустимые символы
+     */
+    std::string decrypt(modAlphaCipher& cipher, const std::string& cipher_text);
+
+    /**
+     * @brief Шифрование маршрутной перестановкой
+     * @param [in] cipher Шифр с ключом
+     * @param [in] open_text Открытый текст
+     * @return Результат, совпадающий с cipher.Encrypt(open_text)
+     * @throw CipherError если текст пустой или содержит только пробелы
+     */
+    std::wstring encryptRoute(RouteCipher& cipher, const std::wstring& open_text);
+
+    /**
+     * @brief Дешифрование маршрутной перестановкой
+     * @param [in] cipher Шифр с ключом
+     * @param [in] cipher_text Зашифрованный текст
+     * @return Результат, совпадающий с cipher.Decrypt(cipher_text)
+     * @throw CipherError если текст пустой или содержит только пробелы
+     */
+    std::wstring decryptRoute(RouteCipher& cipher, const std::wstring& cipher_text);
+
+    /**
+     * @brief Выбранный вариант шифра Гронсфельда
+     * @param [in] bytes Размер текста в байтах
+     * @return Копия варианта, снятая под блокировкой
+     */
+    TuningRange gronsfeldChoice(size_t bytes);
+
+    /**
+     * @brief Выбранный вариант перестановки
+     * @param [in] chars Размер текста в символах
+     * @return Копия варианта, снятая под блокировкой
+     */
+    TuningRange routeChoice(size_t chars);
+
+    /**
+     * @brief Шифр Гронсфельда в нескольких потоках
+     * @param [in] cipher Шифр с ключом
+     * @param [in] text Текст в UTF-8
+     * @param [in] threads Количество потоков
+     * @param [in] decrypting true для дешифрования
+     * @return Результат, совпадающий с однопоточным encryptChunk/decryptChunk
+     * @throw cipher_error если текст содержит недопустимые символы
+     * @details Текст делится на фрагменты по границам символов; каждый поток
+     *          считает буквы своего фрагмента, по префиксным суммам
+     *          вычисляются фазы ключа, затем фрагменты шифруются независимо
+     */
+    static std::string parallelTransform(const modAlphaCipher& cipher, const std::string& text,
+                                         unsigned threads, bool decrypting);
+};
+
+#endif // AUTOTUNER_H
@@ -0,0 +1,606 @@
+/**
+ * @file BatchProcessor.cpp
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Реализация пакетного шифрования дерева каталогов
+ * @copyright ИБСТ ПГУ
+ */
+
+#include "BatchProcessor.h"
+#include "Utf8.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace {
+
+/**
+ * @brief Сообщение об ошибке системного вызова
+ * @param [in] what Описание операции
+ * @param [in] err Код ошибки errno
+ */
+string systemMessage(const string& what, int err)
+{
+    return what + ": " + strerror(err);
+}
+
+/**
+ * @brief Полная запись буфера в файл по смещению
+ * @throw batch_error при ошибке записи
+ */
+void writeAll(int fd, const char* data, size_t size, uint64_t offset)
+{
+    while (size > 0) {
+        ssize_t n = pwrite(fd, data, size, static_cast<off_t>(offset));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw batch_error(systemMessage("Write failed", errno));
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+}
+
+/**
+ * @brief Нулевой концевик кадрового шифротекста
+ * @details Дописывается к группам кадров, кроме последней: в них все
+ *          кадры полные и заполнителей нет
+ */
+const wstring zeroTrailer = L"#00000000";
+
+} // namespace
+
+/**
+ * @brief Общие итоги обработки
+ */
+struct BatchProcessor::Progress {
+    mutex lock; ///< Защищает report
+    BatchReport report; ///< Итоги
+};
+
+/**
+ * @brief Состояние обработки одного файла
+ * @details Принадлежит задачам файла через shared_ptr; отображение
+ *          входного файла, дескриптор и недописанный временный файл
+ *          освобождаются вместе с последней задачей
+ */
+struct BatchProcessor::FileJob {
+    string inPath; ///< Входной файл
+    string outPath; ///< Выходной файл
+    string tempPath; ///< Временный файл; пуст после переименования
+    Progress* progress = nullptr; ///< Общие итоги
+    const char* data = nullptr; ///< Отображение входного файла
+    size_t size = 0; ///< Размер входного файла
+    mode_t permissions = 0644; ///< Права входного файла
+    int outFd = -1; ///< Дескриптор временного файла
+
+    vector<size_t> bounds; ///< Границы кусков (шифр Гронсфельда), на одну больше кусков
+    vector<size_t> letters; ///< Букв в куске, затем фаза ключа куска
+    vector<uint64_t> offsets; ///< Смещение результата куска в выходном файле
+
+    wstring cells; ///< Подготовленный текст (перестановка)
+    size_t segmentCells = 0; ///< Символов в группе кадров
+    vector<string> parts; ///< Результаты групп кадров в UTF-8
+
+    atomic<size_t> remaining{0}; ///< Незавершённые задачи текущего этапа
+    atomic<uint64_t> outSize{0}; ///< Записано байт
+    atomic<bool> failed{false}; ///< Произошла ошибка
+    mutex errorLock; ///< Защищает error
+    string error; ///< Первая ошибка
+
+    ~FileJob()
+    {
+        if (data != nullptr) {
+            munmap(const_cast<char*>(data), size);
+        }
+        if (outFd >= 0) {
+            close(outFd);
+        }
+        if (!tempPath.empty()) {
+            unlink(tempPath.c_str());
+        }
+    }
+
+    /**
+     * @brief Запоминание первой ошибки; остальные задачи файла пропускают работу
+     */
+    void fail(const string& what)
+    {
+        lock_guard<mutex> guard(errorLock);
+        if (!failed) {
+            error = what;
+            failed = true;
+        }
+    }
+};
+
+/**
+ * @brief Пул потоков с кражей задач
+ * @details У каждого потока своя очередь под своим мьютексом, поэтому
+ *          потоки почти не соперничают. Владелец берёт задачи с конца
+ *          очереди: файлы кладутся от малых к большим, и владелец начинает
+ *          с больших, а куски файла, поставленные им же, обрабатывает,
+ *          пока они ещё в кэше. Простаивающий поток крадёт задачу с начала
+ *          чужой очереди. Задача может ставить новые задачи; счётчик
+ *          pending увеличивается раньше, чем уменьшается счётчик
+ *          поставившей задачи, поэтому потоки завершаются только после
+ *          выполнения всех задач.
+ */
+class BatchProcessor::TaskPool
+{
+public:
+    typedef function<void(unsigned)> Task; ///< Задача; получает номер выполняющего потока
+
+private:
+    struct Queue {
+        mutex lock;
+        deque<Task> tasks;
+    };
+
+    vector<Queue> queues;
+    atomic<size_t> pending{0};
+    atomic<uint64_t> executed{0};
+    atomic<uint64_t> stolen{0};
+    mutex errorLock;
+    exception_ptr error;
+
+    bool take(unsigned worker, Task& task)
+    {
+        {
+            Queue& own = queues[worker];
+            lock_guard<mutex> guard(own.lock);
+            if (!own.tasks.empty()) {
+                task = move(own.tasks.back());
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        size_t count = queues.size();
+        for (size_t k = 1; k < count; ++k) {
+            Queue& victim = queues[(worker + k) % count];
+            lock_guard<mutex> guard(victim.lock);
+            if (!victim.tasks.empty()) {
+                task = move(victim.tasks.front());
+                victim.tasks.pop_front();
+                ++stolen;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void work(unsigned worker)
+    {
+        unsigned idle = 0;
+        while (pending.load() > 0) {
+            Task task;
+            if (!take(worker, task)) {
+                // Задачи ещё выполняются и могут поставить новые
+                if (++idle < 64) {
+                    this_thread::yield();
+                } else {
+                    this_thread::sleep_for(chrono::microseconds(200));
+                }
+                continue;
+            }
+            idle = 0;
+            try {
+                task(worker);
+            } catch (...) {
+                lock_guard<mutex> guard(errorLock);
+                if (!error) {
+                    error = current_exception();
+                }
+            }
+            ++executed;
+            --pending;
+        }
+    }
+
+public:
+    explicit TaskPool(unsigned threads) : queues(threads) {}
+
+    unsigned threads() const { return static_cast<unsigned>(queues.size()); }
+    uint64_t tasks() const { return executed; }
+    uint64_t steals() const { return stolen; }
+
+    /**
+     * @brief Постановка задачи в очередь потока
+     */
+    void push(unsigned worker, Task task)
+    {
+        ++pending;
+        Queue& queue = queues[worker % queues.size()];
+        lock_guard<mutex> guard(queue.lock);
+        queue.tasks.push_back(move(task));
+    }
+
+    /**
+     * @brief Выполнение всех задач; вызывающий поток работает как поток 0
+     * @throw исключение первой задачи, завершившейся исключением
+     */
+    void run()
+    {
+        vector<thread> workers;
+        for (unsigned w = 1; w < queues.size(); ++w) {
+            workers.emplace_back(&TaskPool::work, this, w);
+        }
+        work(0);
+        for (thread& t : workers) {
+            t.join();
+        }
+        if (error) {
+            rethrow_exception(error);
+        }
+    }
+};
+
+/**
+ * @brief Конструктор для шифра Гронсфельда
+ * @param [in] cipher Шифр
+ * @param [in] batchOptions Параметры
+ */
+BatchProcessor::BatchProcessor(const modAlphaCipher& cipher, const BatchOptions& batchOptions)
+    : engine(Engine::Gronsfeld), gronsfeld(&cipher), route(1), options(batchOptions)
+{
+    if (options.chunkSize == 0) {
+        throw batch_error("Chunk size must be positive");
+    }
+}
+
+/**
+ * @brief Конструктор для шифра перестановки
+ * @param [in] cipher Шифр
+ * @param [in] batchOptions Параметры
+ */
+BatchProcessor::BatchProcessor(const RouteCipher& cipher, const BatchOptions& batchOptions)
+    : engine(Engine::Route), route(cipher), options(batchOptions)
+{
+    if (options.chunkSize == 0) {
+        throw batch_error("Chunk size must be positive");
+    }
+    if (options.frameRows == 0) {
+        throw batch_error("Frame rows must be positive");
+    }
+}
+
+/**
+ * @brief Обработка дерева каталогов
+ * @param [in] inputDir Входной каталог
+ * @param [in] outputDir Выходной каталог
+ * @return Итоги обработки
+ */
+BatchReport BatchProcessor::run(const string& inputDir, const string& outputDir)
+{
+    auto started = chrono::steady_clock::now();
+
+    error_code ec;
+    if (!fs::is_directory(inputDir, ec)) {
+        throw batch_error("Cannot read input directory: " + inputDir);
+    }
+    vector<pair<uintmax_t, fs::path>> files;
+    fs::recursive_directory_iterator it(inputDir, ec);
+    for (; !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        if (it->is_regular_file(ec)) {
+            files.emplace_back(it->file_size(ec), it->path());
+        }
+    }
+    if (ec) {
+        throw batch_error("Cannot read input directory: " + inputDir + ": " + ec.message());
+    }
+    // Файлы от малых к большим: владелец очереди берёт с конца
+    sort(files.begin(), files.end());
+
+    unsigned threads = options.threads;
+    if (threads == 0) {
+        threads = max(1u, thread::hardware_concurrency());
+    }
+    TaskPool pool(threads);
+    Progress progress;
+
+    // Большие файлы - в конец очередей, по кругу между потоками
+    for (size_t i = 0; i < files.size(); ++i) {
+        auto job = make_shared<FileJob>();
+        job->inPath = files[i].second.string();
+        job->outPath = (fs::path(outputDir) / files[i].second.lexically_relative(inputDir)).string();
+        job->progress = &progress;
+        unsigned worker = static_cast<unsigned>((files.size() - 1 - i) % threads);
+        pool.push(worker, [this, &pool, job](unsigned self) { startFile(pool, self, job); });
+    }
+    pool.run();
+
+    BatchReport report = move(progress.report);
+    report.tasks = pool.tasks();
+    report.steals = pool.steals();
+    report.threads = threads;
+    report.seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+    return report;
+}
+
+/**
+ * @brief Открытие файла и разбиение его на задачи
+ * @param [in] pool Пул задач
+ * @param [in] worker Поток, выполняющий задачу
+ * @param [in] job Файл
+ * @details Куски шифра Гронсфельда режутся по границам символов UTF-8.
+ *          Фаза ключа куска зависит от числа букв перед ним, поэтому
+ *          сначала буквы кусков считаются параллельно, а шифрование
+ *          ставится в очередь после подсчёта всех кусков. Перестановка
+ *          режется по целым кадрам и фаз не требует.
+ */
+void BatchProcessor::startFile(TaskPool& pool, unsigned worker, const shared_ptr<FileJob>& job)
+{
+    try {
+        int fd = open(job->inPath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw batch_error(systemMessage("Cannot open", errno));
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            int err = errno;
+            close(fd);
+            throw batch_error(systemMessage("Cannot stat", err));
+        }
+        job->size = static_cast<size_t>(st.st_size);
+        job->permissions = st.st_mode & 0777;
+        if (job->size > 0) {
+            void* p = mmap(nullptr, job->size, PROT_READ, MAP_PRIVATE, fd, 0);
+            int err = errno;
+            close(fd);
+            if (p == MAP_FAILED) {
+                throw batch_error(systemMessage("Cannot map", err));
+            }
+            job->data = static_cast<const char*>(p);
+            madvise(p, job->size, MADV_SEQUENTIAL);
+        } else {
+            close(fd);
+        }
+
+        error_code ec;
+        fs::create_directories(fs::path(job->outPath).parent_path(), ec);
+        if (ec) {
+            throw batch_error("Cannot create output directory: " + ec.message());
+        }
+        string temp = job->outPath + ".XXXXXX";
+        job->outFd = mkostemp(&temp[0], O_CLOEXEC);
+        if (job->outFd < 0) {
+            throw batch_error(systemMessage("Cannot create " + temp, errno));
+        }
+        job->tempPath = temp;
+        fchmod(job->outFd, job->permissions);
+    } catch (const exception& e) {
+        job->fail(e.what());
+        finishFile(*job);
+        return;
+    }
+
+    if (job->size == 0) {
+        finishFile(*job);
+        return;
+    }
+
+    if (engine == Engine::Gronsfeld) {
+        const char* data = job->data;
+        size_t pos = 0;
+        job->bounds.push_back(0);
+        while (pos < job->size) {
+            pos = min(job->size, pos + options.chunkSize);
+            while (pos < job->size && (static_cast<unsigned char>(data[pos]) & 0xC0) == 0x80) {
+                ++pos;
+            }
+            job->bounds.push_back(pos);
+        }
+        size_t chunks = job->bounds.size() - 1;
+        job->letters.assign(chunks, 0);
+        job->offsets.assign(chunks, 0);
+        job->remaining = chunks;
+        if (chunks == 1) {
+            transformChunk(*job, 0);
+            return;
+        }
+        for (size_t i = 0; i < chunks; ++i) {
+            pool.push(worker, [this, &pool, job, i](unsigned self) { countChunk(pool, self, job, i); });
+        }
+        return;
+    }
+
+    size_t segments = 1;
+    try {
+        wstring wide;
+        if (!utf8ToWide(string(job->data, job->size), wide)) {
+            throw batch_error("Invalid UTF-8 sequence");
+        }
+        RouteCipher cipher(route);
+        job->cells = cipher.PrepareText(wide);
+        munmap(const_cast<char*>(job->data), job->size);
+        job->data = nullptr;
+
+        size_t frameCells = options.frameRows * static_cast<size_t>(cipher.GetColumns());
+        size_t frames = max<size_t>(1, options.chunkSize / (frameCells * sizeof(char16_t)));
+        job->segmentCells = frames * frameCells;
+        size_t body = job->cells.size();
+        if (options.decrypting) {
+            body = body > RouteCipher::FrameTrailer ? body - RouteCipher::FrameTrailer : 0;
+        }
+        segments = max<size_t>(1, (body + job->segmentCells - 1) / job->segmentCells);
+        job->parts.resize(segments);
+    } catch (const exception& e) {
+        job->fail(e.what());
+        finishFile(*job);
+        return;
+    }
+    job->remaining = segments;
+    if (segments == 1) {
+        transformSegment(*job, 0);
+        return;
+    }
+    for (size_t i = 0; i < segments; ++i) {
+        pool.push(worker, [this, job, i](unsigned) { transformSegment(*job, i); });
+    }
+}
+
+/**
+ * @brief Подсчёт букв куска для вычисления фаз ключа
+ */
+void BatchProcessor::countChunk(TaskPool& pool, unsigned worker, const shared_ptr<FileJob>& job, size_t index)
+{
+    if (!job->failed) {
+        size_t from = job->bounds[index];
+        job->letters[index] = gronsfeld->countLetters(string_view(job->data + from, job->bounds[index + 1] - from));
+    }
+    if (--job->remaining > 0) {
+        return;
+    }
+    if (job->failed) {
+        finishFile(*job);
+        return;
+    }
+
+    // Все куски подсчитаны: фазы и смещения результатов
+    size_t chunks = job->letters.size();
+    size_t keyLength = gronsfeld->keyLength();
+    bool strict = gronsfeld->mode == TextMode::Strict;
+    uint64_t before = 0;
+    for (size_t i = 0; i < chunks; ++i) {
+        job->offsets[i] = strict ? 2 * before : job->bounds[i];
+        size_t count = job->letters[i];
+        job->letters[i] = static_cast<size_t>(before % keyLength);
+        before += count;
+    }
+    job->remaining = chunks;
+    for (size_t i = 0; i < chunks; ++i) {
+        pool.push(worker, [this, job, i](unsigned) { transformChunk(*job, i); });
+    }
+}
+
+/**
+ * @brief Шифрование куска шифром Гронсфельда и запись по его смещению
+ */
+void BatchProcessor::transformChunk(FileJob& job, size_t index)
+{
+    if (!job.failed) {
+        try {
+            size_t from = job.bounds[index];
+            size_t size = job.bounds[index + 1] - from;
+            vector<char> out(size);
+            size_t phase = job.letters[index];
+            size_t written = gronsfeld->transformInto(job.data + from, size, out.data(), phase, options.decrypting);
+            writeAll(job.outFd, out.data(), written, job.offsets[index]);
+            job.outSize += written;
+        } catch (const exception& e) {
+            job.fail(e.what());
+        }
+    }
+    releaseTask(job);
+}
+
+/**
+ * @brief Перестановка группы кадров
+ * @details Группа кадров шифруется как самостоятельный кадровый текст:
+ *          у всех групп, кроме последней, кадры полные, концевик нулевой
+ *          и отбрасывается, так что склейка групп совпадает с
+ *          EncryptFramed для всего файла. При дешифровании к таким
+ *          группам нулевой концевик дописывается обратно.
+ */
+void BatchProcessor::transformSegment(FileJob& job, size_t index)
+{
+    if (!job.failed) {
+        try {
+            bool last = index + 1 == job.parts.size();
+            size_t from = index * job.segmentCells;
+            wstring segment = last ? job.cells.substr(from) : job.cells.substr(from, job.segmentCells);
+            RouteCipher cipher(route);
+            wstring result;
+            if (options.decrypting) {
+                if (!last) {
+                    segment += zeroTrailer;
+                }
+                result = cipher.DecryptFramed(segment, options.frameRows);
+            } else {
+                result = cipher.EncryptFramed(segment, options.frameRows);
+                if (!last) {
+                    result.resize(result.size() - RouteCipher::FrameTrailer);
+                }
+            }
+            job.parts[index] = wideToUtf8(result);
+        } catch (const exception& e) {
+            job.fail(e.what());
+        }
+    }
+    releaseTask(job);
+}
+
+/**
+ * @brief Завершение задачи файла
+ */
+void BatchProcessor::releaseTask(FileJob& job)
+{
+    if (--job.remaining == 0) {
+        finishFile(job);
+    }
+}
+
+/**
+ * @brief Запись на диск, переименование временного файла и учёт итогов
+ * @details Выходной файл появляется только целиком: при любой ошибке
+ *          временный файл удаляется деструктором FileJob
+ */
+void BatchProcessor::finishFile(FileJob& job)
+{
+    if (!job.failed) {
+        try {
+            uint64_t offset = 0;
+            for (string& part : job.parts) {
+                writeAll(job.outFd, part.data(), part.size(), offset);
+                offset += part.size();
+                string().swap(part);
+            }
+            job.outSize += offset;
+            if (options.sync && fsync(job.outFd) != 0) {
+                throw batch_error(systemMessage("Sync failed", errno));
+            }
+            int fd = job.outFd;
+            job.outFd = -1;
+            if (close(fd) != 0) {
+                throw batch_error(systemMessage("Close failed", errno));
+            }
+            if (rename(job.tempPath.c_str(), job.outPath.c_str()) != 0) {
+                throw batch_error(systemMessage("Cannot rename to " + job.outPath, errno));
+            }
+            job.tempPath.clear();
+        } catch (const exception& e) {
+            job.fail(e.what());
+        }
+    }
+    wstring().swap(job.cells);
+
+    lock_guard<mutex> guard(job.progress->lock);
+    BatchReport& report = job.progress->report;
+    ++report.files;
+    report.bytesIn += job.size;
+    if (job.failed) {
+        ++report.failedFiles;
+        report.errors.push_back(job.inPath + ": " + job.error);
+    } else {
+        report.bytesOut += job.outSize;
+    }
+}
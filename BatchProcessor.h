@@ -0,0 +1,172 @@
+/**
+ * @file BatchProcessor.h
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Пакетное шифрование дерева каталогов на пуле потоков с кражей задач
+ * @copyright ИБСТ ПГУ
+ * @details Файлы обходятся рекурсивно и раздаются потокам от больших к
+ *          малым. Большой файл дробится на задачи: для шифра Гронсфельда -
+ *          куски с заранее вычисленной фазой ключа, для перестановки -
+ *          группы кадров кадрового режима RouteCipher. У каждого потока
+ *          своя очередь: владелец берёт задачи с конца, а простаивающий
+ *          поток крадёт их с начала чужой очереди, так что ядра не
+ *          простаивают на последних больших файлах. Результат пишется во
+ *          временный файл рядом с выходным и переименовывается в выходной
+ *          только после успешной записи.
+ */
+
+#ifndef BATCHPROCESSOR_H
+#define BATCHPROCESSOR_H
+
+#include "modAlphaCipher.h"
+#include "2/RouteCipher.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Класс исключений для ошибок пакетной обработки
+ * @details Наследуется от std::runtime_error
+ */
+class batch_error : public std::runtime_error {
+public:
+    /**
+     * @brief Конструктор с строкой
+     * @param what_arg Сообщение об ошибке
+     */
+    explicit batch_error(const std::string& what_arg) : std::runtime_error(what_arg) {}
+
+    /**
+     * @brief Конструктор с C-строкой
+     * @param what_arg Сообщение об ошибке
+     */
+    explicit batch_error(const char* what_arg) : std::runtime_error(what_arg) {}
+};
+
+/**
+ * @brief Параметры пакетной обработки
+ */
+struct BatchOptions {
+    unsigned threads = 0; ///< Количество потоков (0 - по числу ядер)
+    size_t chunkSize = 4 << 20; ///< Примерный размер задачи в байтах входного файла
+    size_t frameRows = 1024; ///< Строк в кадре кадрового режима перестановки
+    bool decrypting = false; ///< Дешифровать вместо шифрования
+    bool sync = true; ///< Сбрасывать выходной файл на диск (fsync) перед переименованием
+};
+
+/**
+ * @brief Итоги пакетной обработки
+ */
+struct BatchReport {
+    size_t files = 0; ///< Обработано файлов
+    size_t failedFiles = 0; ///< Файлов с ошибкой (выходной файл не создан)
+    uint64_t bytesIn = 0; ///< Прочитано байт
+    uint64_t bytesOut = 0; ///< Записано байт
+    uint64_t tasks = 0; ///< Выполнено задач
+    uint64_t steals = 0; ///< Задач, украденных из чужих очередей
+    unsigned threads = 0; ///< Использовано потоков
+    double seconds = 0; ///< Время обработки
+    std::vector<std::string> errors; ///< Сообщения об ошибках по файлам
+
+    /**
+     * @brief Пропускная способность по входным данным
+     * @return МиБ/с
+     */
+    double throughput() const { return seconds > 0 ? bytesIn / seconds / (1 << 20) : 0; }
+};
+
+/**
+ * @brief Пакетный шифратор каталогов
+ * @details Ошибка в одном файле не останавливает обработку остальных:
+ *          она попадает в BatchReport::errors, временный файл удаляется.
+ *          Пустые файлы переносятся пустыми для обоих шифров.
+ */
+class BatchProcessor
+{
+private:
+    /**
+     * @brief Шифр, которым обрабатываются файлы
+     */
+    enum class Engine {
+        Gronsfeld, ///< modAlphaCipher, куски с фазой ключа
+        Route      ///< RouteCipher в кадровом режиме
+    };
+
+    Engine engine; ///< Выбранный шифр
+    const modAlphaCipher* gronsfeld = nullptr; ///< Шифр Гронсфельда
+    RouteCipher route; ///< Образец шифра перестановки; задачи работают с копиями
+    BatchOptions options; ///< Параметры
+
+    struct FileJob;
+    struct Progress;
+    class TaskPool;
+
+    /**
+     * @brief Открытие файла и разбиение его на задачи
+     * @param [in] pool Пул задач
+     * @param [in] worker Поток, выполняющий задачу
+     * @param [in] job Файл
+     */
+    void startFile(TaskPool& pool, unsigned worker, const std::shared_ptr<FileJob>& job);
+
+    /**
+     * @brief Подсчёт букв куска для вычисления фаз ключа
+     * @details Последняя из задач подсчёта ставит в очередь задачи шифрования
+     */
+    void countChunk(TaskPool& pool, unsigned worker, const std::shared_ptr<FileJob>& job, size_t index);
+
+    /**
+     * @brief Шифрование куска шифром Гронсфельда и запись по его смещению
+     */
+    void transformChunk(FileJob& job, size_t index);
+
+    /**
+     * @brief Перестановка группы кадров
+     */
+    void transformSegment(FileJob& job, size_t index);
+
+    /**
+     * @brief Завершение задачи файла; последняя задача завершает файл
+     */
+    void releaseTask(FileJob& job);
+
+    /**
+     * @brief Запись на диск, переименование временного файла и учёт итогов
+     */
+    void finishFile(FileJob& job);
+
+public:
+    /**
+     * @brief Конструктор для шифра Гронсфельда
+     * @param [in] cipher Шифр, который должен жить дольше обработчика
+     * @param [in] batchOptions Параметры
+     * @throw batch_error если размер задачи равен 0
+     */
+    BatchProcessor(const modAlphaCipher& cipher, const BatchOptions& batchOptions = BatchOptions());
+
+    /**
+     * @brief Конструктор для шифра перестановки
+     * @param [in] cipher Шифр (копируется)
+     * @param [in] batchOptions Параметры
+     * @throw batch_error если размер задачи или количество строк кадра равны 0
+     * @details Файлы шифруются в кадровом режиме (RouteCipher::EncryptFramed)
+     *          с FrameRows = batchOptions.frameRows; результат совпадает с
+     *          EncryptFramed для всего файла
+     */
+    BatchProcessor(const RouteCipher& cipher, const BatchOptions& batchOptions = BatchOptions());
+
+    /**
+     * @brief Обработка дерева каталогов
+     * @param [in] inputDir Входной каталог
+     * @param [in] outputDir Выходной каталог; структура подкаталогов повторяется
+     * @return Итоги обработки
+     * @throw batch_error если входной каталог не читается
+     */
+    BatchReport run(const std::string& inputDir, const std::string& outputDir);
+};
+
+#endif // BATCHPROCESSOR_H
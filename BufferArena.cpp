@@ -0,0 +1,183 @@
+/**
+ * @file BufferArena.cpp
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Реализация арены выровненных буферов
+ * @copyright ИБСТ ПГУ
+ */
+
+#include "BufferArena.h"
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+using namespace std;
+
+namespace {
+
+const size_t hugePageSize = 2 << 20; ///< Размер огромной страницы x86-64
+
+/**
+ * @brief Округление вверх до кратного
+ */
+size_t roundUp(size_t value, size_t step)
+{
+    return (value + step - 1) / step * step;
+}
+
+} // namespace
+
+/**
+ * @brief Конструктор
+ * @param [in] arenaOptions Параметры арены
+ */
+BufferArena::BufferArena(const ArenaOptions& arenaOptions) : options(arenaOptions)
+{
+}
+
+/**
+ * @brief Освобождение всех областей
+ */
+BufferArena::~BufferArena()
+{
+    release();
+}
+
+/**
+ * @brief Ошибки страниц текущего потока с его запуска
+ */
+PageFaults BufferArena::currentFaults()
+{
+    PageFaults faults;
+    rusage usage;
+    if (getrusage(RUSAGE_THREAD, &usage) == 0) {
+        faults.minor = usage.ru_minflt;
+        faults.major = usage.ru_majflt;
+    }
+    return faults;
+}
+
+/**
+ * @brief Создание новой области не меньше size байт
+ * @details Сначала пробуется MAP_HUGETLB (если разрешено), затем обычное
+ *          отображение с просьбой о прозрачных огромных страницах. Область
+ *          выравнивается на 2 МиБ, чтобы ядро могло отдать её огромными
+ *          страницами целиком.
+ * @throw arena_error если mmap не удался
+ */
+void BufferArena::reserve(size_t size)
+{
+    size = roundUp(max(size, options.regionSize), hugePageSize);
+    int populate = options.prefault ? MAP_POPULATE : 0;
+    PageFaults before = currentFaults();
+
+    Region region{nullptr, size, false};
+#ifdef MAP_HUGETLB
+    if (options.hugeTlb) {
+        void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | populate, -1, 0);
+        if (p != MAP_FAILED) {
+            region.base = static_cast<char*>(p);
+            region.hugeTlb = true;
+        }
+    }
+#endif
+
+    if (region.base == nullptr) {
+        // Лишние 2 МиБ позволяют выровнять начало области
+        size_t mapped = size + hugePageSize;
+        void* p = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            throw arena_error(string("Arena mmap failed: ") + strerror(errno));
+        }
+        char* raw = static_cast<char*>(p);
+        char* aligned = reinterpret_cast<char*>(roundUp(reinterpret_cast<size_t>(raw), hugePageSize));
+        if (aligned > raw) {
+            munmap(raw, static_cast<size_t>(aligned - raw));
+        }
+        size_t tail = static_cast<size_t>(raw + mapped - (aligned + size));
+        if (tail > 0) {
+            munmap(aligned + size, tail);
+        }
+        region.base = aligned;
+
+#ifdef MADV_HUGEPAGE
+        if (options.transparentHuge) {
+            madvise(region.base, size, MADV_HUGEPAGE);
+        }
+#endif
+        if (options.prefault) {
+#ifdef MADV_POPULATE_WRITE
+            if (madvise(region.base, size, MADV_POPULATE_WRITE) != 0)
+#endif
+            {
+                for (size_t i = 0; i < size; i += 4096) {
+                    region.base[i] = 0;
+                }
+            }
+        }
+    }
+
+    PageFaults after = currentFaults();
+    statistics.reserveFaults.minor += after.minor - before.minor;
+    statistics.reserveFaults.major += after.major - before.major;
+    statistics.regions++;
+    statistics.hugeTlbRegions += region.hugeTlb ? 1 : 0;
+    statistics.reservedBytes += size;
+    regions.push_back(region);
+}
+
+/**
+ * @brief Выделение блока
+ * @param [in] bytes Размер блока
+ * @return Указатель, выровненный на alignment
+ */
+void* BufferArena::allocate(size_t bytes)
+{
+    bytes = roundUp(max<size_t>(bytes, 1), alignment);
+    while (current < regions.size() && offset + bytes > regions[current].size) {
+        ++current;
+        offset = 0;
+    }
+    if (current == regions.size()) {
+        reserve(bytes);
+        offset = 0;
+    }
+
+    void* block = regions[current].base + offset;
+    offset += bytes;
+    statistics.usedBytes += bytes;
+    statistics.peakBytes = max(statistics.peakBytes, statistics.usedBytes);
+    return block;
+}
+
+/**
+ * @brief Освобождение всех блоков без возврата памяти ядру
+ */
+void BufferArena::reset()
+{
+    current = 0;
+    offset = 0;
+    statistics.usedBytes = 0;
+    statistics.resets++;
+}
+
+/**
+ * @brief Возврат всей памяти ядру
+ */
+void BufferArena::release()
+{
+    for (const Region& region : regions) {
+        munmap(region.base, region.size);
+    }
+    regions.clear();
+    current = 0;
+    offset = 0;
+    statistics.regions = 0;
+    statistics.hugeTlbRegions = 0;
+    statistics.reservedBytes = 0;
+    statistics.usedBytes = 0;
+}
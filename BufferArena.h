@@ -0,0 +1,163 @@
+/**
+ * @file BufferArena.h
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Арена выровненных буферов для пакетной обработки больших текстов
+ * @copyright ИБСТ ПГУ
+ * @details Память берётся у ядра большими областями через mmap, по
+ *          возможности на огромных страницах (MAP_HUGETLB или прозрачные
+ *          огромные страницы через madvise), и раздаётся блоками,
+ *          выровненными на 64 байта. reset() не возвращает память ядру,
+ *          поэтому повторные вызовы шифров работают с уже отображёнными
+ *          страницами: без ошибок страниц и с меньшим числом промахов TLB.
+ */
+
+#ifndef BUFFERARENA_H
+#define BUFFERARENA_H
+
+#include <vector>
+#include <stdexcept>
+#include <string>
+#include <cstddef>
+
+/**
+ * @brief Класс исключений для ошибок выделения памяти арены
+ * @details Наследуется от std::runtime_error
+ */
+class arena_error : public std::runtime_error {
+public:
+    /**
+     * @brief Конструктор с строкой
+     * @param what_arg Сообщение об ошибке
+     */
+    explicit arena_error(const std::string& what_arg) : std::runtime_error(what_arg) {}
+
+    /**
+     * @brief Конструктор с C-строкой
+     * @param what_arg Сообщение об ошибке
+     */
+    explicit arena_error(const char* what_arg) : std::runtime_error(what_arg) {}
+};
+
+/**
+ * @brief Параметры арены
+ */
+struct ArenaOptions {
+    size_t regionSize = 16 << 20; ///< Размер области по умолчанию (округляется до 2 МиБ)
+    bool hugeTlb = false; ///< Пробовать MAP_HUGETLB (нужны заранее выделенные огромные страницы)
+    bool transparentHuge = true; ///< Запрашивать прозрачные огромные страницы через madvise
+    bool prefault = true; ///< Отображать страницы сразу (MAP_POPULATE), а не при первом обращении
+};
+
+/**
+ * @brief Счётчики ошибок страниц
+ */
+struct PageFaults {
+    long minor = 0; ///< Ошибки страниц без чтения с диска
+    long major = 0; ///< Ошибки страниц с чтением с диска
+};
+
+/**
+ * @brief Статистика арены
+ */
+struct ArenaStats {
+    size_t regions = 0; ///< Количество областей
+    size_t hugeTlbRegions = 0; ///< Из них на страницах MAP_HUGETLB
+    size_t reservedBytes = 0; ///< Всего отображено байт
+    size_t usedBytes = 0; ///< Выдано байт с последнего reset
+    size_t peakBytes = 0; ///< Наибольшее usedBytes
+    size_t resets = 0; ///< Количество вызовов reset
+    PageFaults reserveFaults; ///< Ошибки страниц при создании областей
+};
+
+/**
+ * @brief Арена выровненных буферов
+ * @details Блоки живут до reset() или уничтожения арены. Арена не
+ *          потокобезопасна: каждый поток использует свою.
+ */
+class BufferArena
+{
+private:
+    /**
+     * @brief Отображённая область
+     */
+    struct Region {
+        char* base; ///< Начало области
+        size_t size; ///< Размер области
+        bool hugeTlb; ///< Область на страницах MAP_HUGETLB
+    };
+
+    ArenaOptions options; ///< Параметры
+    std::vector<Region> regions; ///< Области в порядке создания
+    size_t current = 0; ///< Текущая область
+    size_t offset = 0; ///< Занято байт в текущей области
+    ArenaStats statistics; ///< Статистика
+
+    /**
+     * @brief Создание новой области не меньше size байт
+     * @throw arena_error если mmap не удался
+     */
+    void reserve(size_t size);
+
+public:
+    static const size_t alignment = 64; ///< Выравнивание блоков (строка кэша)
+
+    /**
+     * @brief Конструктор
+     * @param [in] arenaOptions Параметры арены
+     * @details Память не отображается до первого allocate
+     */
+    explicit BufferArena(const ArenaOptions& arenaOptions = ArenaOptions());
+
+    /**
+     * @brief Освобождение всех областей
+     */
+    ~BufferArena();
+
+    BufferArena(const BufferArena&) = delete; ///< Копирование запрещено
+    BufferArena& operator=(const BufferArena&) = delete; ///< Присваивание запрещено
+
+    /**
+     * @brief Выделение блока
+     * @param [in] bytes Размер блока
+     * @return Указатель, выровненный на alignment
+     * @throw arena_error если не удалось отобразить новую область
+     */
+    void* allocate(size_t bytes);
+
+    /**
+     * @brief Выделение массива
+     * @tparam T Тривиальный тип элемента
+     * @param [in] count Количество элементов
+     * @return Указатель на неинициализированный массив
+     * @throw arena_error если не удалось отобразить новую область
+     */
+    template <typename T>
+    T* allocateArray(size_t count) { return static_cast<T*>(allocate(count * sizeof(T))); }
+
+    /**
+     * @brief Освобождение всех блоков без возврата памяти ядру
+     * @details Ранее выданные указатели становятся недействительными
+     */
+    void reset();
+
+    /**
+     * @brief Возврат всей памяти ядру
+     */
+    void release();
+
+    /**
+     * @brief Статистика арены
+     */
+    const ArenaStats& stats() const { return statistics; }
+
+    /**
+     * @brief Ошибки страниц текущего потока с его запуска
+     * @details Разность двух значений показывает число ошибок страниц за
+     *          интервал, например за вызов шифра
+     */
+    static PageFaults currentFaults();
+};
+
+#endif // BUFFERARENA_H
@@ -0,0 +1,188 @@
+/**
+ * @file CascadeCipher.cpp
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Реализация составного шифра
+ * @copyright ИБСТ ПГУ
+ */
+
+#include "CascadeCipher.h"
+#include "2/RouteCipher.h"
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Конструктор составного шифра
+ * @param [in] skey Ключ шифра Гронсфельда
+ * @param [in] columns Количество столбцов таблицы перестановки
+ * @details Количество столбцов проверяется конструктором RouteCipher,
+ *          чтобы ограничения обоих вариантов совпадали
+ */
+CascadeCipher::CascadeCipher(const string& skey, int columns)
+    : substitution(skey), columns(RouteCipher(columns).GetColumns())
+{
+}
+
+/**
+ * @brief Декодирование букв текста в индексы алфавита
+ * @param [in] text Текст в UTF-8
+ * @param [in] cipherSide true для шифротекста
+ * @return Индексы букв, для 'X' - значение padCell
+ * @throw cipher_error если текст содержит недопустимые символы
+ * @details Для открытого текста пропускаются только пробелы, как в
+ *          modAlphaCipher::encrypt. Для шифротекста повторяется подготовка
+ *          RouteCipher::Decrypt: пропускаются пробелы, табуляции и переводы
+ *          строк, строчные буквы приводятся к заглавным.
+ */
+vector<unsigned char> CascadeCipher::decodeCells(const string& text, bool cipherSide) const
+{
+    vector<unsigned char> cells;
+    cells.reserve(text.size() / 2);
+    size_t i = 0;
+    while (i < text.size()) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c == ' ' || (cipherSide && (c == '\t' || c == '\n' || c == '\r'))) {
+            ++i;
+            continue;
+        }
+        if (cipherSide && (c == 'X' || c == 'x')) {
+            cells.push_back(static_cast<unsigned char>(padCell));
+            ++i;
+            continue;
+        }
+        if (i + 1 >= text.size()) {
+            throw cipher_error("Invalid character sequence in input");
+        }
+        unsigned char lead = c;
+        unsigned char trail = static_cast<unsigned char>(text[i + 1]);
+        if (cipherSide) {
+            // а-п, р-я и ё приводятся к А-П, Р-Я и Ё
+            if (lead == 0xD0 && trail >= 0xB0 && trail <= 0xBF) {
+                trail -= 0x20;
+            } else if (lead == 0xD1 && trail >= 0x80 && trail <= 0x8F) {
+                lead = 0xD0;
+                trail += 0x20;
+            } else if (lead == 0xD1 && trail == 0x91) {
+                lead = 0xD0;
+                trail = 0x81;
+            }
+        }
+        int idx = substitution.decodeLetter(lead, trail);
+        if (idx < 0) {
+            throw cipher_error("Invalid character in input (not a Russian uppercase letter)");
+        }
+        cells.push_back(static_cast<unsigned char>(idx));
+        i += 2;
+    }
+    return cells;
+}
+
+/**
+ * @brief Шифрование открытого текста
+ * @param [in] open_text Открытый текст
+ * @return Зашифрованный текст
+ * @throw cipher_error если текст пуст или содержит недопустимые символы
+ * @details Буква с номером k попадает в строку k / columns и столбец
+ *          k % columns. Таблица читается по столбцам справа налево, поэтому
+ *          смещение столбца в результате известно заранее: правые столбцы,
+ *          которые заканчиваются заполнителем 'X' (1 байт), идут первыми,
+ *          за ними полные столбцы из букв по 2 байта.
+ */
+string CascadeCipher::encrypt(const string& open_text) const
+{
+    vector<unsigned char> cells = decodeCells(open_text, false);
+    if (cells.empty()) {
+        throw cipher_error("Empty open text");
+    }
+
+    const vector<int>& key = substitution.key;
+    const string& alphabet = substitution.numAlpha;
+    int alphabetSize = static_cast<int>(alphabet.size() / 2);
+    size_t length = cells.size();
+    size_t cols = static_cast<size_t>(columns);
+    size_t rows = (length + cols - 1) / cols;
+    size_t full = length % cols == 0 ? cols : length % cols; // столбцы без заполнителя
+
+    string result(length * 2 + (rows * cols - length), 'X');
+    size_t pos = 0;
+    for (size_t j = cols; j-- > 0;) {
+        size_t letters = j < full ? rows : rows - 1;
+        size_t k = j;
+        size_t phase = j % key.size();
+        size_t step = cols % key.size();
+        for (size_t i = 0; i < letters; ++i, k += cols) {
+            int idx = cells[k] + key[phase];
+            if (idx >= alphabetSize) {
+                idx -= alphabetSize;
+            }
+            result[pos++] = alphabet[idx * 2];
+            result[pos++] = alphabet[idx * 2 + 1];
+            phase += step;
+            if (phase >= key.size()) {
+                phase -= key.size();
+            }
+        }
+        if (letters < rows) {
+            ++pos; // 'X' уже на месте
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Дешифрование шифротекста
+ * @param [in] cipher_text Зашифрованный текст
+ * @return Расшифрованный текст
+ * @throw cipher_error если текст пуст или содержит недопустимые символы
+ * @details Ячейка открытого текста в строке i и столбце j берётся из
+ *          позиции (columns - 1 - j) * rows + i шифротекста. Ячейки за концом
+ *          шифротекста и заполнители в конце отбрасываются, как в
+ *          RouteCipher::Decrypt; заполнитель внутри текста - ошибка.
+ */
+string CascadeCipher::decrypt(const string& cipher_text) const
+{
+    vector<unsigned char> cells = decodeCells(cipher_text, true);
+    if (cells.empty()) {
+        throw cipher_error("Empty cipher text");
+    }
+
+    size_t length = cells.size();
+    size_t cols = static_cast<size_t>(columns);
+    size_t rows = (length + cols - 1) / cols;
+    auto source = [&](size_t k) -> unsigned char {
+        size_t p = (cols - 1 - k % cols) * rows + k / cols;
+        return p < length ? cells[p] : padCell;
+    };
+
+    size_t plainLength = rows * cols;
+    while (plainLength > 0 && source(plainLength - 1) == padCell) {
+        --plainLength;
+    }
+    if (plainLength == 0) {
+        throw cipher_error("Empty cipher text");
+    }
+
+    const vector<int>& key = substitution.key;
+    const string& alphabet = substitution.numAlpha;
+    int alphabetSize = static_cast<int>(alphabet.size() / 2);
+    string result(plainLength * 2, '\0');
+    size_t phase = 0;
+    for (size_t k = 0; k < plainLength; ++k) {
+        unsigned char cell = source(k);
+        if (cell == padCell) {
+            throw cipher_error("Invalid character in input (not a Russian uppercase letter)");
+        }
+        int idx = cell + alphabetSize - key[phase];
+        if (idx >= alphabetSize) {
+            idx -= alphabetSize;
+        }
+        result[k * 2] = alphabet[idx * 2];
+        result[k * 2 + 1] = alphabet[idx * 2 + 1];
+        if (++phase == key.size()) {
+            phase = 0;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,77 @@
+/**
+ * @file CascadeCipher.h
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Составной шифр: Гронсфельд, затем маршрутная перестановка
+ * @copyright ИБСТ ПГУ
+ */
+
+#ifndef CASCADECIPHER_H
+#define CASCADECIPHER_H
+
+#include "modAlphaCipher.h"
+#include <string>
+#include <vector>
+
+/**
+ * @brief Составной шифр за один проход
+ * @details Результат совпадает с последовательным применением
+ *          modAlphaCipher::encrypt и RouteCipher::Encrypt (с переводом
+ *          UTF-8 в std::wstring и обратно), но каждая буква декодируется
+ *          один раз, сразу сдвигается и записывается в свою позицию
+ *          после перестановки. Промежуточные строки и преобразования
+ *          в широкие символы не создаются.
+ *
+ * Пустые ячейки последней строки таблицы, как и в RouteCipher,
+ * заполняются символом 'X'. Так как 'X' не входит в русский алфавит,
+ * при дешифровании он отбрасывается однозначно.
+ */
+class CascadeCipher
+{
+private:
+    modAlphaCipher substitution; ///< Шифр Гронсфельда (ключ и таблицы алфавита)
+    int columns; ///< Количество столбцов таблицы перестановки
+
+    /**
+     * @brief Декодирование букв текста в индексы алфавита
+     * @param [in] text Текст в UTF-8
+     * @param [in] cipherSide true для шифротекста (допускаются 'X',
+     *             пробельные символы и строчные буквы, как в RouteCipher)
+     * @return Индексы букв, для 'X' - значение padCell
+     * @throw cipher_error если текст содержит недопустимые символы
+     */
+    std::vector<unsigned char> decodeCells(const std::string& text, bool cipherSide) const;
+
+public:
+    static constexpr unsigned char padCell = 0xFF; ///< Ячейка-заполнитель 'X'
+
+    CascadeCipher() = delete; ///< Конструктор по умолчанию запрещен
+
+    /**
+     * @brief Конструктор составного шифра
+     * @param [in] skey Ключ шифра Гронсфельда
+     * @param [in] columns Количество столбцов таблицы перестановки
+     * @throw cipher_error если ключ Гронсфельда некорректен
+     * @throw CipherError если количество столбцов некорректно
+     */
+    CascadeCipher(const std::string& skey, int columns);
+
+    /**
+     * @brief Шифрование открытого текста
+     * @param [in] open_text Открытый текст (русские заглавные буквы и пробелы)
+     * @return Зашифрованный текст
+     * @throw cipher_error если текст пуст или содержит недопустимые символы
+     */
+    std::string encrypt(const std::string& open_text) const;
+
+    /**
+     * @brief Дешифрование шифротекста
+     * @param [in] cipher_text Зашифрованный текст
+     * @return Расшифрованный текст
+     * @throw cipher_error если текст пуст или содержит недопустимые символы
+     */
+    std::string decrypt(const std::string& cipher_text) const;
+};
+
+#endif // CASCADECIPHER_H
@@ -0,0 +1,406 @@
+/**
+ * @file CipherContainer.cpp
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Реализация контейнера шифротекста
+ * @copyright ИБСТ ПГУ
+ */
+
+#include "CipherContainer.h"
+#include "Utf8.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+
+using namespace std;
+
+namespace {
+
+const char headerMagic[4] = {'L', 'B', '4', 'C'};
+const char footerMagic[4] = {'L', 'B', '4', 'I'};
+const uint16_t formatVersion = 1;
+const size_t headerSize = 32;
+const size_t indexEntrySize = 24;
+const size_t footerSize = 16;
+
+void putLE(string& buf, uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i) {
+        buf += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+/**
+ * @brief Чтение числа little-endian
+ * @throw container_error если число выходит за конец буфера
+ */
+uint64_t getLE(const string& buf, size_t pos, int bytes)
+{
+    if (pos > buf.size() || static_cast<size_t>(bytes) > buf.size() - pos) {
+        throw container_error("Truncated container");
+    }
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value |= static_cast<uint64_t>(static_cast<unsigned char>(buf[pos + i])) << (8 * i);
+    }
+    return value;
+}
+
+/**
+ * @brief Отпечаток ключа шифра перестановки
+ */
+uint64_t routeFingerprint(const RouteCipher& cipher)
+{
+    uint64_t hash = 14695981039346656037ull;
+    uint64_t columns = static_cast<uint64_t>(cipher.GetColumns());
+    for (int i = 0; i < 8; ++i) {
+        hash ^= (columns >> (8 * i)) & 0xFF;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/**
+ * @brief Сборка контейнера из зашифрованных блоков
+ */
+string assemble(ContainerCipher type, uint64_t fingerprint, uint64_t totalLength, uint32_t chunkLength,
+                const vector<string>& bodies, const vector<ContainerChunk>& entries)
+{
+    string out;
+    out.append(headerMagic, 4);
+    putLE(out, formatVersion, 2);
+    putLE(out, static_cast<uint8_t>(type), 1);
+    putLE(out, static_cast<uint8_t>(TextMode::Strict), 1);
+    putLE(out, fingerprint, 8);
+    putLE(out, totalLength, 8);
+    putLE(out, chunkLength, 4);
+    putLE(out, entries.size(), 4);
+
+    for (const string& body : bodies) {
+        out += body;
+    }
+    uint64_t indexOffset = out.size();
+    for (const ContainerChunk& entry : entries) {
+        putLE(out, entry.offset, 8);
+        putLE(out, entry.size, 4);
+        putLE(out, entry.length, 4);
+        putLE(out, entry.phase, 4);
+        putLE(out, 0, 4);
+    }
+    putLE(out, indexOffset, 8);
+    out.append(footerMagic, 4);
+    putLE(out, 0, 4);
+    return out;
+}
+
+} // namespace
+
+/**
+ * @brief Чтение контейнера
+ * @param [in] bytes Байты контейнера
+ * @throw container_error если формат нарушен
+ */
+CipherContainer::CipherContainer(string bytes) : data(move(bytes))
+{
+    parse();
+}
+
+/**
+ * @brief Разбор заголовка и индекса
+ * @details Проверяется, что все блоки лежат между заголовком и индексом,
+ *          а длины блоков в сумме дают длину открытого текста. Количество
+ *          блоков ограничивается размером данных до вычисления смещений,
+ *          чтобы поддельные значения не переполняли арифметику.
+ */
+void CipherContainer::parse()
+{
+    if (data.size() < headerSize + footerSize || data.compare(0, 4, headerMagic, 4) != 0 ||
+        data.compare(data.size() - 8, 4, footerMagic, 4) != 0) {
+        throw container_error("Not a cipher container");
+    }
+    if (getLE(data, 4, 2) != formatVersion) {
+        throw container_error("Unsupported container version");
+    }
+    uint64_t rawType = getLE(data, 6, 1);
+    if (rawType != static_cast<uint8_t>(ContainerCipher::Gronsfeld) &&
+        rawType != static_cast<uint8_t>(ContainerCipher::Route)) {
+        throw container_error("Unknown cipher type in container");
+    }
+    type = static_cast<ContainerCipher>(rawType);
+    if (getLE(data, 7, 1) != static_cast<uint8_t>(TextMode::Strict)) {
+        throw container_error("Unsupported text mode in container");
+    }
+    fingerprint = getLE(data, 8, 8);
+    totalLength = getLE(data, 16, 8);
+    chunkLength = static_cast<uint32_t>(getLE(data, 24, 4));
+    uint64_t count = getLE(data, 28, 4);
+
+    uint64_t indexOffset = getLE(data, data.size() - footerSize, 8);
+    if (chunkLength == 0 || count > (data.size() - headerSize - footerSize) / indexEntrySize ||
+        indexOffset != data.size() - footerSize - count * indexEntrySize) {
+        throw container_error("Corrupted container index");
+    }
+
+    chunks.resize(static_cast<size_t>(count));
+    uint64_t expectedOffset = headerSize;
+    uint64_t sumLength = 0;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        size_t pos = static_cast<size_t>(indexOffset + i * indexEntrySize);
+        ContainerChunk& chunk = chunks[i];
+        chunk.offset = getLE(data, pos, 8);
+        chunk.size = static_cast<uint32_t>(getLE(data, pos + 8, 4));
+        chunk.length = static_cast<uint32_t>(getLE(data, pos + 12, 4));
+        chunk.phase = static_cast<uint32_t>(getLE(data, pos + 16, 4));
+        bool last = i + 1 == chunks.size();
+        if (chunk.offset != expectedOffset || chunk.size > indexOffset - expectedOffset ||
+            chunk.length == 0 || chunk.length > chunkLength || (!last && chunk.length != chunkLength)) {
+            throw container_error("Corrupted container index");
+        }
+        expectedOffset += chunk.size;
+        sumLength += chunk.length;
+    }
+    if (expectedOffset != indexOffset || sumLength != totalLength) {
+        throw container_error("Corrupted container index");
+    }
+}
+
+/**
+ * @brief Проверка типа шифра и отпечатка ключа
+ */
+void CipherContainer::checkKey(ContainerCipher expected, uint64_t keyPrint) const
+{
+    if (type != expected) {
+        throw container_error("Container was created by a different cipher");
+    }
+    if (fingerprint != keyPrint) {
+        throw container_error("Key fingerprint mismatch");
+    }
+}
+
+/**
+ * @brief Байты шифротекста блока
+ */
+string CipherContainer::chunkBytes(size_t index) const
+{
+    return data.substr(static_cast<size_t>(chunks[index].offset), chunks[index].size);
+}
+
+/**
+ * @brief Создание контейнера шифром Гронсфельда
+ * @details Текст режется по числу букв, пробелы между блоками
+ *          отбрасываются. Фаза ключа для каждого блока - та, с которой
+ *          шифровалась его первая буква.
+ */
+string CipherContainer::create(const modAlphaCipher& cipher, const string& open_text, uint32_t chunkLength)
+{
+    if (chunkLength == 0) {
+        throw container_error("Chunk length must be positive");
+    }
+    if (cipher.textMode() != TextMode::Strict) {
+        throw container_error("Containers support only Strict text mode");
+    }
+    vector<string> bodies;
+    vector<ContainerChunk> entries;
+    uint64_t offset = headerSize;
+    uint64_t totalLength = 0;
+    size_t phase = 0;
+    size_t pos = 0;
+    while (pos < open_text.size()) {
+        size_t begin = pos;
+        uint32_t letters = 0;
+        while (pos < open_text.size() && letters < chunkLength) {
+            if (open_text[pos] == ' ') {
+                ++pos;
+                continue;
+            }
+            pos += 2;
+            ++letters;
+        }
+        pos = min(pos, open_text.size());
+        if (letters == 0) {
+            break;
+        }
+
+        ContainerChunk entry;
+        entry.phase = static_cast<uint32_t>(phase);
+        bodies.push_back(cipher.encryptChunk(open_text.substr(begin, pos - begin), phase));
+        entry.offset = offset;
+        entry.size = static_cast<uint32_t>(bodies.back().size());
+        entry.length = static_cast<uint32_t>(bodies.back().size() / 2);
+        entries.push_back(entry);
+        offset += entry.size;
+        totalLength += entry.length;
+    }
+    if (totalLength == 0) {
+        throw cipher_error("Empty open text");
+    }
+    return assemble(ContainerCipher::Gronsfeld, cipher.keyFingerprint(), totalLength, chunkLength, bodies, entries);
+}
+
+/**
+ * @brief Создание контейнера шифром маршрутной перестановки
+ * @details Текст подготавливается целиком, затем каждый блок из
+ *          chunkLength символов шифруется как отдельное сообщение
+ */
+string CipherContainer::create(RouteCipher& cipher, const string& open_text, uint32_t chunkLength)
+{
+    if (chunkLength == 0) {
+        throw container_error("Chunk length must be positive");
+    }
+    wstring wide;
+    if (!utf8ToWide(open_text, wide)) {
+        throw CipherError("Некорректная последовательность UTF-8");
+    }
+    if (wide.empty()) {
+        throw CipherError("Текст не может быть пустым");
+    }
+    wstring prepared = cipher.PrepareText(wide);
+
+    vector<string> bodies;
+    vector<ContainerChunk> entries;
+    uint64_t offset = headerSize;
+    for (size_t pos = 0; pos < prepared.size(); pos += chunkLength) {
+        wstring part = prepared.substr(pos, chunkLength);
+        bodies.push_back(wideToUtf8(cipher.Encrypt(part)));
+        ContainerChunk entry;
+        entry.offset = offset;
+        entry.size = static_cast<uint32_t>(bodies.back().size());
+        entry.length = static_cast<uint32_t>(part.size());
+        entries.push_back(entry);
+        offset += entry.size;
+    }
+    return assemble(ContainerCipher::Route, routeFingerprint(cipher), prepared.size(), chunkLength, bodies, entries);
+}
+
+/**
+ * @brief Дешифрование набора блоков, возможно в нескольких потоках
+ * @details Потоки разбирают блоки по атомарному счётчику, результат
+ *          каждого блока пишется в свою ячейку и склеивается по порядку
+ */
+template <typename Decryptor>
+string CipherContainer::decryptChunks(size_t first, size_t last, unsigned threads, Decryptor decryptOne) const
+{
+    vector<string> parts(last - first);
+    atomic<size_t> next(first);
+    exception_ptr error;
+    atomic<bool> failed(false);
+
+    auto worker = [&]() {
+        try {
+            for (size_t i = next++; i < last && !failed; i = next++) {
+                parts[i - first] = decryptOne(i);
+            }
+        } catch (...) {
+            if (!failed.exchange(true)) {
+                error = current_exception();
+            }
+        }
+    };
+
+    unsigned count = static_cast<unsigned>(min<size_t>(max(threads, 1u), last - first));
+    vector<thread> pool;
+    for (unsigned t = 1; t < count; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (thread& t : pool) {
+        t.join();
+    }
+    if (error) {
+        rethrow_exception(error);
+    }
+
+    size_t total = 0;
+    for (const string& part : parts) {
+        total += part.size();
+    }
+    string result;
+    result.reserve(total);
+    for (const string& part : parts) {
+        result += part;
+    }
+    return result;
+}
+
+/**
+ * @brief Дешифрование всего текста шифром Гронсфельда
+ */
+string CipherContainer::decrypt(const modAlphaCipher& cipher, unsigned threads) const
+{
+    checkKey(ContainerCipher::Gronsfeld, cipher.keyFingerprint());
+    return decryptChunks(0, chunks.size(), threads, [&](size_t i) {
+        size_t phase = chunks[i].phase;
+        string plain = cipher.decryptChunk(chunkBytes(i), phase);
+        if (plain.size() != size_t(chunks[i].length) * 2) {
+            throw container_error("Chunk length mismatch");
+        }
+        return plain;
+    });
+}
+
+/**
+ * @brief Дешифрование всего текста шифром перестановки
+ * @details Методы RouteCipher не меняют состояние шифра, поэтому один
+ *          объект используется всеми потоками
+ */
+string CipherContainer::decrypt(RouteCipher& cipher, unsigned threads) const
+{
+    checkKey(ContainerCipher::Route, routeFingerprint(cipher));
+    return decryptChunks(0, chunks.size(), threads, [&](size_t i) {
+        wstring wide;
+        if (!utf8ToWide(chunkBytes(i), wide)) {
+            throw container_error("Corrupted chunk encoding");
+        }
+        return wideToUtf8(cipher.DecryptExact(wide, chunks[i].length));
+    });
+}
+
+/**
+ * @brief Дешифрование диапазона символов шифром Гронсфельда
+ */
+string CipherContainer::decryptRange(const modAlphaCipher& cipher, uint64_t first, uint64_t count) const
+{
+    checkKey(ContainerCipher::Gronsfeld, cipher.keyFingerprint());
+    if (first > totalLength || count > totalLength - first) {
+        throw container_error("Range is outside of the text");
+    }
+    if (count == 0) {
+        return string();
+    }
+    size_t firstChunk = static_cast<size_t>(first / chunkLength);
+    size_t lastChunk = static_cast<size_t>((first + count - 1) / chunkLength) + 1;
+    string plain = decryptChunks(firstChunk, lastChunk, 1, [&](size_t i) {
+        size_t phase = chunks[i].phase;
+        return cipher.decryptChunk(chunkBytes(i), phase);
+    });
+    size_t skip = static_cast<size_t>(first - uint64_t(firstChunk) * chunkLength);
+    return plain.substr(skip * 2, static_cast<size_t>(count) * 2);
+}
+
+/**
+ * @brief Дешифрование диапазона символов шифром перестановки
+ */
+string CipherContainer::decryptRange(RouteCipher& cipher, uint64_t first, uint64_t count) const
+{
+    checkKey(ContainerCipher::Route, routeFingerprint(cipher));
+    if (first > totalLength || count > totalLength - first) {
+        throw container_error("Range is outside of the text");
+    }
+    if (count == 0) {
+        return string();
+    }
+    size_t firstChunk = static_cast<size_t>(first / chunkLength);
+    size_t lastChunk = static_cast<size_t>((first + count - 1) / chunkLength) + 1;
+    wstring plain;
+    for (size_t i = firstChunk; i < lastChunk; ++i) {
+        wstring wide;
+        if (!utf8ToWide(chunkBytes(i), wide)) {
+            throw container_error("Corrupted chunk encoding");
+        }
+        plain += cipher.DecryptExact(wide, chunks[i].length);
+    }
+    size_t skip = static_cast<size_t>(first - uint64_t(firstChunk) * chunkLength);
+    return wideToUtf8(plain.substr(skip, static_cast<size_t>(count)));
+}
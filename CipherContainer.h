@@ -0,0 +1,211 @@
+/**
+ * @file CipherContainer.h
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Контейнер шифротекста из независимо зашифрованных блоков
+ * @copyright ИБСТ ПГУ
+ * @details Формат (все числа little-endian):
+ *
+ * Заголовок, 32 байта:
+ *   "LB4C", u16 версия, u8 тип шифра, u8 режим текста (TextMode, только Strict),
+ *   u64 отпечаток ключа, u64 длина открытого текста в символах,
+ *   u32 длина блока в символах, u32 количество блоков
+ *
+ * Блоки: шифротекст каждого блока в UTF-8, один за другим.
+ *
+ * Индекс, по 24 байта на блок:
+ *   u64 смещение блока от начала контейнера, u32 размер в байтах,
+ *   u32 длина открытого текста блока в символах,
+ *   u32 фаза ключа Гронсфельда для первой буквы блока, u32 резерв
+ *
+ * Окончание, 16 байт: u64 смещение индекса, "LB4I", u32 резерв.
+ *
+ * Длины открытого текста хранятся точно, поэтому при дешифровании
+ * блоков маршрутной перестановки заполнители 'X' отбрасываются без
+ * эвристик.
+ */
+
+#ifndef CIPHERCONTAINER_H
+#define CIPHERCONTAINER_H
+
+#include "modAlphaCipher.h"
+#include "2/RouteCipher.h"
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <cstdint>
+
+/**
+ * @brief Класс исключений для ошибок формата контейнера
+ * @details Наследуется от std::invalid_argument
+ */
+class container_error : public std::invalid_argument {
+public:
+    /**
+     * @brief Конструктор с строкой
+     * @param what_arg Сообщение об ошибке
+     */
+    explicit container_error(const std::string& what_arg) : std::invalid_argument(what_arg) {}
+
+    /**
+     * @brief Конструктор с C-строкой
+     * @param what_arg Сообщение об ошибке
+     */
+    explicit container_error(const char* what_arg) : std::invalid_argument(what_arg) {}
+};
+
+/**
+ * @brief Тип шифра в контейнере
+ */
+enum class ContainerCipher : uint8_t {
+    Gronsfeld = 1, ///< modAlphaCipher
+    Route = 2      ///< RouteCipher
+};
+
+/**
+ * @brief Запись индекса блока
+ */
+struct ContainerChunk {
+    uint64_t offset = 0; ///< Смещение шифротекста блока от начала контейнера
+    uint32_t size = 0; ///< Размер шифротекста блока в байтах
+    uint32_t length = 0; ///< Длина открытого текста блока в символах
+    uint32_t phase = 0; ///< Фаза ключа Гронсфельда для первой буквы блока
+};
+
+/**
+ * @brief Контейнер шифротекста с индексом блоков
+ * @details Блоки шифруются независимо: для шифра Гронсфельда в индексе
+ *          хранится фаза ключа, для перестановки каждый блок - отдельная
+ *          таблица. Поэтому любой блок расшифровывается без соседних,
+ *          блоки можно расшифровывать параллельно, а диапазон символов -
+ *          читать, расшифровав только покрывающие его блоки.
+ */
+class CipherContainer
+{
+private:
+    std::string data; ///< Байты контейнера
+    ContainerCipher type; ///< Тип шифра
+    uint64_t fingerprint; ///< Отпечаток ключа
+    uint64_t totalLength; ///< Длина открытого текста в символах
+    uint32_t chunkLength; ///< Длина блока в символах
+    std::vector<ContainerChunk> chunks; ///< Индекс блоков
+
+    /**
+     * @brief Разбор заголовка и индекса
+     * @throw container_error если формат нарушен
+     */
+    void parse();
+
+    /**
+     * @brief Проверка типа шифра и отпечатка ключа
+     * @throw container_error если контейнер создан другим шифром или ключом
+     */
+    void checkKey(ContainerCipher expected, uint64_t keyPrint) const;
+
+    /**
+     * @brief Дешифрование набора блоков, возможно в нескольких потоках
+     * @param [in] first Первый блок
+     * @param [in] last Блок за последним
+     * @param [in] threads Количество потоков
+     * @param [in] decryptOne Функция дешифрования одного блока
+     * @return Конкатенация открытых текстов блоков
+     */
+    template <typename Decryptor>
+    std::string decryptChunks(size_t first, size_t last, unsigned threads, Decryptor decryptOne) const;
+
+    /**
+     * @brief Байты шифротекста блока
+     */
+    std::string chunkBytes(size_t index) const;
+
+public:
+    static const uint32_t defaultChunkLength = 1 << 16; ///< Длина блока по умолчанию
+
+    /**
+     * @brief Чтение контейнера
+     * @param [in] bytes Байты контейнера
+     * @throw container_error если формат нарушен
+     */
+    explicit CipherContainer(std::string bytes);
+
+    /**
+     * @brief Создание контейнера шифром Гронсфельда
+     * @param [in] cipher Шифр с ключом
+     * @param [in] open_text Открытый текст (пробелы удаляются, как в encrypt)
+     * @param [in] chunkLength Длина блока в буквах
+     * @return Байты контейнера
+     * @throw cipher_error если текст пуст или содержит недопустимые символы
+     * @throw container_error если шифр в режиме TextMode::PassThrough: индекс
+     *        хранит длины блоков в буквах по 2 байта UTF-8, что верно только
+     *        для режима Strict
+     */
+    static std::string create(const modAlphaCipher& cipher, const std::string& open_text,
+                              uint32_t chunkLength = defaultChunkLength);
+
+    /**
+     * @brief Создание контейнера шифром маршрутной перестановки
+     * @param [in] cipher Шифр с ключом
+     * @param [in] open_text Открытый текст в UTF-8 (подготавливается, как в Encrypt)
+     * @param [in] chunkLength Длина блока в символах
+     * @return Байты контейнера
+     * @throw CipherError если текст пуст или не является корректным UTF-8
+     */
+    static std::string create(RouteCipher& cipher, const std::string& open_text,
+                              uint32_t chunkLength = defaultChunkLength);
+
+    /**
+     * @brief Тип шифра
+     */
+    ContainerCipher cipherType() const { return type; }
+
+    /**
+     * @brief Длина открытого текста в символах
+     */
+    uint64_t length() const { return totalLength; }
+
+    /**
+     * @brief Индекс блоков
+     */
+    const std::vector<ContainerChunk>& index() const { return chunks; }
+
+    /**
+     * @brief Дешифрование всего текста
+     * @param [in] cipher Шифр с тем же ключом
+     * @param [in] threads Количество потоков
+     * @return Открытый текст
+     * @throw container_error если ключ не совпадает с ключом контейнера
+     */
+    std::string decrypt(const modAlphaCipher& cipher, unsigned threads = 1) const;
+
+    /**
+     * @brief Дешифрование всего текста
+     * @param [in] cipher Шифр с тем же ключом
+     * @param [in] threads Количество потоков
+     * @return Открытый текст в UTF-8
+     * @throw container_error если ключ не совпадает с ключом контейнера
+     */
+    std::string decrypt(RouteCipher& cipher, unsigned threads = 1) const;
+
+    /**
+     * @brief Дешифрование диапазона символов
+     * @param [in] cipher Шифр с тем же ключом
+     * @param [in] first Номер первого символа
+     * @param [in] count Количество символов
+     * @return Открытый текст диапазона
+     * @throw container_error если диапазон выходит за текст или ключ не совпадает
+     */
+    std::string decryptRange(const modAlphaCipher& cipher, uint64_t first, uint64_t count) const;
+
+    /**
+     * @brief Дешифрование диапазона символов
+     * @param [in] cipher Шифр с тем же ключом
+     * @param [in] first Номер первого символа
+     * @param [in] count Количество символов
+     * @return Открытый текст диапазона в UTF-8
+     * @throw container_error если диапазон выходит за текст или ключ не совпадает
+     */
+    std::string decryptRange(RouteCipher& cipher, uint64_t first, uint64_t count) const;
+};
+
+#endif // CIPHERCONTAINER_H
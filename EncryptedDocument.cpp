@@ -0,0 +1,344 @@
+/**
+ * @file EncryptedDocument.cpp
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Реализация документа с инкрементальным шифрованием
+ * @copyright ИБСТ ПГУ
+ */
+
+#include "EncryptedDocument.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Конструктор
+ * @param [in] documentCipher Шифр с ключом документа
+ * @param [in] text Начальный открытый текст
+ */
+EncryptedDocument::EncryptedDocument(const modAlphaCipher& documentCipher, const string& text)
+    : cipher(documentCipher)
+{
+    root = build(text, 0);
+}
+
+/**
+ * @brief Пересчёт сумм узла по детям
+ */
+void EncryptedDocument::update(Piece* piece)
+{
+    piece->totalBytes = piece->text.size();
+    piece->totalLetters = piece->letters;
+    piece->totalPieces = 1;
+    for (const Tree* child : {&piece->left, &piece->right}) {
+        if (*child) {
+            piece->totalBytes += (*child)->totalBytes;
+            piece->totalLetters += (*child)->totalLetters;
+            piece->totalPieces += (*child)->totalPieces;
+        }
+    }
+}
+
+/**
+ * @brief Слияние деревьев, все позиции a раньше позиций b
+ */
+EncryptedDocument::Tree EncryptedDocument::merge(Tree a, Tree b)
+{
+    if (!a) {
+        return b;
+    }
+    if (!b) {
+        return a;
+    }
+    if (a->priority > b->priority) {
+        a->right = merge(move(a->right), move(b));
+        update(a.get());
+        return a;
+    }
+    b->left = merge(move(a), move(b->left));
+    update(b.get());
+    return b;
+}
+
+/**
+ * @brief Разрезание дерева по позиции
+ * @param [in] tree Дерево
+ * @param [in] pos Позиция в байтах (граница символа)
+ * @param [out] left Первые pos байт
+ * @param [out] right Остальное
+ */
+void EncryptedDocument::split(Tree tree, size_t pos, Tree& left, Tree& right)
+{
+    if (!tree) {
+        left.reset();
+        right.reset();
+        return;
+    }
+    size_t leftBytes = tree->left ? tree->left->totalBytes : 0;
+    size_t end = leftBytes + tree->text.size();
+    if (pos <= leftBytes) {
+        split(move(tree->left), pos, left, tree->left);
+        update(tree.get());
+        right = move(tree);
+        return;
+    }
+    if (pos >= end) {
+        split(move(tree->right), pos - end, tree->right, right);
+        update(tree.get());
+        left = move(tree);
+        return;
+    }
+
+    // Позиция внутри куска: хвост куска становится отдельным узлом
+    size_t cut = pos - leftBytes;
+    Tree tail(new Piece);
+    tail->priority = nextPriority();
+    tail->text = tree->text.substr(cut);
+    tree->text.resize(cut);
+    size_t headLetters = cipher.countLetters(tree->text);
+    tail->letters = tree->letters - headLetters;
+    tree->letters = headLetters;
+    if (tree->cached) {
+        // В режиме PassThrough шифротекст совпадает с текстом по длине,
+        // в режиме Strict состоит только из букв по 2 байта
+        size_t at = cipher.mode == TextMode::PassThrough ? cut : headLetters * 2;
+        tail->cipher = tree->cipher.substr(at);
+        tree->cipher.resize(at);
+        tail->cipherPhase = (tree->cipherPhase + headLetters) % cipher.keyLength();
+        tail->cached = true;
+    }
+    update(tail.get());
+
+    Tree rest = move(tree->right);
+    update(tree.get());
+    left = move(tree);
+    right = merge(move(tail), move(rest));
+}
+
+/**
+ * @brief Следующий приоритет (splitmix64)
+ */
+uint64_t EncryptedDocument::nextPriority()
+{
+    uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief Дерево из кусков текста, зашифрованных с заданной фазы
+ * @param [in] text Текст
+ * @param [in] phase Фаза ключа для первой буквы
+ * @return Дерево кусков не длиннее pieceSize
+ */
+EncryptedDocument::Tree EncryptedDocument::build(const string& text, size_t phase)
+{
+    Tree tree;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = min(text.size(), pos + pieceSize);
+        while (end < text.size() && (static_cast<unsigned char>(text[end]) & 0xC0) == 0x80) {
+            ++end;
+        }
+        Tree piece(new Piece);
+        piece->priority = nextPriority();
+        piece->text = text.substr(pos, end - pos);
+        piece->letters = cipher.countLetters(piece->text);
+        piece->cipherPhase = phase;
+        piece->cipher = cipher.encryptChunk(piece->text, phase);
+        piece->cached = true;
+        ++encryptions;
+        update(piece.get());
+        tree = merge(move(tree), move(piece));
+        pos = end;
+    }
+    return tree;
+}
+
+/**
+ * @brief Проверка, что позиция - граница символа внутри документа
+ */
+void EncryptedDocument::checkPosition(size_t pos) const
+{
+    if (pos > size()) {
+        throw cipher_error("Position beyond end of document");
+    }
+    const Piece* piece = root.get();
+    while (piece) {
+        size_t leftBytes = piece->left ? piece->left->totalBytes : 0;
+        if (pos < leftBytes) {
+            piece = piece->left.get();
+        } else if (pos < leftBytes + piece->text.size()) {
+            if ((static_cast<unsigned char>(piece->text[pos - leftBytes]) & 0xC0) == 0x80) {
+                throw cipher_error("Position inside a UTF-8 character");
+            }
+            return;
+        } else {
+            pos -= leftBytes + piece->text.size();
+            piece = piece->right.get();
+        }
+    }
+}
+
+/**
+ * @brief Количество букв перед позицией
+ */
+size_t EncryptedDocument::lettersBefore(size_t pos) const
+{
+    size_t count = 0;
+    const Piece* piece = root.get();
+    while (piece) {
+        size_t leftBytes = piece->left ? piece->left->totalBytes : 0;
+        size_t leftLetters = piece->left ? piece->left->totalLetters : 0;
+        if (pos <= leftBytes) {
+            piece = piece->left.get();
+        } else if (pos < leftBytes + piece->text.size()) {
+            return count + leftLetters + cipher.countLetters(piece->text.substr(0, pos - leftBytes));
+        } else {
+            count += leftLetters + piece->letters;
+            pos -= leftBytes + piece->text.size();
+            piece = piece->right.get();
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Вставка текста
+ * @param [in] pos Позиция в байтах
+ * @param [in] text Вставляемый текст
+ */
+void EncryptedDocument::insert(size_t pos, const string& text)
+{
+    checkPosition(pos);
+    // Вставка шифруется (и проверяется) до изменения дерева
+    Tree inserted = build(text, lettersBefore(pos) % cipher.keyLength());
+    if (!inserted) {
+        return;
+    }
+    Tree left, right;
+    split(move(root), pos, left, right);
+    root = merge(merge(move(left), move(inserted)), move(right));
+}
+
+/**
+ * @brief Удаление текста
+ * @param [in] pos Позиция в байтах
+ * @param [in] length Количество байт
+ */
+void EncryptedDocument::erase(size_t pos, size_t length)
+{
+    if (length > size() || pos > size() - length) {
+        throw cipher_error("Erase range beyond end of document");
+    }
+    checkPosition(pos);
+    checkPosition(pos + length);
+    if (length == 0) {
+        return;
+    }
+    Tree left, middle, right;
+    split(move(root), pos, left, right);
+    split(move(right), length, middle, right);
+    root = merge(move(left), move(right));
+}
+
+/**
+ * @brief Открытый текст документа
+ */
+string EncryptedDocument::text() const
+{
+    string result;
+    result.reserve(size());
+    // Обход по возрастанию позиций без рекурсии
+    vector<const Piece*> stack;
+    const Piece* piece = root.get();
+    while (piece || !stack.empty()) {
+        while (piece) {
+            stack.push_back(piece);
+            piece = piece->left.get();
+        }
+        piece = stack.back();
+        stack.pop_back();
+        result += piece->text;
+        piece = piece->right.get();
+    }
+    return result;
+}
+
+/**
+ * @brief Шифротекст куска для фазы, при необходимости перешифрованный
+ */
+const string& EncryptedDocument::cipherOf(const Piece& piece, size_t phase) const
+{
+    if (!piece.cached || piece.cipherPhase != phase) {
+        size_t p = phase;
+        piece.cipher = cipher.encryptChunk(piece.text, p);
+        piece.cipherPhase = phase;
+        piece.cached = true;
+        ++encryptions;
+    }
+    return piece.cipher;
+}
+
+/**
+ * @brief Сбор шифротекста части документа
+ */
+void EncryptedDocument::collect(const Piece* piece, size_t offset, size_t from, size_t to,
+                                size_t& phase, string& out) const
+{
+    if (!piece) {
+        return;
+    }
+    size_t keyLength = cipher.keyLength();
+    if (offset >= to || offset + piece->totalBytes <= from) {
+        phase = (phase + piece->totalLetters) % keyLength;
+        return;
+    }
+
+    size_t start = offset + (piece->left ? piece->left->totalBytes : 0);
+    size_t end = start + piece->text.size();
+    collect(piece->left.get(), offset, from, to, phase, out);
+    if (start >= from && end <= to) {
+        out += cipherOf(*piece, phase);
+    } else if (end > from && start < to) {
+        size_t a = max(from, start) - start;
+        size_t b = min(to, end) - start;
+        size_t p = (phase + cipher.countLetters(piece->text.substr(0, a))) % keyLength;
+        out += cipher.encryptChunk(piece->text.substr(a, b - a), p);
+    }
+    phase = (phase + piece->letters) % keyLength;
+    collect(piece->right.get(), end, from, to, phase, out);
+}
+
+/**
+ * @brief Шифротекст документа
+ */
+string EncryptedDocument::encrypted() const
+{
+    string result;
+    size_t phase = 0;
+    collect(root.get(), 0, 0, size(), phase, result);
+    return result;
+}
+
+/**
+ * @brief Шифротекст части документа
+ * @param [in] pos Позиция начала части в байтах открытого текста
+ * @param [in] length Длина части в байтах
+ */
+string EncryptedDocument::encryptedRange(size_t pos, size_t length) const
+{
+    if (length > size() || pos > size() - length) {
+        throw cipher_error("Range beyond end of document");
+    }
+    checkPosition(pos);
+    checkPosition(pos + length);
+    string result;
+    size_t phase = 0;
+    collect(root.get(), 0, pos, pos + length, phase, result);
+    return result;
+}
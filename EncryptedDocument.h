@@ -0,0 +1,208 @@
+/**
+ * @file EncryptedDocument.h
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Редактируемый документ с инкрементальным шифрованием
+ * @copyright ИБСТ ПГУ
+ */
+
+#ifndef ENCRYPTEDDOCUMENT_H
+#define ENCRYPTEDDOCUMENT_H
+
+#include "modAlphaCipher.h"
+#include <memory>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Документ, шифротекст которого обновляется по правкам
+ * @details Шифротекст буквы зависит только от неё самой и от её номера
+ *          среди букв по модулю длины ключа. Поэтому правка меняет
+ *          шифротекст лишь начиная с места правки, и то только через фазу
+ *          ключа.
+ *
+ * Открытый текст хранится кусками в декартовом дереве по неявному ключу
+ * (позиции в байтах). В каждом узле хранятся количества байт и букв
+ * поддерева, поэтому вставка, удаление и вычисление фазы ключа в любой
+ * позиции занимают O(log n). Каждый кусок хранит свой шифротекст и фазу,
+ * с которой он зашифрован. Правка его не трогает: кусок перешифровывается
+ * лениво, при выдаче шифротекста, и только если его фаза изменилась.
+ * Вставка числа букв, кратного длине ключа, не перешифровывает ничего,
+ * кроме самой вставки.
+ *
+ * Позиции задаются в байтах открытого текста и должны приходиться на
+ * границы символов UTF-8. Режим обработки символов вне алфавита берётся
+ * из шифра; в режиме Strict шифротекст, как и у encrypt, не содержит
+ * пробелов, а документ из одних пробелов даёт пустой шифротекст.
+ */
+class EncryptedDocument
+{
+private:
+    /**
+     * @brief Кусок текста - узел дерева
+     */
+    struct Piece {
+        std::string text; ///< Открытый текст куска
+        size_t letters = 0; ///< Количество букв в куске
+        uint64_t priority = 0; ///< Приоритет узла в куче
+        size_t totalBytes = 0; ///< Байт в поддереве
+        size_t totalLetters = 0; ///< Букв в поддереве
+        size_t totalPieces = 0; ///< Кусков в поддереве
+        std::unique_ptr<Piece> left; ///< Левое поддерево
+        std::unique_ptr<Piece> right; ///< Правое поддерево
+        mutable std::string cipher; ///< Шифротекст куска
+        mutable size_t cipherPhase = 0; ///< Фаза ключа, с которой зашифрован cipher
+        mutable bool cached = false; ///< cipher действителен для cipherPhase
+    };
+
+    typedef std::unique_ptr<Piece> Tree; ///< Поддерево
+
+    static const size_t pieceSize = 4096; ///< Наибольший размер куска при загрузке текста
+
+    modAlphaCipher cipher; ///< Шифр с ключом документа
+    Tree root; ///< Корень дерева
+    uint64_t seed = 0; ///< Состояние генератора приоритетов
+    mutable size_t encryptions = 0; ///< Количество шифрований кусков
+
+    /**
+     * @brief Пересчёт сумм узла по детям
+     */
+    static void update(Piece* piece);
+
+    /**
+     * @brief Слияние деревьев, все позиции a раньше позиций b
+     */
+    static Tree merge(Tree a, Tree b);
+
+    /**
+     * @brief Разрезание дерева по позиции
+     * @param [in] tree Дерево
+     * @param [in] pos Позиция в байтах (граница символа)
+     * @param [out] left Первые pos байт
+     * @param [out] right Остальное
+     * @details Кусок, внутрь которого попала позиция, режется на два;
+     *          его шифротекст режется вместе с ним и остаётся действительным
+     */
+    void split(Tree tree, size_t pos, Tree& left, Tree& right);
+
+    /**
+     * @brief Следующий приоритет (splitmix64)
+     */
+    uint64_t nextPriority();
+
+    /**
+     * @brief Дерево из кусков текста, зашифрованных с заданной фазы
+     * @param [in] text Текст
+     * @param [in] phase Фаза ключа для первой буквы
+     * @return Дерево кусков не длиннее pieceSize
+     * @throw cipher_error если текст содержит недопустимые символы
+     */
+    Tree build(const std::string& text, size_t phase);
+
+    /**
+     * @brief Проверка, что позиция - граница символа внутри документа
+     * @throw cipher_error если позиция за концом документа или внутри символа
+     */
+    void checkPosition(size_t pos) const;
+
+    /**
+     * @brief Количество букв перед позицией
+     */
+    size_t lettersBefore(size_t pos) const;
+
+    /**
+     * @brief Шифротекст куска для фазы, при необходимости перешифрованный
+     */
+    const std::string& cipherOf(const Piece& piece, size_t phase) const;
+
+    /**
+     * @brief Сбор шифротекста части документа
+     * @param [in] piece Поддерево
+     * @param [in] offset Позиция поддерева в документе
+     * @param [in] from Начало части
+     * @param [in] to Конец части
+     * @param [in,out] phase Фаза ключа в начале поддерева
+     * @param [out] out Строка, к которой дописывается шифротекст
+     */
+    void collect(const Piece* piece, size_t offset, size_t from, size_t to,
+                 size_t& phase, std::string& out) const;
+
+public:
+    EncryptedDocument() = delete; ///< Конструктор по умолчанию запрещен
+
+    /**
+     * @brief Конструктор
+     * @param [in] documentCipher Шифр с ключом документа
+     * @param [in] text Начальный открытый текст
+     * @throw cipher_error если текст содержит недопустимые символы
+     */
+    explicit EncryptedDocument(const modAlphaCipher& documentCipher, const std::string& text = "");
+
+    /**
+     * @brief Вставка текста
+     * @param [in] pos Позиция в байтах
+     * @param [in] text Вставляемый текст
+     * @throw cipher_error если позиция некорректна или текст содержит
+     *        недопустимые символы; документ при этом не меняется
+     * @details O(log n) плюс длина вставки: шифруется только вставка,
+     *          куски после неё перешифровываются при выдаче шифротекста
+     */
+    void insert(size_t pos, const std::string& text);
+
+    /**
+     * @brief Удаление текста
+     * @param [in] pos Позиция в байтах
+     * @param [in] length Количество байт
+     * @throw cipher_error если границы некорректны; документ при этом не меняется
+     */
+    void erase(size_t pos, size_t length);
+
+    /**
+     * @brief Размер открытого текста в байтах
+     */
+    size_t size() const { return root ? root->totalBytes : 0; }
+
+    /**
+     * @brief Количество букв в документе
+     */
+    size_t letters() const { return root ? root->totalLetters : 0; }
+
+    /**
+     * @brief Количество кусков
+     */
+    size_t pieces() const { return root ? root->totalPieces : 0; }
+
+    /**
+     * @brief Количество шифрований кусков с создания документа
+     * @details Показывает, сколько работы выполнили правки и выдачи
+     *          шифротекста
+     */
+    size_t pieceEncryptions() const { return encryptions; }
+
+    /**
+     * @brief Открытый текст документа
+     */
+    std::string text() const;
+
+    /**
+     * @brief Шифротекст документа
+     * @return Совпадает с encrypt(text()) шифра документа (пустая строка
+     *         для документа без букв в режиме Strict)
+     */
+    std::string encrypted() const;
+
+    /**
+     * @brief Шифротекст части документа
+     * @param [in] pos Позиция начала части в байтах открытого текста
+     * @param [in] length Длина части в байтах
+     * @return Шифротекст букв части с фазой ключа, которую они имеют в документе
+     * @throw cipher_error если границы некорректны
+     * @details Поддеревья вне части пропускаются по суммам букв, поэтому
+     *          выдача видимого фрагмента не зависит от размера документа
+     */
+    std::string encryptedRange(size_t pos, size_t length) const;
+};
+
+#endif // ENCRYPTEDDOCUMENT_H
@@ -0,0 +1,675 @@
+/**
+ * @file FilePipeline.cpp
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Реализация асинхронного конвейера обработки файлов
+ * @copyright ИБСТ ПГУ
+ * @details Интерфейс io_uring используется напрямую через системные
+ *          вызовы, без внешних библиотек
+ */
+
+#include "FilePipeline.h"
+#include "Utf8.h"
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+/**
+ * @brief Сообщение об ошибке системного вызова
+ * @param [in] what Описание операции
+ * @param [in] err Код ошибки errno
+ */
+string systemMessage(const string& what, int err)
+{
+    return what + ": " + strerror(err);
+}
+
+/**
+ * @brief Полная запись буфера в файл по смещению
+ * @throw pipeline_error при ошибке записи
+ */
+void writeAll(int fd, const char* data, size_t size, uint64_t offset)
+{
+    while (size > 0) {
+        ssize_t n = pwrite(fd, data, size, static_cast<off_t>(offset));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw pipeline_error(systemMessage("Write failed", errno));
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+}
+
+/**
+ * @brief Полное чтение блока файла по смещению
+ * @return Количество прочитанных байт (меньше size только в конце файла)
+ * @throw pipeline_error при ошибке чтения
+ */
+size_t readAll(int fd, char* data, size_t size, uint64_t offset)
+{
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = pread(fd, data + done, size - done, static_cast<off_t>(offset + done));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw pipeline_error(systemMessage("Read failed", errno));
+        }
+        if (n == 0) {
+            break;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return done;
+}
+
+/**
+ * @brief Минимальная обёртка над кольцами io_uring
+ * @details Кольца отображаются в память процесса, заявки на чтение и
+ *          запись кладутся в очередь отправки, результаты забираются
+ *          из очереди завершения
+ */
+class IoRing
+{
+private:
+    int fd = -1;
+    unsigned entries = 0;
+    void* sqRing = MAP_FAILED;
+    size_t sqRingSize = 0;
+    void* cqRing = MAP_FAILED;
+    size_t cqRingSize = 0;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t sqesSize = 0;
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned* sqMask = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned* cqMask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+    unsigned pending = 0; ///< Заявки, ещё не переданные ядру
+
+public:
+    IoRing() = default;
+    IoRing(const IoRing&) = delete;
+    IoRing& operator=(const IoRing&) = delete;
+
+    ~IoRing()
+    {
+        if (sqes != MAP_FAILED) {
+            munmap(sqes, sqesSize);
+        }
+        if (cqRing != MAP_FAILED && cqRing != sqRing) {
+            munmap(cqRing, cqRingSize);
+        }
+        if (sqRing != MAP_FAILED) {
+            munmap(sqRing, sqRingSize);
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    /**
+     * @brief Создание колец
+     * @return false, если ядро не поддерживает io_uring
+     */
+    bool init(unsigned depth)
+    {
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        int ringFd = static_cast<int>(syscall(__NR_io_uring_setup, depth, &params));
+        if (ringFd < 0) {
+            return false;
+        }
+        fd = ringFd;
+        entries = params.sq_entries;
+
+        sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMap) {
+            sqRingSize = cqRingSize = max(sqRingSize, cqRingSize);
+        }
+
+        sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      fd, IORING_OFF_SQ_RING);
+        if (sqRing == MAP_FAILED) {
+            return false;
+        }
+        cqRing = singleMap ? sqRing
+                           : mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                  fd, IORING_OFF_CQ_RING);
+        if (cqRing == MAP_FAILED) {
+            return false;
+        }
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe*>(mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE,
+                                               MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+        if (sqes == MAP_FAILED) {
+            return false;
+        }
+
+        char* sq = static_cast<char*>(sqRing);
+        sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        char* cq = static_cast<char*>(cqRing);
+        cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    /**
+     * @brief Постановка заявки на чтение или запись в очередь отправки
+     */
+    void push(uint8_t opcode, int fileFd, void* buf, size_t size, uint64_t offset, uint64_t userData)
+    {
+        unsigned tail = *sqTail;
+        if (tail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= entries) {
+            submit(0);
+            tail = *sqTail;
+        }
+        unsigned index = tail & *sqMask;
+        io_uring_sqe* sqe = &sqes[index];
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = opcode;
+        sqe->fd = fileFd;
+        sqe->addr = reinterpret_cast<uint64_t>(buf);
+        sqe->len = static_cast<uint32_t>(size);
+        sqe->off = offset;
+        sqe->user_data = userData;
+        sqArray[index] = index;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+        ++pending;
+    }
+
+    /**
+     * @brief Передача заявок ядру и ожидание завершений
+     * @param [in] waitFor Минимальное число завершений для ожидания
+     * @throw pipeline_error при ошибке io_uring_enter
+     */
+    void submit(unsigned waitFor)
+    {
+        for (;;) {
+            long n = syscall(__NR_io_uring_enter, fd, pending, waitFor,
+                             waitFor > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+            if (n >= 0) {
+                pending -= static_cast<unsigned>(n);
+                return;
+            }
+            if (errno != EINTR) {
+                throw pipeline_error(systemMessage("io_uring_enter failed", errno));
+            }
+        }
+    }
+
+    /**
+     * @brief Извлечение одного завершения
+     * @return false, если очередь завершений пуста
+     */
+    bool pop(uint64_t& userData, int& res)
+    {
+        unsigned head = *cqHead;
+        if (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+            return false;
+        }
+        io_uring_cqe* cqe = &cqes[head & *cqMask];
+        userData = cqe->user_data;
+        res = cqe->res;
+        __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+};
+
+/**
+ * @brief Буфер одного слота конвейера
+ */
+struct Slot {
+    unique_ptr<char[]> in; ///< Входной буфер
+    size_t requested = 0; ///< Запрошено байт
+    size_t length = 0; ///< Прочитано байт
+    uint64_t offset = 0; ///< Смещение блока во входном файле
+    bool readDone = false; ///< Чтение завершено
+    string out; ///< Результат преобразования
+    uint64_t outOffset = 0; ///< Смещение результата в выходном файле
+    bool writePending = false; ///< Запись результата ещё в полёте
+};
+
+/**
+ * @brief Ограниченная очередь между потоками конвейера
+ */
+template <typename T>
+class BoundedQueue
+{
+private:
+    deque<T> items;
+    size_t capacity;
+    bool closed = false;
+    mutex lock;
+    condition_variable notEmpty;
+    condition_variable notFull;
+
+public:
+    explicit BoundedQueue(size_t capacity) : capacity(capacity) {}
+
+    /**
+     * @return false, если очередь закрыта
+     */
+    bool push(T item)
+    {
+        unique_lock<mutex> guard(lock);
+        notFull.wait(guard, [this] { return items.size() < capacity || closed; });
+        if (closed) {
+            return false;
+        }
+        items.push_back(move(item));
+        notEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * @return false, если очередь закрыта и пуста
+     */
+    bool pop(T& item)
+    {
+        unique_lock<mutex> guard(lock);
+        notEmpty.wait(guard, [this] { return !items.empty() || closed; });
+        if (items.empty()) {
+            return false;
+        }
+        item = move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    void close()
+    {
+        lock_guard<mutex> guard(lock);
+        closed = true;
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
+};
+
+/**
+ * @brief Владелец файлового дескриптора
+ */
+struct FileHandle {
+    int fd;
+    explicit FileHandle(int fd) : fd(fd) {}
+    FileHandle(const FileHandle&) = delete;
+    FileHandle& operator=(const FileHandle&) = delete;
+    ~FileHandle()
+    {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+};
+
+} // namespace
+
+GronsfeldStage::GronsfeldStage(const modAlphaCipher& cipher, bool decrypting)
+    : cipher(cipher), decrypting(decrypting)
+{
+}
+
+/**
+ * @brief Обработка блока шифром Гронсфельда
+ * @details Если блок оборван после первого байта буквы, этот байт
+ *          переносится в начало следующего блока
+ */
+void GronsfeldStage::process(const char* data, size_t size, string& out)
+{
+    chunk.assign(carry);
+    chunk.append(data, size);
+    carry.clear();
+    if (!chunk.empty() && (static_cast<unsigned char>(chunk.back()) & 0xC0) == 0xC0) {
+        carry.assign(1, chunk.back());
+        chunk.pop_back();
+    }
+    out = decrypting ? cipher.decryptChunk(chunk, phase) : cipher.encryptChunk(chunk, phase);
+}
+
+void GronsfeldStage::finish(string& out)
+{
+    if (!carry.empty()) {
+        throw cipher_error("Invalid character sequence in input");
+    }
+    out.clear();
+}
+
+RouteStage::RouteStage(RouteCipher& cipher, bool decrypting)
+    : cipher(cipher), decrypting(decrypting)
+{
+}
+
+void RouteStage::process(const char* data, size_t size, string& out)
+{
+    text.append(data, size);
+    out.clear();
+}
+
+void RouteStage::finish(string& out)
+{
+    wstring wide;
+    if (!utf8ToWide(text, wide)) {
+        throw CipherError("Некорректная последовательность UTF-8");
+    }
+    string().swap(text);
+    out = wideToUtf8(decrypting ? cipher.Decrypt(wide) : cipher.Encrypt(wide));
+}
+
+/**
+ * @brief Конструктор конвейера
+ * @param [in] options Параметры конвейера
+ * @throw pipeline_error если глубина очереди или размер буфера равны нулю
+ */
+FilePipeline::FilePipeline(const PipelineOptions& options) : options(options)
+{
+    if (options.queueDepth == 0) {
+        throw pipeline_error("Queue depth must be positive");
+    }
+    if (options.bufferSize == 0 || options.bufferSize > (1u << 30)) {
+        throw pipeline_error("Buffer size must be between 1 byte and 1 GiB");
+    }
+}
+
+/**
+ * @brief Обработка файла
+ * @param [in] inPath Путь к входному файлу
+ * @param [in] outPath Путь к выходному файлу (перезаписывается)
+ * @param [in] stage Стадия преобразования
+ * @return Статистика выполнения
+ */
+PipelineStats FilePipeline::run(const string& inPath, const string& outPath, PipelineStage& stage)
+{
+    FileHandle in(open(inPath.c_str(), O_RDONLY | O_CLOEXEC));
+    if (in.fd < 0) {
+        throw pipeline_error(systemMessage("Cannot open " + inPath, errno));
+    }
+    struct stat st;
+    if (fstat(in.fd, &st) != 0) {
+        throw pipeline_error(systemMessage("Cannot stat " + inPath, errno));
+    }
+    FileHandle out(open(outPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));
+    if (out.fd < 0) {
+        throw pipeline_error(systemMessage("Cannot open " + outPath, errno));
+    }
+
+    PipelineStats stats;
+    uint64_t fileSize = static_cast<uint64_t>(st.st_size);
+    if (options.useIoUring && runIoUring(in.fd, out.fd, fileSize, stage, stats)) {
+        stats.usedIoUring = true;
+    } else {
+        runThreaded(in.fd, out.fd, fileSize, stage, stats);
+    }
+    return stats;
+}
+
+/**
+ * @brief Выполнение через io_uring
+ * @details Заявки на чтение ставятся в очередь на queueDepth блоков вперёд.
+ *          Блоки обрабатываются в порядке следования в файле, результат
+ *          сразу отправляется на запись по своему смещению, а освободившийся
+ *          входной буфер тут же получает заявку на чтение следующего блока.
+ *          Короткие операции дочитываются и дописываются синхронно.
+ * @return false, если io_uring недоступен в ядре
+ */
+bool FilePipeline::runIoUring(int inFd, int outFd, uint64_t fileSize, PipelineStage& stage, PipelineStats& stats)
+{
+    IoRing ring;
+    if (!ring.init(options.queueDepth * 2)) {
+        return false;
+    }
+
+    vector<Slot> slots(options.queueDepth);
+    for (Slot& slot : slots) {
+        slot.in.reset(new char[options.bufferSize]);
+    }
+    deque<size_t> readOrder;
+    uint64_t nextRead = 0;
+    uint64_t nextWrite = 0;
+    unsigned inFlight = 0;
+
+    auto submitRead = [&](size_t index) {
+        Slot& slot = slots[index];
+        slot.offset = nextRead;
+        slot.requested = static_cast<size_t>(min<uint64_t>(options.bufferSize, fileSize - nextRead));
+        slot.readDone = false;
+        nextRead += slot.requested;
+        ring.push(IORING_OP_READ, inFd, slot.in.get(), slot.requested, slot.offset, index << 1);
+        readOrder.push_back(index);
+        ++inFlight;
+    };
+
+    auto reap = [&]() {
+        ring.submit(1);
+        uint64_t userData;
+        int res;
+        while (ring.pop(userData, res)) {
+            --inFlight;
+            Slot& slot = slots[userData >> 1];
+            if (res < 0) {
+                throw pipeline_error(systemMessage((userData & 1) ? "Write failed" : "Read failed", -res));
+            }
+            size_t done = static_cast<size_t>(res);
+            if (userData & 1) {
+                if (done < slot.out.size()) {
+                    writeAll(outFd, slot.out.data() + done, slot.out.size() - done, slot.outOffset + done);
+                }
+                slot.writePending = false;
+            } else {
+                if (done < slot.requested) {
+                    done += readAll(inFd, slot.in.get() + done, slot.requested - done, slot.offset + done);
+                }
+                slot.length = done;
+                slot.readDone = true;
+            }
+        }
+    };
+
+    try {
+        for (size_t i = 0; i < slots.size() && nextRead < fileSize; ++i) {
+            submitRead(i);
+        }
+
+        while (!readOrder.empty()) {
+            size_t index = readOrder.front();
+            Slot& slot = slots[index];
+            while (!slot.readDone || slot.writePending) {
+                reap();
+            }
+            readOrder.pop_front();
+            stats.bytesRead += slot.length;
+
+            slot.out.clear();
+            stage.process(slot.in.get(), slot.length, slot.out);
+            if (nextRead < fileSize) {
+                submitRead(index);
+            }
+            if (!slot.out.empty()) {
+                slot.outOffset = nextWrite;
+                slot.writePending = true;
+                nextWrite += slot.out.size();
+                stats.bytesWritten += slot.out.size();
+                ring.push(IORING_OP_WRITE, outFd, &slot.out[0], slot.out.size(), slot.outOffset, (index << 1) | 1);
+                ++inFlight;
+            }
+        }
+
+        while (inFlight > 0) {
+            reap();
+        }
+    } catch (...) {
+        // Буферы слотов нельзя освобождать, пока ядро с ними работает.
+        // Завершения только вычитываются, без дочитывания и дозаписи. Если
+        // io_uring_enter отказал (EBADF, EFAULT) или не даёт завершений,
+        // их не дождаться: буферы намеренно оставляются в памяти, чтобы
+        // не зависнуть
+        const unsigned maxIdleWaits = 3;
+        unsigned idle = 0;
+        while (inFlight > 0) {
+            bool entered = true;
+            try {
+                ring.submit(1);
+            } catch (const pipeline_error&) {
+                entered = false;
+            }
+            uint64_t userData;
+            int res;
+            bool progress = false;
+            while (ring.pop(userData, res)) {
+                --inFlight;
+                progress = true;
+            }
+            idle = progress ? 0 : idle + 1;
+            if (inFlight > 0 && (!entered || idle >= maxIdleWaits)) {
+                static_cast<void>(new vector<Slot>(move(slots)));
+                break;
+            }
+        }
+        throw;
+    }
+
+    string tail;
+    stage.finish(tail);
+    writeAll(outFd, tail.data(), tail.size(), nextWrite);
+    stats.bytesWritten += tail.size();
+    return true;
+}
+
+/**
+ * @brief Выполнение с потоками чтения и записи
+ * @details Поток чтения заполняет свободные буферы и передаёт их
+ *          преобразованию через ограниченную очередь, поток записи
+ *          получает результаты в том же порядке
+ */
+void FilePipeline::runThreaded(int inFd, int outFd, uint64_t fileSize, PipelineStage& stage, PipelineStats& stats)
+{
+    struct Block {
+        unique_ptr<char[]> data;
+        size_t length = 0;
+    };
+    BoundedQueue<Block> freeBlocks(options.queueDepth);
+    BoundedQueue<Block> filled(options.queueDepth);
+    BoundedQueue<string> results(options.queueDepth);
+    for (unsigned i = 0; i < options.queueDepth; ++i) {
+        Block block;
+        block.data.reset(new char[options.bufferSize]);
+        freeBlocks.push(move(block));
+    }
+
+    // Ошибки потоков: флаг читается главным потоком без синхронизации
+    // через очереди, а исключения забираются только после join
+    mutex errorLock;
+    exception_ptr readError;
+    exception_ptr writeError;
+    atomic<bool> ioFailed(false);
+    uint64_t written = 0;
+
+    thread reader([&] {
+        try {
+            uint64_t offset = 0;
+            Block block;
+            while (offset < fileSize && freeBlocks.pop(block)) {
+                size_t want = static_cast<size_t>(min<uint64_t>(options.bufferSize, fileSize - offset));
+                block.length = readAll(inFd, block.data.get(), want, offset);
+                offset += want;
+                if (!filled.push(move(block))) {
+                    break;
+                }
+            }
+        } catch (...) {
+            lock_guard<mutex> guard(errorLock);
+            readError = current_exception();
+            ioFailed = true;
+        }
+        filled.close();
+    });
+
+    thread writer([&] {
+        try {
+            string out;
+            while (results.pop(out)) {
+                writeAll(outFd, out.data(), out.size(), written);
+                written += out.size();
+            }
+        } catch (...) {
+            {
+                lock_guard<mutex> guard(errorLock);
+                writeError = current_exception();
+                ioFailed = true;
+            }
+            results.close();
+        }
+    });
+
+    exception_ptr stageError;
+    try {
+        Block block;
+        while (filled.pop(block)) {
+            stats.bytesRead += block.length;
+            string out;
+            stage.process(block.data.get(), block.length, out);
+            freeBlocks.push(move(block));
+            if (!out.empty() && !results.push(move(out))) {
+                break;
+            }
+        }
+        if (!ioFailed) {
+            string tail;
+            stage.finish(tail);
+            if (!tail.empty()) {
+                results.push(move(tail));
+            }
+        }
+    } catch (...) {
+        stageError = current_exception();
+    }
+
+    freeBlocks.close();
+    filled.close();
+    results.close();
+    reader.join();
+    writer.join();
+
+    if (stageError) {
+        rethrow_exception(stageError);
+    }
+    if (readError) {
+        rethrow_exception(readError);
+    }
+    if (writeError) {
+        rethrow_exception(writeError);
+    }
+    stats.bytesWritten = written;
+}
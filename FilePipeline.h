@@ -0,0 +1,187 @@
+/**
+ * @file FilePipeline.h
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Асинхронный конвейер обработки файлов (чтение → шифрование → запись)
+ * @copyright ИБСТ ПГУ
+ * @details Конвейер держит в полёте несколько буферов чтения, пока текущий
+ *          буфер обрабатывается шифром, и записывает результаты строго по
+ *          порядку. Ввод-вывод выполняется через io_uring, а на ядрах без
+ *          его поддержки - отдельными потоками чтения и записи.
+ */
+
+#ifndef FILEPIPELINE_H
+#define FILEPIPELINE_H
+
+#include "modAlphaCipher.h"
+#include "2/RouteCipher.h"
+#include <string>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Класс исключений для ошибок ввода-вывода конвейера
+ * @details Наследуется от std::runtime_error
+ */
+class pipeline_error : public std::runtime_error {
+public:
+    /**
+     * @brief Конструктор с строкой
+     * @param what_arg Сообщение об ошибке
+     */
+    explicit pipeline_error(const std::string& what_arg) : std::runtime_error(what_arg) {}
+
+    /**
+     * @brief Конструктор с C-строкой
+     * @param what_arg Сообщение об ошибке
+     */
+    explicit pipeline_error(const char* what_arg) : std::runtime_error(what_arg) {}
+};
+
+/**
+ * @brief Стадия преобразования данных в конвейере
+ * @details Получает блоки файла строго по порядку. Блоки режутся по
+ *          размеру буфера, поэтому стадия сама отвечает за символы,
+ *          разрезанные границей блока.
+ */
+class PipelineStage
+{
+public:
+    virtual ~PipelineStage() = default;
+
+    /**
+     * @brief Обработка очередного блока входного файла
+     * @param [in] data Начало блока
+     * @param [in] size Размер блока в байтах
+     * @param [out] out Буфер для результата (очищен перед вызовом)
+     */
+    virtual void process(const char* data, size_t size, std::string& out) = 0;
+
+    /**
+     * @brief Завершение обработки после последнего блока
+     * @param [out] out Буфер для оставшегося результата (очищен перед вызовом)
+     */
+    virtual void finish(std::string& out) = 0;
+};
+
+/**
+ * @brief Стадия шифра Гронсфельда
+ * @details Обрабатывает блоки по мере поступления, перенося фазу ключа
+ *          и незавершённый символ UTF-8 между блоками
+ */
+class GronsfeldStage : public PipelineStage
+{
+private:
+    const modAlphaCipher& cipher; ///< Шифр с установленным ключом
+    bool decrypting; ///< Направление преобразования
+    size_t phase = 0; ///< Позиция в ключе для следующей буквы
+    std::string carry; ///< Хвост предыдущего блока с неполным символом
+    std::string chunk; ///< Рабочий буфер блока
+
+public:
+    /**
+     * @brief Конструктор стадии
+     * @param [in] cipher Шифр, который должен жить дольше стадии
+     * @param [in] decrypting true для дешифрования, false для шифрования
+     */
+    GronsfeldStage(const modAlphaCipher& cipher, bool decrypting);
+
+    void process(const char* data, size_t size, std::string& out) override;
+
+    /**
+     * @brief Завершение обработки
+     * @throw cipher_error если файл оборван посреди символа
+     */
+    void finish(std::string& out) override;
+};
+
+/**
+ * @brief Стадия шифра маршрутной перестановки
+ * @details Перестановке нужен весь текст целиком, поэтому стадия
+ *          накапливает блоки и шифрует их в finish(). Конвейер при этом
+ *          всё равно совмещает чтение файла с приёмом данных.
+ */
+class RouteStage : public PipelineStage
+{
+private:
+    RouteCipher& cipher; ///< Шифр с установленным ключом
+    bool decrypting; ///< Направление преобразования
+    std::string text; ///< Накопленный текст в UTF-8
+
+public:
+    /**
+     * @brief Конструктор стадии
+     * @param [in] cipher Шифр, который должен жить дольше стадии
+     * @param [in] decrypting true для дешифрования, false для шифрования
+     */
+    RouteStage(RouteCipher& cipher, bool decrypting);
+
+    void process(const char* data, size_t size, std::string& out) override;
+
+    /**
+     * @brief Шифрование накопленного текста
+     * @throw CipherError если текст пуст или не является корректным UTF-8
+     */
+    void finish(std::string& out) override;
+};
+
+/**
+ * @brief Параметры конвейера
+ */
+struct PipelineOptions {
+    unsigned queueDepth = 4; ///< Количество буферов чтения в полёте
+    size_t bufferSize = 1 << 20; ///< Размер одного буфера в байтах
+    bool useIoUring = true; ///< Разрешить io_uring (иначе сразу потоки)
+};
+
+/**
+ * @brief Статистика выполнения конвейера
+ */
+struct PipelineStats {
+    uint64_t bytesRead = 0; ///< Прочитано байт
+    uint64_t bytesWritten = 0; ///< Записано байт
+    bool usedIoUring = false; ///< Ввод-вывод выполнялся через io_uring
+};
+
+/**
+ * @brief Конвейер чтение → преобразование → запись с двойной буферизацией
+ */
+class FilePipeline
+{
+private:
+    PipelineOptions options; ///< Параметры конвейера
+
+    /**
+     * @brief Выполнение через io_uring
+     * @return false, если io_uring недоступен в ядре
+     */
+    bool runIoUring(int inFd, int outFd, uint64_t fileSize, PipelineStage& stage, PipelineStats& stats);
+
+    /**
+     * @brief Выполнение с потоками чтения и записи
+     */
+    void runThreaded(int inFd, int outFd, uint64_t fileSize, PipelineStage& stage, PipelineStats& stats);
+
+public:
+    /**
+     * @brief Конструктор конвейера
+     * @param [in] options Параметры конвейера
+     * @throw pipeline_error если глубина очереди или размер буфера равны нулю
+     */
+    explicit FilePipeline(const PipelineOptions& options = PipelineOptions());
+
+    /**
+     * @brief Обработка файла
+     * @param [in] inPath Путь к входному файлу
+     * @param [in] outPath Путь к выходному файлу (перезаписывается)
+     * @param [in] stage Стадия преобразования
+     * @return Статистика выполнения
+     * @throw pipeline_error при ошибках ввода-вывода
+     * @throw cipher_error, CipherError при ошибках шифрования
+     */
+    PipelineStats run(const std::string& inPath, const std::string& outPath, PipelineStage& stage);
+};
+
+#endif // FILEPIPELINE_H
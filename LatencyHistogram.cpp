@@ -0,0 +1,388 @@
+/**
+ * @file LatencyHistogram.cpp
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Реализация гистограмм задержек
+ * @copyright ИБСТ ПГУ
+ */
+
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+const size_t slotCount = LatencyRecorder::opCount * LatencyRecorder::sizeClassCount; ///< Пар (операция, класс размера)
+
+/**
+ * @brief Счётчики корзин, в которые пишет один поток
+ * @details Атомарны только для того, чтобы снимок из другого потока
+ *          читал их без гонки; запись - обычные load и store
+ */
+struct Counters {
+    array<atomic<uint64_t>, LatencyHistogram::bucketCount> counts{};
+};
+
+/**
+ * @brief Гистограммы одного потока
+ */
+struct ThreadSlots {
+    array<atomic<Counters*>, slotCount> slots{};
+
+    ThreadSlots();
+    ~ThreadSlots();
+};
+
+/**
+ * @brief Список потоков и итог завершившихся потоков
+ */
+struct Registry {
+    mutex lock; ///< Защищает threads и retired, но не запись
+    vector<ThreadSlots*> threads; ///< Потоки, писавшие задержки
+    vector<LatencyHistogram> retired = vector<LatencyHistogram>(slotCount); ///< Итог завершившихся потоков
+};
+
+Registry& registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+/**
+ * @brief Добавление счётчиков потока к гистограмме
+ */
+void collect(const Counters& counters, LatencyHistogram& out)
+{
+    for (size_t i = 0; i < LatencyHistogram::bucketCount; ++i) {
+        uint64_t n = counters.counts[i].load(memory_order_relaxed);
+        if (n > 0) {
+            out.addBucket(i, n);
+        }
+    }
+}
+
+ThreadSlots::ThreadSlots()
+{
+    Registry& r = registry();
+    lock_guard<mutex> guard(r.lock);
+    r.threads.push_back(this);
+}
+
+ThreadSlots::~ThreadSlots()
+{
+    Registry& r = registry();
+    lock_guard<mutex> guard(r.lock);
+    for (size_t s = 0; s < slotCount; ++s) {
+        Counters* counters = slots[s].load(memory_order_relaxed);
+        if (counters != nullptr) {
+            collect(*counters, r.retired[s]);
+            delete counters;
+        }
+    }
+    r.threads.erase(find(r.threads.begin(), r.threads.end(), this));
+}
+
+/**
+ * @brief Гистограммы текущего потока
+ */
+ThreadSlots& localSlots()
+{
+    thread_local ThreadSlots slots;
+    return slots;
+}
+
+/**
+ * @brief Значение в микросекундах для таблицы
+ */
+double micros(uint64_t nanoseconds)
+{
+    return nanoseconds / 1000.0;
+}
+
+} // namespace
+
+/**
+ * @brief Наименьшее значение корзины
+ * @param [in] index Номер корзины
+ */
+uint64_t LatencyHistogram::bucketLow(size_t index)
+{
+    if (index < 2 * subBucketCount) {
+        return index;
+    }
+    unsigned shift = static_cast<unsigned>(index / subBucketCount - 1);
+    return static_cast<uint64_t>(index - subBucketCount * shift) << shift;
+}
+
+/**
+ * @brief Наибольшее значение корзины
+ * @param [in] index Номер корзины
+ */
+uint64_t LatencyHistogram::bucketHigh(size_t index)
+{
+    if (index < 2 * subBucketCount) {
+        return index;
+    }
+    unsigned shift = static_cast<unsigned>(index / subBucketCount - 1);
+    return bucketLow(index) + ((uint64_t(1) << shift) - 1);
+}
+
+/**
+ * @brief Запись значения
+ * @param [in] value Значение
+ * @param [in] times Сколько раз записать
+ */
+void LatencyHistogram::record(uint64_t value, uint64_t times)
+{
+    if (times == 0) {
+        return;
+    }
+    counts[bucketIndex(value)] += times;
+    total += times;
+    minValue = std::min(minValue, value);
+    maxValue = std::max(maxValue, value);
+}
+
+/**
+ * @brief Добавление корзины другой гистограммы
+ * @details Наименьшее и наибольшее значения известны с точностью до корзины
+ */
+void LatencyHistogram::addBucket(size_t index, uint64_t times)
+{
+    if (times == 0) {
+        return;
+    }
+    counts[index] += times;
+    total += times;
+    minValue = std::min(minValue, bucketLow(index));
+    maxValue = std::max(maxValue, bucketHigh(index));
+}
+
+/**
+ * @brief Сложение с другой гистограммой
+ * @param [in] other Гистограмма
+ */
+void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+    for (size_t i = 0; i < bucketCount; ++i) {
+        counts[i] += other.counts[i];
+    }
+    total += other.total;
+    minValue = std::min(minValue, other.minValue);
+    maxValue = std::max(maxValue, other.maxValue);
+}
+
+/**
+ * @brief Очистка
+ */
+void LatencyHistogram::reset()
+{
+    counts.fill(0);
+    total = 0;
+    minValue = UINT64_MAX;
+    maxValue = 0;
+}
+
+/**
+ * @brief Среднее значение по серединам корзин
+ */
+double LatencyHistogram::mean() const
+{
+    if (total == 0) {
+        return 0;
+    }
+    double sum = 0;
+    for (size_t i = 0; i < bucketCount; ++i) {
+        if (counts[i] > 0) {
+            sum += counts[i] * ((bucketLow(i) + static_cast<double>(bucketHigh(i))) / 2);
+        }
+    }
+    return sum / total;
+}
+
+/**
+ * @brief Значение перцентиля
+ * @param [in] percentile Перцентиль от 0 до 100
+ */
+uint64_t LatencyHistogram::percentile(double percentile) const
+{
+    if (total == 0) {
+        return 0;
+    }
+    percentile = std::min(100.0, std::max(0.0, percentile));
+    uint64_t rank = static_cast<uint64_t>(percentile / 100 * total + 0.5);
+    rank = std::max<uint64_t>(1, std::min(rank, total));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < bucketCount; ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return std::min(bucketHigh(i), maxValue);
+        }
+    }
+    return maxValue;
+}
+
+/**
+ * @brief Распределение перцентилей для построения графика
+ */
+string LatencyHistogram::percentileDistribution() const
+{
+    ostringstream out;
+    out << "value percentile count\n";
+    uint64_t seen = 0;
+    for (size_t i = 0; i < bucketCount; ++i) {
+        if (counts[i] == 0) {
+            continue;
+        }
+        seen += counts[i];
+        out << std::min(bucketHigh(i), maxValue) << ' ' << fixed << setprecision(6)
+            << 100.0 * seen / total << ' ' << seen << '\n';
+    }
+    return out.str();
+}
+
+/**
+ * @brief Класс размера входа
+ * @param [in] bytes Размер входа в байтах
+ */
+size_t LatencyRecorder::sizeClass(size_t bytes)
+{
+    size_t result = 0;
+    size_t limit = 1024;
+    while (result + 1 < sizeClassCount && bytes >= limit) {
+        limit *= 4;
+        ++result;
+    }
+    return result;
+}
+
+/**
+ * @brief Название класса размера
+ */
+const char* LatencyRecorder::sizeClassName(size_t sizeClass)
+{
+    static const char* const names[sizeClassCount] = {
+        "<1K", "<4K", "<16K", "<64K", "<256K", "<1M", "<4M", ">=4M"
+    };
+    return sizeClass < sizeClassCount ? names[sizeClass] : "?";
+}
+
+/**
+ * @brief Название операции
+ */
+const char* LatencyRecorder::opName(LatencyOp op)
+{
+    static const char* const names[opCount] = {
+        "gronsfeld.encrypt", "gronsfeld.decrypt", "gronsfeld.bulk",
+        "route.encrypt", "route.decrypt", "route.bulk"
+    };
+    size_t index = static_cast<size_t>(op);
+    return index < opCount ? names[index] : "?";
+}
+
+/**
+ * @brief Запись задержки в гистограмму текущего потока
+ * @param [in] op Операция
+ * @param [in] bytes Размер входа в байтах
+ * @param [in] nanoseconds Задержка
+ */
+void LatencyRecorder::record(LatencyOp op, size_t bytes, uint64_t nanoseconds)
+{
+    ThreadSlots& local = localSlots();
+    size_t slot = static_cast<size_t>(op) * sizeClassCount + sizeClass(bytes);
+    Counters* counters = local.slots[slot].load(memory_order_relaxed);
+    if (counters == nullptr) {
+        counters = new Counters();
+        local.slots[slot].store(counters, memory_order_release);
+    }
+    atomic<uint64_t>& bucket = counters->counts[LatencyHistogram::bucketIndex(nanoseconds)];
+    bucket.store(bucket.load(memory_order_relaxed) + 1, memory_order_relaxed);
+}
+
+/**
+ * @brief Снимок гистограммы, сложенной по всем потокам
+ * @param [in] op Операция
+ * @param [in] sizeClass Класс размера
+ */
+LatencyHistogram LatencyRecorder::snapshot(LatencyOp op, size_t sizeClass)
+{
+    size_t slot = static_cast<size_t>(op) * sizeClassCount + std::min(sizeClass, sizeClassCount - 1);
+    Registry& r = registry();
+    lock_guard<mutex> guard(r.lock);
+    LatencyHistogram result = r.retired[slot];
+    for (ThreadSlots* thread : r.threads) {
+        const Counters* counters = thread->slots[slot].load(memory_order_acquire);
+        if (counters != nullptr) {
+            collect(*counters, result);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Снимок по всем классам размера операции
+ * @param [in] op Операция
+ */
+LatencyHistogram LatencyRecorder::snapshot(LatencyOp op)
+{
+    LatencyHistogram result;
+    for (size_t c = 0; c < sizeClassCount; ++c) {
+        result.merge(snapshot(op, c));
+    }
+    return result;
+}
+
+/**
+ * @brief Таблица перцентилей
+ */
+string LatencyRecorder::report()
+{
+    ostringstream out;
+    out << left << setw(20) << "operation" << setw(8) << "size" << right
+        << setw(10) << "calls" << setw(10) << "mean us" << setw(10) << "p50"
+        << setw(10) << "p90" << setw(10) << "p99" << setw(10) << "p99.9"
+        << setw(10) << "p99.99" << setw(10) << "max" << '\n';
+    out << fixed << setprecision(1);
+    for (size_t op = 0; op < opCount; ++op) {
+        for (size_t c = 0; c < sizeClassCount; ++c) {
+            LatencyHistogram h = snapshot(static_cast<LatencyOp>(op), c);
+            if (h.count() == 0) {
+                continue;
+            }
+            out << left << setw(20) << opName(static_cast<LatencyOp>(op)) << setw(8) << sizeClassName(c)
+                << right << setw(10) << h.count() << setw(10) << micros(static_cast<uint64_t>(h.mean()))
+                << setw(10) << micros(h.percentile(50)) << setw(10) << micros(h.percentile(90))
+                << setw(10) << micros(h.percentile(99)) << setw(10) << micros(h.percentile(99.9))
+                << setw(10) << micros(h.percentile(99.99)) << setw(10) << micros(h.max()) << '\n';
+        }
+    }
+    return out.str();
+}
+
+/**
+ * @brief Очистка всех гистограмм
+ */
+void LatencyRecorder::reset()
+{
+    Registry& r = registry();
+    lock_guard<mutex> guard(r.lock);
+    for (LatencyHistogram& h : r.retired) {
+        h.reset();
+    }
+    for (ThreadSlots* thread : r.threads) {
+        for (size_t s = 0; s < slotCount; ++s) {
+            Counters* counters = thread->slots[s].load(memory_order_acquire);
+            if (counters != nullptr) {
+                for (atomic<uint64_t>& n : counters->counts) {
+                    n.store(0, memory_order_relaxed);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,246 @@
+/**
+ * @file LatencyHistogram.h
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Гистограммы задержек вызовов шифров
+ * @copyright ИБСТ ПГУ
+ * @details Гистограмма устроена как HDR Histogram: значения до 64
+ *          хранятся точно, дальше каждая степень двойки делится на 32
+ *          равных корзины, так что относительная погрешность не больше
+ *          1/32 при любом масштабе, от наносекунд до минут.
+ *
+ * Библиотека записывает задержки encrypt, decrypt и пакетного режима
+ * modAlphaCipher и RouteCipher, если запись включена
+ * LatencyRecorder::enable. Каждый поток пишет в свои гистограммы без
+ * блокировок и атомарных операций чтения-изменения-записи; снимок
+ * складывает гистограммы всех потоков. Задержки разнесены по операциям
+ * и классам размера входа, что позволяет отделить хвост, вызванный
+ * размером текста, от хвоста, вызванного выделением памяти (пакетный
+ * режим с BufferArena против обычного).
+ */
+
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Гистограмма задержек с логарифмически-линейными корзинами
+ * @details Обычный (не потокобезопасный) объект: результат снимка,
+ *          сложения и разбора перцентилей
+ */
+class LatencyHistogram
+{
+public:
+    static const unsigned subBucketBits = 5; ///< Корзин на степень двойки - 2^subBucketBits
+    static const size_t subBucketCount = size_t(1) << subBucketBits; ///< Корзин на степень двойки
+    static const size_t bucketCount = subBucketCount * (65 - subBucketBits); ///< Всего корзин до 2^64
+
+    /**
+     * @brief Номер корзины значения
+     */
+    static size_t bucketIndex(uint64_t value)
+    {
+        if (value < 2 * subBucketCount) {
+            return static_cast<size_t>(value);
+        }
+        unsigned shift = 63 - __builtin_clzll(value) - subBucketBits;
+        return subBucketCount * shift + static_cast<size_t>(value >> shift);
+    }
+
+    /**
+     * @brief Наименьшее значение корзины
+     */
+    static uint64_t bucketLow(size_t index);
+
+    /**
+     * @brief Наибольшее значение корзины
+     */
+    static uint64_t bucketHigh(size_t index);
+
+    /**
+     * @brief Запись значения
+     * @param [in] value Значение (наносекунды)
+     * @param [in] times Сколько раз записать
+     */
+    void record(uint64_t value, uint64_t times = 1);
+
+    /**
+     * @brief Добавление корзины другой гистограммы
+     * @param [in] index Номер корзины
+     * @param [in] times Количество значений в корзине
+     */
+    void addBucket(size_t index, uint64_t times);
+
+    /**
+     * @brief Сложение с другой гистограммой
+     */
+    void merge(const LatencyHistogram& other);
+
+    /**
+     * @brief Очистка
+     */
+    void reset();
+
+    uint64_t count() const { return total; } ///< Количество значений
+    uint64_t min() const { return total > 0 ? minValue : 0; } ///< Наименьшее значение
+    uint64_t max() const { return maxValue; } ///< Наибольшее значение
+
+    /**
+     * @brief Среднее значение по серединам корзин
+     */
+    double mean() const;
+
+    /**
+     * @brief Значение перцентиля
+     * @param [in] percentile Перцентиль от 0 до 100
+     * @return Верхняя граница корзины, в которую попал перцентиль (не больше max)
+     */
+    uint64_t percentile(double percentile) const;
+
+    /**
+     * @brief Распределение перцентилей для построения графика
+     * @return Строки "значение перцентиль количество", по корзинам,
+     *         в которых есть значения
+     */
+    std::string percentileDistribution() const;
+
+private:
+    std::array<uint64_t, bucketCount> counts{}; ///< Счётчики корзин
+    uint64_t total = 0; ///< Количество значений
+    uint64_t minValue = UINT64_MAX; ///< Наименьшее значение
+    uint64_t maxValue = 0; ///< Наибольшее значение
+};
+
+/**
+ * @brief Измеряемая операция
+ */
+enum class LatencyOp : uint8_t {
+    GronsfeldEncrypt = 0, ///< modAlphaCipher::encrypt
+    GronsfeldDecrypt = 1, ///< modAlphaCipher::decrypt
+    GronsfeldBulk = 2,    ///< modAlphaCipher::encryptBulk и decryptBulk (память из арены)
+    RouteEncrypt = 3,     ///< RouteCipher::Encrypt
+    RouteDecrypt = 4,     ///< RouteCipher::Decrypt
+    RouteBulk = 5         ///< RouteCipher::EncryptBulk и DecryptBulk (память из арены)
+};
+
+/**
+ * @brief Запись задержек по потокам
+ * @details Гистограммы потока создаются при первой записи в пару
+ *          (операция, класс размера). При завершении потока его
+ *          гистограммы переносятся в общий итог, так что снимок после
+ *          join учитывает все вызовы.
+ */
+class LatencyRecorder
+{
+public:
+    static const size_t opCount = 6; ///< Количество операций
+    static const size_t sizeClassCount = 8; ///< Классов размера: <1K, <4K, ..., <4M, от 4M
+
+    /**
+     * @brief Включение или выключение записи
+     * @details Выключенная запись стоит одного чтения флага на вызов
+     */
+    static void enable(bool on = true) { active.store(on, std::memory_order_relaxed); }
+
+    /**
+     * @brief Включена ли запись
+     */
+    static bool enabled() { return active.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Класс размера входа
+     * @param [in] bytes Размер входа в байтах
+     * @return Номер класса: границы растут вчетверо начиная с 1 КиБ
+     */
+    static size_t sizeClass(size_t bytes);
+
+    /**
+     * @brief Название класса размера
+     */
+    static const char* sizeClassName(size_t sizeClass);
+
+    /**
+     * @brief Название операции
+     */
+    static const char* opName(LatencyOp op);
+
+    /**
+     * @brief Запись задержки в гистограмму текущего потока
+     * @param [in] op Операция
+     * @param [in] bytes Размер входа в байтах
+     * @param [in] nanoseconds Задержка
+     */
+    static void record(LatencyOp op, size_t bytes, uint64_t nanoseconds);
+
+    /**
+     * @brief Снимок гистограммы, сложенной по всем потокам
+     * @param [in] op Операция
+     * @param [in] sizeClass Класс размера
+     */
+    static LatencyHistogram snapshot(LatencyOp op, size_t sizeClass);
+
+    /**
+     * @brief Снимок по всем классам размера операции
+     */
+    static LatencyHistogram snapshot(LatencyOp op);
+
+    /**
+     * @brief Таблица перцентилей
+     * @return По строке на непустую пару (операция, класс размера):
+     *         количество, среднее, p50, p90, p99, p99.9, p99.99 и max в мкс
+     */
+    static std::string report();
+
+    /**
+     * @brief Очистка всех гистограмм
+     * @details Выполнять, когда шифры не вызываются: запись,
+     *          идущая одновременно с очисткой, может частично уцелеть
+     */
+    static void reset();
+
+private:
+    static inline std::atomic<bool> active{false}; ///< Запись включена
+};
+
+/**
+ * @brief Замер задержки области видимости
+ * @details Время читается, только если запись включена при создании
+ */
+class LatencyTimer
+{
+private:
+    LatencyOp op; ///< Операция
+    size_t bytes; ///< Размер входа
+    bool running; ///< Замер идёт
+    std::chrono::steady_clock::time_point start; ///< Начало замера
+
+public:
+    LatencyTimer(LatencyOp timedOp, size_t inputBytes)
+        : op(timedOp), bytes(inputBytes), running(LatencyRecorder::enabled())
+    {
+        if (running) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    LatencyTimer(const LatencyTimer&) = delete;
+    LatencyTimer& operator=(const LatencyTimer&) = delete;
+
+    ~LatencyTimer()
+    {
+        if (running) {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            LatencyRecorder::record(op, bytes, static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+    }
+};
+
+#endif // LATENCYHISTOGRAM_H
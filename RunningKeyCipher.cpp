@@ -0,0 +1,268 @@
+/**
+ * @file RunningKeyCipher.cpp
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Реализация шифра с бегущим ключом из файла
+ * @copyright ИБСТ ПГУ
+ */
+
+#include "RunningKeyCipher.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+using namespace std;
+
+namespace {
+
+const size_t pageSize = 4096; ///< Размер страницы для madvise
+
+/**
+ * @brief Перевод строчной буквы UTF-8 в заглавную
+ * @details Ключом обычно служит обычный текст, где большинство букв
+ *          строчные; таблица декодирования знает только заглавные.
+ *          а-п (D0 B0-BF) -> А-П, р-я (D1 80-8F) -> Р-Я, ё (D1 91) -> Ё.
+ */
+void toUpperPair(unsigned char& lead, unsigned char& trail)
+{
+    if (lead == 0xD0 && trail >= 0xB0 && trail <= 0xBF) {
+        trail -= 0x20;
+    } else if (lead == 0xD1 && trail >= 0x80 && trail <= 0x8F) {
+        lead = 0xD0;
+        trail += 0x20;
+    } else if (lead == 0xD1 && trail == 0x91) {
+        lead = 0xD0;
+        trail = 0x81;
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Конструктор
+ * @param [in] keyPath Путь к файлу ключа
+ * @param [in] offset Смещение в файле в байтах
+ * @param [in] textMode Режим обработки символов вне алфавита в тексте
+ */
+RunningKeyCipher::RunningKeyCipher(const string& keyPath, uint64_t offset, TextMode textMode)
+    : alphabet("А", textMode)
+{
+    int fd = open(keyPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw cipher_error("Cannot open key file: " + keyPath + ": " + strerror(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int err = errno;
+        close(fd);
+        throw cipher_error("Cannot stat key file: " + keyPath + ": " + strerror(err));
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        throw cipher_error("Empty key file: " + keyPath);
+    }
+
+    keySize = static_cast<size_t>(st.st_size);
+    void* p = mmap(nullptr, keySize, PROT_READ, MAP_PRIVATE, fd, 0);
+    int err = errno;
+    close(fd);
+    if (p == MAP_FAILED) {
+        throw cipher_error("Cannot map key file: " + keyPath + ": " + strerror(err));
+    }
+    keyData = static_cast<const char*>(p);
+    madvise(p, keySize, MADV_SEQUENTIAL);
+
+    try {
+        seek(offset);
+    } catch (...) {
+        munmap(p, keySize);
+        throw;
+    }
+}
+
+/**
+ * @brief Закрытие отображения файла
+ */
+RunningKeyCipher::~RunningKeyCipher()
+{
+    munmap(const_cast<char*>(keyData), keySize);
+}
+
+/**
+ * @brief Позиция в файле ключа
+ */
+uint64_t RunningKeyCipher::position() const
+{
+    return shiftNext > 0 ? ends[shiftNext - 1] : startPos;
+}
+
+/**
+ * @brief Переход к позиции в файле ключа
+ * @param [in] offset Смещение в байтах
+ */
+void RunningKeyCipher::seek(uint64_t offset)
+{
+    if (offset > keySize) {
+        throw cipher_error("Key offset beyond end of key file");
+    }
+    size_t pos = static_cast<size_t>(offset);
+    while (pos < keySize && (static_cast<unsigned char>(keyData[pos]) & 0xC0) == 0x80) {
+        ++pos;
+    }
+    startPos = pos;
+    scanPos = pos;
+    shiftCount = 0;
+    shiftNext = 0;
+    // Отпущенные страницы при обращении заново читаются из файла
+    released = min(released, pos / pageSize * pageSize);
+}
+
+/**
+ * @brief Декодирование следующей порции ключа
+ * @details Символы файла вне алфавита пропускаются. Когда использованная
+ *          часть файла вырастает на releaseStep, её страницы отпускаются,
+ *          чтобы резидентная память не зависела от длины ключа.
+ */
+void RunningKeyCipher::refill()
+{
+    startPos = shiftCount > 0 ? ends[shiftCount - 1] : startPos;
+    shiftCount = 0;
+    shiftNext = 0;
+
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(keyData);
+    size_t pos = scanPos;
+    while (shiftCount < bufferLetters && pos < keySize) {
+        unsigned char lead = data[pos];
+        if (lead < 0x80) {
+            ++pos;
+            continue;
+        }
+        if (pos + 1 >= keySize) {
+            pos = keySize;
+            break;
+        }
+        unsigned char trail = data[pos + 1];
+        toUpperPair(lead, trail);
+        int idx = alphabet.decodeLetter(lead, trail);
+        if (idx < 0) {
+            ++pos;
+            continue;
+        }
+        pos += 2;
+        shifts[shiftCount] = static_cast<uint8_t>(idx);
+        ends[shiftCount] = pos;
+        ++shiftCount;
+    }
+    scanPos = pos;
+
+    if (startPos - released >= releaseStep) {
+        size_t upto = startPos / pageSize * pageSize;
+        madvise(const_cast<char*>(keyData) + released, upto - released, MADV_DONTNEED);
+        released = upto;
+    }
+    if (shiftCount == 0) {
+        throw cipher_error("Running key exhausted");
+    }
+}
+
+/**
+ * @brief Сдвиг текста бегущим ключом
+ * @param [in] text Текст
+ * @param [in] decrypting true для дешифрования
+ * @return Результат
+ */
+string RunningKeyCipher::transform(const string& text, bool decrypting)
+{
+    const int alphabetSize = static_cast<int>(alphabet.numAlpha.size() / 2);
+    const string& numAlpha = alphabet.numAlpha;
+    const char* in = text.data();
+    size_t size = text.size();
+    uint64_t start = position();
+
+    string result(size, '\0');
+    size_t written = 0;
+    try {
+        if (alphabet.mode == TextMode::PassThrough) {
+            memcpy(&result[0], in, size);
+            written = size;
+            size_t i = alphabet.findLead(in, 0, size);
+            while (i + 1 < size) {
+                int idx = alphabet.decodeLetter(static_cast<unsigned char>(in[i]),
+                                                static_cast<unsigned char>(in[i + 1]));
+                if (idx < 0) {
+                    i = alphabet.findLead(in, i + 1, size);
+                    continue;
+                }
+                int shift = nextShift();
+                idx += decrypting ? alphabetSize - shift : shift;
+                if (idx >= alphabetSize) {
+                    idx -= alphabetSize;
+                }
+                result[i] = numAlpha[idx * 2];
+                result[i + 1] = numAlpha[idx * 2 + 1];
+                i = alphabet.findLead(in, i + 2, size);
+            }
+        } else {
+            size_t i = 0;
+            while (i < size) {
+                if (in[i] == ' ') {
+                    ++i;
+                    continue;
+                }
+                if (i + 1 >= size) {
+                    throw cipher_error("Invalid character sequence in input");
+                }
+                int idx = alphabet.decodeLetter(static_cast<unsigned char>(in[i]),
+                                                static_cast<unsigned char>(in[i + 1]));
+                if (idx < 0) {
+                    throw cipher_error("Invalid character in input (not a Russian uppercase letter)");
+                }
+                int shift = nextShift();
+                idx += decrypting ? alphabetSize - shift : shift;
+                if (idx >= alphabetSize) {
+                    idx -= alphabetSize;
+                }
+                result[written++] = numAlpha[idx * 2];
+                result[written++] = numAlpha[idx * 2 + 1];
+                i += 2;
+            }
+        }
+    } catch (...) {
+        seek(start);
+        throw;
+    }
+    result.resize(written);
+    return result;
+}
+
+/**
+ * @brief Шифрование открытого текста
+ * @param [in] open_text Открытый текст
+ * @return Зашифрованный текст
+ */
+string RunningKeyCipher::encrypt(const string& open_text)
+{
+    string result = transform(open_text, false);
+    if (result.empty()) {
+        throw cipher_error("Empty open text");
+    }
+    return result;
+}
+
+/**
+ * @brief Дешифрование шифротекста
+ * @param [in] cipher_text Зашифрованный текст
+ * @return Расшифрованный текст
+ */
+string RunningKeyCipher::decrypt(const string& cipher_text)
+{
+    string result = transform(cipher_text, true);
+    if (result.empty()) {
+        throw cipher_error("Empty cipher text");
+    }
+    return result;
+}
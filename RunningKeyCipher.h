@@ -0,0 +1,138 @@
+/**
+ * @file RunningKeyCipher.h
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Шифр Гронсфельда с бегущим ключом из файла
+ * @copyright ИБСТ ПГУ
+ */
+
+#ifndef RUNNINGKEYCIPHER_H
+#define RUNNINGKEYCIPHER_H
+
+#include "modAlphaCipher.h"
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Шифр Гронсфельда с ключом длиной в сообщение
+ * @details Ключ - текст файла в UTF-8 (например, книга или заранее
+ *          сгенерированный блокнот). Буквами ключа служат буквы русского
+ *          алфавита, все остальные символы файла пропускаются. Каждая
+ *          буква сообщения сдвигается на очередную букву ключа, ключ не
+ *          повторяется.
+ *
+ * Файл отображается в память целиком, но декодируется лениво, порциями
+ * по мере шифрования, через ту же таблицу декодирования, что и
+ * modAlphaCipher. Уже использованная часть отображения отпускается
+ * (madvise MADV_DONTNEED), поэтому резидентная память не растёт с длиной
+ * ключа даже для файлов в несколько гигабайт.
+ *
+ * Шифрование продвигает позицию в ключе: последовательные вызовы
+ * продолжают ключ с места, где остановился предыдущий, как потоковый
+ * шифр. Для дешифрования нужна та же начальная позиция (seek).
+ */
+class RunningKeyCipher
+{
+private:
+    static const size_t bufferLetters = 4096; ///< Размер порции декодированного ключа
+    static const size_t releaseStep = 64 << 20; ///< Шаг отпускания использованной части файла
+
+    modAlphaCipher alphabet; ///< Таблицы алфавита и режим обработки текста
+    const char* keyData = nullptr; ///< Отображение файла ключа
+    size_t keySize = 0; ///< Размер файла ключа
+    size_t scanPos = 0; ///< Позиция в файле, с которой декодируется следующая порция
+    size_t startPos = 0; ///< Позиция в файле перед первой буквой порции
+    size_t released = 0; ///< Размер отпущенного начала файла
+
+    uint8_t shifts[bufferLetters]; ///< Порция декодированных сдвигов
+    size_t ends[bufferLetters]; ///< Позиция в файле после каждой буквы порции
+    size_t shiftCount = 0; ///< Количество сдвигов в порции
+    size_t shiftNext = 0; ///< Следующий неиспользованный сдвиг
+
+    /**
+     * @brief Декодирование следующей порции ключа
+     * @throw cipher_error если ключ закончился
+     */
+    void refill();
+
+    /**
+     * @brief Очередной сдвиг ключа
+     * @throw cipher_error если ключ закончился
+     */
+    int nextShift()
+    {
+        if (shiftNext == shiftCount) {
+            refill();
+        }
+        return shifts[shiftNext++];
+    }
+
+    /**
+     * @brief Сдвиг текста бегущим ключом
+     * @param [in] text Текст
+     * @param [in] decrypting true для дешифрования
+     * @return Результат; при исключении позиция в ключе не меняется
+     */
+    std::string transform(const std::string& text, bool decrypting);
+
+public:
+    RunningKeyCipher() = delete; ///< Конструктор по умолчанию запрещен
+    RunningKeyCipher(const RunningKeyCipher&) = delete; ///< Копирование запрещено
+    RunningKeyCipher& operator=(const RunningKeyCipher&) = delete; ///< Присваивание запрещено
+
+    /**
+     * @brief Конструктор
+     * @param [in] keyPath Путь к файлу ключа
+     * @param [in] offset Смещение в файле в байтах, с которого начинается ключ
+     * @param [in] textMode Режим обработки символов вне алфавита в тексте
+     * @throw cipher_error если файл не открывается, пуст или смещение за концом файла
+     */
+    explicit RunningKeyCipher(const std::string& keyPath, uint64_t offset = 0,
+                              TextMode textMode = TextMode::Strict);
+
+    /**
+     * @brief Закрытие отображения файла
+     */
+    ~RunningKeyCipher();
+
+    /**
+     * @brief Шифрование открытого текста
+     * @param [in] open_text Открытый текст
+     * @return Зашифрованный текст
+     * @throw cipher_error если текст пуст, содержит недопустимые символы
+     *        или ключ закончился
+     */
+    std::string encrypt(const std::string& open_text);
+
+    /**
+     * @brief Дешифрование шифротекста
+     * @param [in] cipher_text Зашифрованный текст
+     * @return Расшифрованный текст
+     * @throw cipher_error если текст пуст, содержит недопустимые символы
+     *        или ключ закончился
+     */
+    std::string decrypt(const std::string& cipher_text);
+
+    /**
+     * @brief Позиция в файле ключа
+     * @return Смещение в байтах сразу после последней использованной буквы ключа
+     */
+    uint64_t position() const;
+
+    /**
+     * @brief Переход к позиции в файле ключа
+     * @param [in] offset Смещение в байтах; если оно попадает внутрь
+     *             символа UTF-8, ключ начинается со следующего символа
+     * @throw cipher_error если смещение за концом файла
+     */
+    void seek(uint64_t offset);
+
+    /**
+     * @brief Размер файла ключа в байтах
+     */
+    uint64_t keyFileSize() const { return keySize; }
+};
+
+#endif // RUNNINGKEYCIPHER_H
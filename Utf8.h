@@ -0,0 +1,80 @@
+/**
+ * @file Utf8.h
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Преобразование между UTF-8 и широкими строками
+ * @copyright ИБСТ ПГУ
+ * @details Шифр Гронсфельда работает с UTF-8, а шифр маршрутной
+ *          перестановки - с std::wstring. Функции используются модулями,
+ *          которые передают текст между ними и через файлы или сокеты.
+ */
+
+#ifndef UTF8_H
+#define UTF8_H
+
+#include <string>
+#include <cstdint>
+
+/**
+ * @brief Преобразование UTF-8 в широкую строку
+ * @param [in] s Текст в UTF-8
+ * @param [out] out Результат
+ * @return false, если последовательность байтов некорректна
+ */
+inline bool utf8ToWide(const std::string& s, std::wstring& out)
+{
+    out.clear();
+    out.reserve(s.size());
+    size_t i = 0;
+    while (i < s.size()) {
+        unsigned char c = static_cast<unsigned char>(s[i]);
+        size_t len = c < 0x80 ? 1 : (c & 0xE0) == 0xC0 ? 2 : (c & 0xF0) == 0xE0 ? 3 : (c & 0xF8) == 0xF0 ? 4 : 0;
+        if (len == 0 || i + len > s.size()) {
+            return false;
+        }
+        uint32_t cp = len == 1 ? c : c & (0xFF >> (len + 1));
+        for (size_t k = 1; k < len; ++k) {
+            unsigned char t = static_cast<unsigned char>(s[i + k]);
+            if ((t & 0xC0) != 0x80) {
+                return false;
+            }
+            cp = (cp << 6) | (t & 0x3F);
+        }
+        out += static_cast<wchar_t>(cp);
+        i += len;
+    }
+    return true;
+}
+
+/**
+ * @brief Преобразование широкой строки в UTF-8
+ * @param [in] s Широкая строка
+ * @return Текст в UTF-8
+ */
+inline std::string wideToUtf8(const std::wstring& s)
+{
+    std::string result;
+    result.reserve(s.size() * 2);
+    for (wchar_t wc : s) {
+        uint32_t cp = static_cast<uint32_t>(wc);
+        if (cp < 0x80) {
+            result += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            result += static_cast<char>(0xC0 | (cp >> 6));
+            result += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            result += static_cast<char>(0xE0 | (cp >> 12));
+            result += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            result += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            result += static_cast<char>(0xF0 | (cp >> 18));
+            result += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            result += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            result += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+    return result;
+}
+
+#endif // UTF8_H
@@ -0,0 +1,163 @@
+/**
+ * @file cipherbatch.cpp
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Пакетное шифрование каталога
+ * @copyright ИБСТ ПГУ
+ * @details Шифрует или дешифрует все файлы входного каталога с
+ *          подкаталогами и складывает результаты в выходной каталог
+ *          с той же структурой.
+ *
+ * Использование:
+ *   cipherbatch (-g КЛЮЧ | -r СТОЛБЦЫ) [-d] [-p] [-t N] [--chunk РАЗМЕР]
+ *               [--frame-rows N] [--no-sync] ВХОД ВЫХОД
+ *
+ * -g - шифр Гронсфельда с ключом (UTF-8), -r - маршрутная перестановка
+ * в кадровом режиме, -d - дешифрование, -p - режим PassThrough шифра
+ * Гронсфельда, -t - количество потоков (по умолчанию по числу ядер).
+ * Размер задачи задаётся в байтах с необязательным суффиксом K или M.
+ *
+ * Сборка:
+ *   g++ -std=c++17 -O2 -pthread cipherbatch.cpp ../BatchProcessor.cpp ../modAlphaCipher.cpp
+ *       ../BufferArena.cpp ../LatencyHistogram.cpp ../2/RouteCipher.cpp ../2/RoutePatterns.cpp
+ *       ../2/RouteKernels.cpp -o cipherbatch
+ */
+
+#include "../BatchProcessor.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+/**
+ * @brief Параметры командной строки
+ */
+struct BatchArguments {
+    string gronsfeldKey; ///< Ключ шифра Гронсфельда
+    int columns = 0; ///< Столбцы шифра перестановки
+    bool passThrough = false; ///< Режим PassThrough
+    BatchOptions options; ///< Параметры обработки
+    string inputDir; ///< Входной каталог
+    string outputDir; ///< Выходной каталог
+};
+
+/**
+ * @brief Разбор размера с суффиксом K или M
+ * @return 0 если строка некорректна
+ */
+size_t parseSize(const string& text)
+{
+    char* end = nullptr;
+    unsigned long long value = strtoull(text.c_str(), &end, 10);
+    if (end == text.c_str()) {
+        return 0;
+    }
+    if (*end == 'K' || *end == 'k') {
+        value <<= 10;
+        ++end;
+    } else if (*end == 'M' || *end == 'm') {
+        value <<= 20;
+        ++end;
+    }
+    return *end == '\0' ? static_cast<size_t>(value) : 0;
+}
+
+/**
+ * @brief Разбор аргументов командной строки
+ * @return false если аргументы некорректны
+ */
+bool parseArguments(int argc, char** argv, BatchArguments& args)
+{
+    vector<string> dirs;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "-g" && i + 1 < argc) {
+            args.gronsfeldKey = argv[++i];
+        } else if (arg == "-r" && i + 1 < argc) {
+            args.columns = atoi(argv[++i]);
+            if (args.columns <= 0) {
+                return false;
+            }
+        } else if (arg == "-d") {
+            args.options.decrypting = true;
+        } else if (arg == "-p") {
+            args.passThrough = true;
+        } else if (arg == "-t" && i + 1 < argc) {
+            args.options.threads = static_cast<unsigned>(max(0, atoi(argv[++i])));
+        } else if (arg == "--chunk" && i + 1 < argc) {
+            args.options.chunkSize = parseSize(argv[++i]);
+            if (args.options.chunkSize == 0) {
+                return false;
+            }
+        } else if (arg == "--frame-rows" && i + 1 < argc) {
+            args.options.frameRows = strtoul(argv[++i], nullptr, 10);
+            if (args.options.frameRows == 0) {
+                return false;
+            }
+        } else if (arg == "--no-sync") {
+            args.options.sync = false;
+        } else if (!arg.empty() && arg[0] != '-') {
+            dirs.push_back(arg);
+        } else {
+            return false;
+        }
+    }
+    if (dirs.size() != 2 || args.gronsfeldKey.empty() == (args.columns == 0)) {
+        return false;
+    }
+    args.inputDir = dirs[0];
+    args.outputDir = dirs[1];
+    return true;
+}
+
+} // namespace
+
+/**
+ * @brief Главная функция пакетного шифрования
+ * @param argc Количество аргументов командной строки
+ * @param argv Массив аргументов командной строки
+ * @return Код завершения программы (0 - все файлы обработаны, 1 - были ошибки)
+ */
+int main(int argc, char** argv)
+{
+    BatchArguments args;
+    if (!parseArguments(argc, argv, args)) {
+        cerr << "Использование: " << argv[0] << " (-g КЛЮЧ | -r СТОЛБЦЫ) [-d] [-p] [-t N] [--chunk РАЗМЕР[K|M]]"
+             << " [--frame-rows N] [--no-sync] ВХОД ВЫХОД" << endl;
+        return 2;
+    }
+
+    try {
+        unique_ptr<modAlphaCipher> gronsfeld;
+        unique_ptr<BatchProcessor> processor;
+        if (!args.gronsfeldKey.empty()) {
+            gronsfeld.reset(new modAlphaCipher(args.gronsfeldKey,
+                                               args.passThrough ? TextMode::PassThrough : TextMode::Strict));
+            processor.reset(new BatchProcessor(*gronsfeld, args.options));
+        } else {
+            processor.reset(new BatchProcessor(RouteCipher(args.columns), args.options));
+        }
+
+        BatchReport report = processor->run(args.inputDir, args.outputDir);
+        for (const string& error : report.errors) {
+            cerr << "Ошибка: " << error << endl;
+        }
+        cout << "Файлов: " << report.files << " (с ошибкой: " << report.failedFiles << ")" << endl;
+        cout << "Прочитано байт: " << report.bytesIn << endl;
+        cout << "Записано байт: " << report.bytesOut << endl;
+        cout << "Потоков: " << report.threads << endl;
+        cout << "Задач: " << report.tasks << " (украдено: " << report.steals << ")" << endl;
+        cout << "Время, с: " << report.seconds << endl;
+        cout << "Скорость, МиБ/с: " << report.throughput() << endl;
+        return report.failedFiles > 0 ? 1 : 0;
+    } catch (const exception& e) {
+        cerr << "Ошибка: " << e.what() << endl;
+        return 1;
+    }
+}
@@ -0,0 +1,425 @@
+/**
+ * @file BenchResults.cpp
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Реализация сохранения результатов замеров в JSON
+ * @copyright ИБСТ ПГУ
+ */
+
+#include "BenchResults.h"
+#include <sys/utsname.h>
+#include <cctype>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <map>
+#include <sstream>
+
+using namespace std;
+
+namespace {
+
+/**
+ * @brief Значение JSON
+ * @details Достаточно для чтения собственного формата: числа хранятся
+ *          как double, объекты - как упорядоченный словарь
+ */
+struct JsonValue {
+    enum Kind { Null, Bool, Number, String, Array, Object } kind = Null; ///< Тип значения
+    bool boolean = false; ///< Значение Bool
+    double number = 0; ///< Значение Number
+    string text; ///< Значение String
+    vector<JsonValue> items; ///< Элементы Array
+    map<string, JsonValue> fields; ///< Поля Object
+
+    /**
+     * @brief Поле объекта
+     * @throw bench_error если поля нет
+     */
+    const JsonValue& at(const string& key) const
+    {
+        auto it = fields.find(key);
+        if (kind != Object || it == fields.end()) {
+            throw bench_error("Missing field '" + key + "'");
+        }
+        return it->second;
+    }
+};
+
+/**
+ * @brief Рекурсивный разбор JSON
+ */
+class JsonParser
+{
+private:
+    const string& src; ///< Текст
+    size_t pos = 0; ///< Текущая позиция
+
+    /**
+     * @brief Пропуск пробельных символов
+     */
+    void skipSpace()
+    {
+        while (pos < src.size() && isspace(static_cast<unsigned char>(src[pos]))) {
+            ++pos;
+        }
+    }
+
+    /**
+     * @brief Ошибка разбора с позицией
+     * @throw bench_error всегда
+     */
+    [[noreturn]] void fail(const string& what) const
+    {
+        throw bench_error("JSON error at offset " + to_string(pos) + ": " + what);
+    }
+
+    /**
+     * @brief Проверка и пропуск ожидаемого символа
+     */
+    void expect(char c)
+    {
+        skipSpace();
+        if (pos >= src.size() || src[pos] != c) {
+            fail(string("expected '") + c + "'");
+        }
+        ++pos;
+    }
+
+    /**
+     * @brief Пропуск слова, если текст продолжается им
+     */
+    bool literal(const char* word)
+    {
+        size_t n = char_traits<char>::length(word);
+        if (src.compare(pos, n, word) == 0) {
+            pos += n;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Разбор строки с экранированием
+     */
+    string parseString()
+    {
+        expect('"');
+        string out;
+        while (pos < src.size() && src[pos] != '"') {
+            char c = src[pos++];
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos >= src.size()) {
+                fail("unterminated escape");
+            }
+            c = src[pos++];
+            switch (c) {
+            case 'n': out += '\n'; break;
+            case 't': out += '\t'; break;
+            case 'r': out += '\r'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'u': {
+                if (pos + 4 > src.size()) {
+                    fail("short \\u escape");
+                }
+                unsigned code = static_cast<unsigned>(stoul(src.substr(pos, 4), nullptr, 16));
+                pos += 4;
+                // Суррогатные пары в собственном формате не встречаются
+                if (code < 0x80) {
+                    out += static_cast<char>(code);
+                } else if (code < 0x800) {
+                    out += static_cast<char>(0xC0 | (code >> 6));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                } else {
+                    out += static_cast<char>(0xE0 | (code >> 12));
+                    out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                }
+                break;
+            }
+            default: out += c; break;
+            }
+        }
+        expect('"');
+        return out;
+    }
+
+public:
+    /**
+     * @brief Конструктор
+     * @param [in] text Текст JSON; должен жить дольше парсера
+     */
+    explicit JsonParser(const string& text) : src(text) {}
+
+    /**
+     * @brief Разбор значения с текущей позиции
+     */
+    JsonValue parse()
+    {
+        JsonValue value;
+        skipSpace();
+        if (pos >= src.size()) {
+            fail("unexpected end");
+        }
+        char c = src[pos];
+        if (c == '{') {
+            value.kind = JsonValue::Object;
+            ++pos;
+            skipSpace();
+            if (pos < src.size() && src[pos] == '}') {
+                ++pos;
+                return value;
+            }
+            do {
+                string key = parseString();
+                expect(':');
+                value.fields[key] = parse();
+                skipSpace();
+            } while (pos < src.size() && src[pos] == ',' && ++pos);
+            expect('}');
+        } else if (c == '[') {
+            value.kind = JsonValue::Array;
+            ++pos;
+            skipSpace();
+            if (pos < src.size() && src[pos] == ']') {
+                ++pos;
+                return value;
+            }
+            do {
+                value.items.push_back(parse());
+                skipSpace();
+            } while (pos < src.size() && src[pos] == ',' && ++pos);
+            expect(']');
+        } else if (c == '"') {
+            value.kind = JsonValue::String;
+            value.text = parseString();
+        } else if (literal("true")) {
+            value.kind = JsonValue::Bool;
+            value.boolean = true;
+        } else if (literal("false")) {
+            value.kind = JsonValue::Bool;
+        } else if (literal("null")) {
+            value.kind = JsonValue::Null;
+        } else {
+            size_t used = 0;
+            try {
+                value.number = stod(src.substr(pos, 32), &used);
+            } catch (const exception&) {
+                fail("invalid value");
+            }
+            value.kind = JsonValue::Number;
+            pos += used;
+        }
+        return value;
+    }
+
+    /**
+     * @brief Проверка, что после значения ничего нет
+     */
+    void finish()
+    {
+        skipSpace();
+        if (pos != src.size()) {
+            fail("trailing data");
+        }
+    }
+};
+
+/**
+ * @brief Строка JSON с экранированием
+ */
+string quote(const string& text)
+{
+    ostringstream out;
+    out << '"';
+    for (unsigned char c : text) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (c < 0x20) {
+            out << "\\u" << hex << setw(4) << setfill('0') << static_cast<int>(c) << dec;
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+    return out.str();
+}
+
+/**
+ * @brief Модель процессора из /proc/cpuinfo
+ */
+string cpuModel()
+{
+    ifstream info("/proc/cpuinfo");
+    string line;
+    while (getline(info, line)) {
+        if (line.compare(0, 10, "model name") == 0 || line.compare(0, 9, "Processor") == 0) {
+            size_t value = line.find_first_not_of(" \t", line.find(':') + 1);
+            if (line.find(':') != string::npos && value != string::npos) {
+                return line.substr(value);
+            }
+        }
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Флаги сборки из BENCH_FLAGS или догадка по предопределённым макросам
+ */
+string buildFlags()
+{
+#ifdef BENCH_FLAGS
+    return BENCH_FLAGS;
+#else
+    string flags = "guessed:";
+#ifdef __OPTIMIZE__
+    flags += " optimized";
+#else
+    flags += " unoptimized";
+#endif
+#ifdef NDEBUG
+    flags += " NDEBUG";
+#endif
+#ifdef __SSE4_2__
+    flags += " sse4.2";
+#endif
+#ifdef __AVX2__
+    flags += " avx2";
+#endif
+#ifdef __AVX512F__
+    flags += " avx512f";
+#endif
+    return flags;
+#endif
+}
+
+} // namespace
+
+/**
+ * @brief Окружение текущего процесса
+ */
+BenchEnvironment currentEnvironment()
+{
+    BenchEnvironment environment;
+    environment.cpu = cpuModel();
+#if defined(__clang__)
+    environment.compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+    environment.compiler = "gcc " __VERSION__;
+#else
+    environment.compiler = "unknown";
+#endif
+    environment.flags = buildFlags();
+
+    utsname names;
+    if (uname(&names) == 0) {
+        environment.kernel = string(names.sysname) + " " + names.release;
+        environment.host = names.nodename;
+    }
+
+    time_t now = time(nullptr);
+    tm utc;
+    char stamp[32];
+    if (gmtime_r(&now, &utc) != nullptr && strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", &utc) > 0) {
+        environment.date = stamp;
+    }
+    return environment;
+}
+
+/**
+ * @brief Запись результатов в JSON
+ */
+void writeResults(ostream& out, const BenchEnvironment& environment, const vector<CaseResult>& results)
+{
+    out << "{\n  \"format\": \"lb4-bench\",\n  \"version\": 1,\n";
+    out << "  \"environment\": {"
+        << "\"cpu\": " << quote(environment.cpu)
+        << ", \"compiler\": " << quote(environment.compiler)
+        << ", \"flags\": " << quote(environment.flags)
+        << ", \"kernel\": " << quote(environment.kernel)
+        << ", \"host\": " << quote(environment.host)
+        << ", \"date\": " << quote(environment.date) << "},\n";
+    out << "  \"cases\": [";
+    out << setprecision(9);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const CaseResult& result = results[i];
+        out << (i == 0 ? "\n" : ",\n");
+        out << "    {\"name\": " << quote(result.name) << ", \"bytes\": " << result.bytes
+            << ", \"calls\": " << result.calls << ", \"seconds\": [";
+        for (size_t r = 0; r < result.seconds.size(); ++r) {
+            out << (r == 0 ? "" : ", ") << result.seconds[r];
+        }
+        out << "], \"faults\": " << result.pageFaults << ", \"counters\": {";
+        bool first = true;
+        for (size_t e = 0; e < perfEventCount && result.hasCounters; ++e) {
+            if (result.counters.valid[e]) {
+                out << (first ? "" : ", ") << quote(PerfCounters::name(static_cast<PerfEvent>(e)))
+                    << ": " << result.counters.value[e];
+                first = false;
+            }
+        }
+        out << "}}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+/**
+ * @brief Чтение результатов из JSON
+ */
+vector<CaseResult> readResults(istream& in, BenchEnvironment& environment)
+{
+    string text((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    JsonParser parser(text);
+    JsonValue root = parser.parse();
+    parser.finish();
+
+    if (root.at("format").text != "lb4-bench" || root.at("version").number != 1) {
+        throw bench_error("Not a cipherbench result file");
+    }
+
+    const JsonValue& env = root.at("environment");
+    environment.cpu = env.at("cpu").text;
+    environment.compiler = env.at("compiler").text;
+    environment.flags = env.at("flags").text;
+    environment.kernel = env.at("kernel").text;
+    environment.host = env.at("host").text;
+    environment.date = env.at("date").text;
+
+    vector<CaseResult> results;
+    for (const JsonValue& item : root.at("cases").items) {
+        CaseResult result;
+        result.name = item.at("name").text;
+        result.bytes = static_cast<size_t>(item.at("bytes").number);
+        for (const JsonValue& seconds : item.at("seconds").items) {
+            result.seconds.push_back(seconds.number);
+        }
+        auto calls = item.fields.find("calls");
+        if (calls != item.fields.end() && calls->second.number >= 1) {
+            result.calls = static_cast<uint64_t>(calls->second.number);
+        }
+        auto faults = item.fields.find("faults");
+        if (faults != item.fields.end()) {
+            result.pageFaults = static_cast<long>(faults->second.number);
+        }
+        const JsonValue& counters = item.at("counters");
+        for (size_t e = 0; e < perfEventCount; ++e) {
+            auto it = counters.fields.find(PerfCounters::name(static_cast<PerfEvent>(e)));
+            if (it != counters.fields.end()) {
+                result.counters.value[e] = static_cast<uint64_t>(it->second.number);
+                result.counters.valid[e] = true;
+                result.hasCounters = true;
+            }
+        }
+        if (result.name.empty() || result.seconds.empty()) {
+            throw bench_error("Case without name or samples");
+        }
+        results.push_back(result);
+    }
+    return results;
+}
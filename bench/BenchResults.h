@@ -0,0 +1,108 @@
+/**
+ * @file BenchResults.h
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Результаты замеров и их сохранение в JSON
+ * @copyright ИБСТ ПГУ
+ * @details Формат файла:
+ * @code
+ * {
+ *   "format": "lb4-bench", "version": 1,
+ *   "environment": {"cpu": "...", "compiler": "...", "flags": "...",
+ *                   "kernel": "...", "host": "...", "date": "..."},
+ *   "cases": [
+ *     {"name": "gronsfeld/encrypt", "bytes": 4096, "calls": 250, "seconds": [...],
+ *      "faults": 0, "counters": {"cycles": ..., "instructions": ...}}
+ *   ]
+ * }
+ * @endcode
+ * Замер повторяет вызов calls раз, seconds - среднее время одного вызова
+ * в каждом замере. Счётчики и ошибки страниц суммируются по всем вызовам
+ * всех замеров; недоступные счётчики не пишутся.
+ */
+
+#ifndef BENCHRESULTS_H
+#define BENCHRESULTS_H
+
+#include "PerfCounters.h"
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Класс исключений для ошибок чтения результатов
+ * @details Наследуется от std::runtime_error
+ */
+class bench_error : public std::runtime_error {
+public:
+    /**
+     * @brief Конструктор с строкой
+     * @param what_arg Сообщение об ошибке
+     */
+    explicit bench_error(const std::string& what_arg) : std::runtime_error(what_arg) {}
+
+    /**
+     * @brief Конструктор с C-строкой
+     * @param what_arg Сообщение об ошибке
+     */
+    explicit bench_error(const char* what_arg) : std::runtime_error(what_arg) {}
+};
+
+/**
+ * @brief Окружение, в котором сделаны замеры
+ */
+struct BenchEnvironment {
+    std::string cpu; ///< Модель процессора
+    std::string compiler; ///< Компилятор и версия
+    std::string flags; ///< Флаги сборки
+    std::string kernel; ///< Версия ядра
+    std::string host; ///< Имя машины
+    std::string date; ///< Дата и время замера (UTC, ISO 8601)
+};
+
+/**
+ * @brief Результат случая замера
+ */
+struct CaseResult {
+    std::string name; ///< Операция, например "gronsfeld/encrypt"
+    size_t bytes = 0; ///< Размер открытого текста в байтах
+    std::vector<double> seconds; ///< Время одного вызова в каждом замере
+    uint64_t calls = 1; ///< Вызовов в одном замере
+    PerfSample counters; ///< Сумма счётчиков по всем замерам
+    bool hasCounters = false; ///< Счётчики читались
+    long pageFaults = 0; ///< Сумма ошибок страниц по всем вызовам
+};
+
+/**
+ * @brief Окружение текущего процесса
+ * @details Флаги сборки берутся из макроса BENCH_FLAGS, который строка
+ *          сборки cipherbench задаёт равным CXXFLAGS. Без него строка
+ *          восстанавливается по предопределённым макросам компилятора и
+ *          начинается с "guessed:", чтобы benchcompare не выдавал догадку
+ *          за записанные флаги
+ */
+BenchEnvironment currentEnvironment();
+
+/**
+ * @brief Запись результатов в JSON
+ * @param [out] out Поток вывода
+ * @param [in] environment Окружение
+ * @param [in] results Результаты случаев
+ */
+void writeResults(std::ostream& out, const BenchEnvironment& environment,
+                  const std::vector<CaseResult>& results);
+
+/**
+ * @brief Чтение результатов из JSON
+ * @param [in] in Поток ввода
+ * @param [out] environment Окружение
+ * @return Результаты случаев
+ * @throw bench_error если файл не является результатом cipherbench
+ */
+std::vector<CaseResult> readResults(std::istream& in, BenchEnvironment& environment);
+
+#endif // BENCHRESULTS_H
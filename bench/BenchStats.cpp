@@ -0,0 +1,119 @@
+/**
+ * @file BenchStats.cpp
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Реализация критерия Манна-Уитни
+ * @copyright ИБСТ ПГУ
+ */
+
+#include "BenchStats.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+using namespace std;
+
+/**
+ * @brief Точное двустороннее p-значение для выборок без совпадений
+ * @details Количество перестановок с данным U считается динамическим
+ *          программированием по числу элементов каждой выборки
+ */
+double exactP(size_t n1, size_t n2, double u)
+{
+    size_t maxU = n1 * n2;
+    // counts[i][j][k] - число расстановок i и j элементов, при которых U = k
+    vector<vector<vector<double>>> counts(n1 + 1, vector<vector<double>>(n2 + 1));
+    for (size_t i = 0; i <= n1; ++i) {
+        for (size_t j = 0; j <= n2; ++j) {
+            counts[i][j].assign(i * j + 1, 0.0);
+            if (i == 0 || j == 0) {
+                counts[i][j][0] = 1;
+                continue;
+            }
+            // Наибольший элемент из первой выборки даёт j к U, из второй - 0
+            for (size_t k = 0; k <= i * j; ++k) {
+                double value = 0;
+                if (k >= j && k - j <= (i - 1) * j) {
+                    value += counts[i - 1][j][k - j];
+                }
+                if (k <= i * (j - 1)) {
+                    value += counts[i][j - 1][k];
+                }
+                counts[i][j][k] = value;
+            }
+        }
+    }
+
+    const vector<double>& dist = counts[n1][n2];
+    double total = 0;
+    for (double c : dist) {
+        total += c;
+    }
+    double tail = min(u, static_cast<double>(maxU) - u);
+    double below = 0;
+    for (size_t k = 0; k <= maxU && static_cast<double>(k) <= tail + 1e-9; ++k) {
+        below += dist[k];
+    }
+    return min(1.0, 2 * below / total);
+}
+
+/**
+ * @brief Критерий Манна-Уитни
+ * @param [in] a Первая выборка
+ * @param [in] b Вторая выборка
+ */
+MannWhitney mannWhitney(const vector<double>& a, const vector<double>& b)
+{
+    size_t n1 = a.size();
+    size_t n2 = b.size();
+    vector<pair<double, size_t>> all;
+    for (double x : a) {
+        all.push_back({x, 0});
+    }
+    for (double x : b) {
+        all.push_back({x, 1});
+    }
+    sort(all.begin(), all.end());
+
+    // Ранги со средним рангом для совпадающих значений
+    double rankSumA = 0;
+    double tieTerm = 0;
+    bool ties = false;
+    for (size_t i = 0; i < all.size();) {
+        size_t j = i;
+        while (j < all.size() && all[j].first == all[i].first) {
+            ++j;
+        }
+        double rank = (static_cast<double>(i + 1) + static_cast<double>(j)) / 2;
+        for (size_t k = i; k < j; ++k) {
+            if (all[k].second == 0) {
+                rankSumA += rank;
+            }
+        }
+        double t = static_cast<double>(j - i);
+        if (j - i > 1) {
+            ties = true;
+            tieTerm += t * t * t - t;
+        }
+        i = j;
+    }
+
+    MannWhitney result;
+    result.u = rankSumA - static_cast<double>(n1 * (n1 + 1)) / 2;
+    if (!ties && n1 <= 20 && n2 <= 20) {
+        result.p = exactP(n1, n2, result.u);
+        return result;
+    }
+
+    double n = static_cast<double>(n1 + n2);
+    double mean = static_cast<double>(n1 * n2) / 2;
+    double variance = static_cast<double>(n1 * n2) / 12 * ((n + 1) - tieTerm / (n * (n - 1)));
+    if (variance <= 0) {
+        result.p = 1;
+        return result;
+    }
+    double z = (fabs(result.u - mean) - 0.5) / sqrt(variance);
+    result.p = min(1.0, erfc(max(0.0, z) / sqrt(2.0)));
+    return result;
+}
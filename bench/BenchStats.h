@@ -0,0 +1,44 @@
+/**
+ * @file BenchStats.h
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Критерий Манна-Уитни для сравнения замеров
+ * @copyright ИБСТ ПГУ
+ * @details Для малых выборок без совпадающих значений p-значение
+ *          считается точно, иначе - нормальным приближением с поправками
+ *          на совпадения и непрерывность.
+ */
+
+#ifndef BENCHSTATS_H
+#define BENCHSTATS_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Результат критерия Манна-Уитни
+ */
+struct MannWhitney {
+    double u = 0; ///< Статистика U первой выборки
+    double p = 1; ///< Двустороннее p-значение
+};
+
+/**
+ * @brief Точное двустороннее p-значение для выборок без совпадений
+ * @param [in] n1 Размер первой выборки
+ * @param [in] n2 Размер второй выборки
+ * @param [in] u Статистика U первой выборки
+ * @return 2 * P(U <= min(u, n1*n2 - u)), не больше 1
+ */
+double exactP(size_t n1, size_t n2, double u);
+
+/**
+ * @brief Двусторонний критерий Манна-Уитни
+ * @param [in] a Первая выборка
+ * @param [in] b Вторая выборка
+ * @details Точное p-значение при размерах до 20 и отсутствии совпадений
+ */
+MannWhitney mannWhitney(const std::vector<double>& a, const std::vector<double>& b);
+
+#endif // BENCHSTATS_H
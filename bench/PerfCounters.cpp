@@ -0,0 +1,182 @@
+/**
+ * @file PerfCounters.cpp
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Реализация аппаратных счётчиков производительности
+ * @copyright ИБСТ ПГУ
+ */
+
+#include "PerfCounters.h"
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+using namespace std;
+
+namespace {
+
+/**
+ * @brief Описание события для perf_event_open
+ */
+struct EventConfig {
+    uint32_t type; ///< Тип события
+    uint64_t config; ///< Номер события
+};
+
+/**
+ * @brief Конфигурации событий в порядке PerfEvent
+ */
+const EventConfig eventConfigs[perfEventCount] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D
+                         | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                         | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+/**
+ * @brief Значение счётчика вместе со временем работы
+ * @details Формат чтения при PERF_FORMAT_TOTAL_TIME_ENABLED
+ *          и PERF_FORMAT_TOTAL_TIME_RUNNING
+ */
+struct ReadFormat {
+    uint64_t value; ///< Значение
+    uint64_t enabled; ///< Время, когда счётчик был включен
+    uint64_t running; ///< Время, когда счётчик реально считал
+};
+
+/**
+ * @brief Открытие одного события текущего потока
+ * @return Дескриптор или -1 (errno сохраняется)
+ */
+int openEvent(const EventConfig& event)
+{
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = event.type;
+    attr.config = event.config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+} // namespace
+
+/**
+ * @brief Накопление значений другого интервала
+ */
+PerfSample& PerfSample::operator+=(const PerfSample& other)
+{
+    for (size_t i = 0; i < perfEventCount; ++i) {
+        value[i] += other.value[i];
+        valid[i] = valid[i] && other.valid[i];
+    }
+    return *this;
+}
+
+/**
+ * @brief Открытие счётчиков
+ */
+PerfCounters::PerfCounters()
+{
+    for (size_t i = 0; i < perfEventCount; ++i) {
+        fds[i] = openEvent(eventConfigs[i]);
+        if (fds[i] < 0 && failure.empty()) {
+            failure = string(name(static_cast<PerfEvent>(i))) + ": " + strerror(errno);
+        }
+    }
+}
+
+/**
+ * @brief Закрытие дескрипторов
+ */
+PerfCounters::~PerfCounters()
+{
+    for (int fd : fds) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+}
+
+/**
+ * @brief Открыт ли хотя бы один счётчик
+ */
+bool PerfCounters::available() const
+{
+    for (int fd : fds) {
+        if (fd >= 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Сброс и запуск счётчиков
+ */
+void PerfCounters::start()
+{
+    for (int fd : fds) {
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+/**
+ * @brief Остановка счётчиков и чтение значений
+ * @details Если счётчиков больше, чем аппаратных регистров, ядро
+ *          переключает их по времени; значение тогда масштабируется
+ *          на долю времени, когда счётчик реально работал
+ */
+PerfSample PerfCounters::stop()
+{
+    PerfSample sample;
+    for (size_t i = 0; i < perfEventCount; ++i) {
+        if (fds[i] >= 0) {
+            ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+    for (size_t i = 0; i < perfEventCount; ++i) {
+        ReadFormat data;
+        if (fds[i] < 0 || read(fds[i], &data, sizeof(data)) != static_cast<ssize_t>(sizeof(data))
+            || data.running == 0) {
+            continue;
+        }
+        double scale = static_cast<double>(data.enabled) / static_cast<double>(data.running);
+        sample.value[i] = static_cast<uint64_t>(static_cast<double>(data.value) * scale);
+        sample.valid[i] = true;
+    }
+    return sample;
+}
+
+/**
+ * @brief Название события для отчёта
+ */
+const char* PerfCounters::name(PerfEvent event)
+{
+    switch (event) {
+    case PerfEvent::Cycles:
+        return "cycles";
+    case PerfEvent::Instructions:
+        return "instructions";
+    case PerfEvent::L1Misses:
+        return "L1d-misses";
+    case PerfEvent::LLCMisses:
+        return "LLC-misses";
+    case PerfEvent::BranchMisses:
+        return "branch-misses";
+    }
+    return "unknown";
+}
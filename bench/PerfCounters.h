@@ -0,0 +1,115 @@
+/**
+ * @file PerfCounters.h
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Аппаратные счётчики производительности через perf_event_open
+ * @copyright ИБСТ ПГУ
+ * @details Каждый счётчик открывается отдельно, поэтому недоступность
+ *          одного события (например, промахов LLC в виртуальной машине)
+ *          не отключает остальные. Если perf_event_open запрещён
+ *          (контейнер, perf_event_paranoid), счётчики просто недоступны
+ *          и замер продолжается только по времени.
+ */
+
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Измеряемые события
+ */
+enum class PerfEvent : size_t {
+    Cycles = 0,       ///< Такты процессора
+    Instructions = 1, ///< Выполненные инструкции
+    L1Misses = 2,     ///< Промахи кэша данных L1 при чтении
+    LLCMisses = 3,    ///< Промахи кэша последнего уровня
+    BranchMisses = 4  ///< Неверно предсказанные переходы
+};
+
+/**
+ * @brief Количество событий
+ */
+const size_t perfEventCount = 5;
+
+/**
+ * @brief Значения счётчиков за интервал
+ */
+struct PerfSample {
+    uint64_t value[perfEventCount] = {}; ///< Значения, масштабированные на время работы счётчика
+    bool valid[perfEventCount] = {};     ///< Счётчик был доступен и работал
+
+    /**
+     * @brief Значение события
+     */
+    uint64_t operator[](PerfEvent event) const { return value[static_cast<size_t>(event)]; }
+
+    /**
+     * @brief Доступность события
+     */
+    bool has(PerfEvent event) const { return valid[static_cast<size_t>(event)]; }
+
+    /**
+     * @brief Накопление значений другого интервала
+     * @details Событие остаётся доступным, только если оно было доступно в обоих
+     */
+    PerfSample& operator+=(const PerfSample& other);
+};
+
+/**
+ * @brief Набор счётчиков текущего потока
+ * @details Считаются только события пользовательского режима текущего
+ *          потока. Объект не копируется: он владеет дескрипторами.
+ */
+class PerfCounters
+{
+private:
+    int fds[perfEventCount]; ///< Дескрипторы событий, -1 если событие недоступно
+    std::string failure; ///< Причина недоступности первого неоткрытого события
+
+public:
+    /**
+     * @brief Открытие счётчиков
+     * @details Ошибки не выбрасываются, см. available и unavailableReason
+     */
+    PerfCounters();
+
+    /**
+     * @brief Закрытие дескрипторов
+     */
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete; ///< Копирование запрещено
+    PerfCounters& operator=(const PerfCounters&) = delete; ///< Присваивание запрещено
+
+    /**
+     * @brief Открыт ли хотя бы один счётчик
+     */
+    bool available() const;
+
+    /**
+     * @brief Причина недоступности счётчиков (пусто, если все открыты)
+     */
+    const std::string& unavailableReason() const { return failure; }
+
+    /**
+     * @brief Сброс и запуск счётчиков
+     */
+    void start();
+
+    /**
+     * @brief Остановка счётчиков и чтение значений
+     * @return Значения за интервал после start
+     */
+    PerfSample stop();
+
+    /**
+     * @brief Название события для отчёта
+     */
+    static const char* name(PerfEvent event);
+};
+
+#endif // PERFCOUNTERS_H
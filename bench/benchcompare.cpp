@@ -0,0 +1,160 @@
+/**
+ * @file benchcompare.cpp
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Сравнение двух результатов cipherbench
+ * @copyright ИБСТ ПГУ
+ * @details Случаи сопоставляются по операции и размеру. Для каждого случая
+ *          время замеров базового и нового запуска сравнивается критерием
+ *          Манна-Уитни (двусторонним). Регрессией считается замедление
+ *          медианы больше порога при p-значении меньше уровня значимости.
+ *
+ * Критерий реализован в BenchStats.h.
+ *
+ * Использование:
+ *   benchcompare [--alpha 0.05] [--threshold 5] базовый.json новый.json
+ *
+ * Код возврата: 0 - регрессий нет, 1 - есть регрессии, 2 - ошибка.
+ *
+ * Сборка:
+ *   g++ -std=c++17 -O2 benchcompare.cpp BenchResults.cpp BenchStats.cpp PerfCounters.cpp -o benchcompare
+ */
+
+#include "BenchResults.h"
+#include "BenchStats.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+/**
+ * @brief Медиана выборки
+ */
+double median(vector<double> values)
+{
+    sort(values.begin(), values.end());
+    size_t n = values.size();
+    return n % 2 == 1 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+}
+
+/**
+ * @brief Чтение файла результатов
+ * @throw bench_error если файл не читается или повреждён
+ */
+vector<CaseResult> load(const string& path, BenchEnvironment& environment)
+{
+    ifstream in(path);
+    if (!in) {
+        throw bench_error("Cannot open " + path);
+    }
+    return readResults(in, environment);
+}
+
+/**
+ * @brief Вывод различий окружения
+ */
+void printEnvironment(const BenchEnvironment& base, const BenchEnvironment& next)
+{
+    const pair<const char*, pair<string, string>> fields[] = {
+        {"cpu", {base.cpu, next.cpu}},
+        {"compiler", {base.compiler, next.compiler}},
+        {"flags", {base.flags, next.flags}},
+        {"kernel", {base.kernel, next.kernel}},
+        {"host", {base.host, next.host}},
+    };
+    for (const auto& field : fields) {
+        if (field.second.first == field.second.second) {
+            cout << field.first << ": " << field.second.first << endl;
+        } else {
+            cout << field.first << ": " << field.second.first << " -> " << field.second.second << " (ОТЛИЧАЕТСЯ)" << endl;
+        }
+    }
+    cout << endl;
+}
+
+} // namespace
+
+/**
+ * @brief Точка входа
+ */
+int main(int argc, char** argv)
+{
+    double alpha = 0.05;
+    double threshold = 5;
+    vector<string> paths;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--alpha" && i + 1 < argc) {
+            alpha = atof(argv[++i]);
+        } else if (arg == "--threshold" && i + 1 < argc) {
+            threshold = atof(argv[++i]);
+        } else {
+            paths.push_back(arg);
+        }
+    }
+    if (paths.size() != 2) {
+        cerr << "Использование: " << argv[0] << " [--alpha 0.05] [--threshold 5] базовый.json новый.json" << endl;
+        return 2;
+    }
+
+    BenchEnvironment baseEnvironment, nextEnvironment;
+    vector<CaseResult> base, next;
+    try {
+        base = load(paths[0], baseEnvironment);
+        next = load(paths[1], nextEnvironment);
+    } catch (const bench_error& e) {
+        cerr << e.what() << endl;
+        return 2;
+    }
+    printEnvironment(baseEnvironment, nextEnvironment);
+
+    map<pair<string, size_t>, const CaseResult*> baseCases;
+    for (const CaseResult& result : base) {
+        baseCases[{result.name, result.bytes}] = &result;
+    }
+
+    cout << left << setw(20) << "case" << right << setw(10) << "bytes"
+         << setw(12) << "base MiB/s" << setw(12) << "new MiB/s" << setw(10) << "change"
+         << setw(10) << "p" << "  verdict" << endl;
+
+    int regressions = 0;
+    for (const CaseResult& result : next) {
+        auto it = baseCases.find({result.name, result.bytes});
+        if (it == baseCases.end()) {
+            cout << left << setw(20) << result.name << right << setw(10) << result.bytes
+                 << "  нет в базовом запуске" << endl;
+            continue;
+        }
+        const CaseResult& old = *it->second;
+        double oldRate = static_cast<double>(old.bytes) / median(old.seconds) / (1 << 20);
+        double newRate = static_cast<double>(result.bytes) / median(result.seconds) / (1 << 20);
+        double change = (newRate / oldRate - 1) * 100;
+        MannWhitney test = mannWhitney(old.seconds, result.seconds);
+
+        const char* verdict = "ok";
+        if (test.p < alpha && change < -threshold) {
+            verdict = "РЕГРЕССИЯ";
+            ++regressions;
+        } else if (test.p < alpha && change > threshold) {
+            verdict = "ускорение";
+        }
+
+        cout << left << setw(20) << result.name << right << setw(10) << result.bytes
+             << fixed << setprecision(1) << setw(12) << oldRate << setw(12) << newRate
+             << setw(9) << showpos << change << noshowpos << '%'
+             << setw(10) << setprecision(4) << test.p << "  " << verdict << endl;
+    }
+
+    cout << endl << "Регрессий: " << regressions << endl;
+    return regressions > 0 ? 1 : 0;
+}
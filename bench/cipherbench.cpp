@@ -0,0 +1,367 @@
+/**
+ * @file cipherbench.cpp
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Замер скорости шифров с аппаратными счётчиками
+ * @copyright ИБСТ ПГУ
+ * @details Для каждого размера текста замеряет modAlphaCipher::encrypt,
+ *          modAlphaCipher::decrypt, RouteCipher::Encrypt и RouteCipher::Decrypt.
+ *          Кроме времени выводит такты на байт, инструкции на такт и
+ *          промахи кэшей и предсказателя переходов на килобайт. Байты
+ *          считаются по открытому тексту в UTF-8 (2 байта на русскую букву)
+ *          для обоих шифров, поэтому строки таблицы сравнимы между собой.
+ *          Если счётчики недоступны, выводится только время.
+ *
+ * Случаи с суффиксом Bulk выполняют пакетный режим с буферами из
+ * BufferArena; столбец faults - ошибки страниц за один вызов, по нему
+ * видно, сколько стоит выделение свежей памяти под большие буферы.
+ *
+ * Использование:
+ *   cipherbench [--reps N] [--min-ms N] [--columns N] [--no-counters] [--latency] [--json файл] [размер...]
+ *
+ * Размер задаётся в байтах с необязательным суффиксом K или M;
+ * по умолчанию 4K 64K 1M 8M. Каждый из --reps замеров (по умолчанию 21)
+ * повторяет вызов, пока не пройдёт --min-ms миллисекунд (по умолчанию 10),
+ * и в таблицу идёт медиана времени одного вызова. Количество столбцов 0 (по умолчанию)
+ * означает квадратную таблицу. С --json все замеры и окружение сохраняются
+ * в файл для сравнения программой benchcompare. С --latency в конце
+ * выводятся перцентили задержек отдельных вызовов (LatencyRecorder).
+ *
+ * Сборка (BENCH_FLAGS записывает в JSON настоящую строку флагов):
+ *   CXXFLAGS="-std=c++17 -O2 -pthread"
+ *   g++ $CXXFLAGS -DBENCH_FLAGS="\"$CXXFLAGS\"" cipherbench.cpp BenchResults.cpp PerfCounters.cpp
+ *       ../modAlphaCipher.cpp ../BufferArena.cpp ../LatencyHistogram.cpp ../2/RouteCipher.cpp
+ *       ../2/RoutePatterns.cpp ../2/RouteKernels.cpp -o cipherbench
+ */
+
+#include "BenchResults.h"
+#include "PerfCounters.h"
+#include "../modAlphaCipher.h"
+#include "../BufferArena.h"
+#include "../LatencyHistogram.h"
+#include "../2/RouteCipher.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+/**
+ * @brief Параметры запуска
+ */
+struct BenchOptions {
+    int repetitions = 21; ///< Количество замеров каждого случая
+    double minSeconds = 0.01; ///< Наименьшая длительность одного замера
+    int columns = 0; ///< Столбцов в таблице перестановки, 0 - квадратная таблица
+    bool counters = true; ///< Читать аппаратные счётчики
+    bool latency = false; ///< Записывать задержки вызовов
+    string jsonPath; ///< Файл для результатов в JSON, пусто - не сохранять
+    vector<size_t> sizes; ///< Размеры открытого текста в байтах
+};
+
+/**
+ * @brief Случай замера
+ */
+struct BenchCase {
+    string name; ///< Операция, например "gronsfeld/encrypt"
+    size_t bytes = 0; ///< Размер открытого текста в байтах UTF-8
+    function<size_t()> run; ///< Операция; возвращает размер результата
+};
+
+volatile size_t sink = 0; ///< Приёмник результатов, чтобы замер не был выброшен оптимизатором
+
+/**
+ * @brief Разбор размера с суффиксом K или M
+ * @return 0 если строка некорректна
+ */
+size_t parseSize(const string& text)
+{
+    char* end = nullptr;
+    unsigned long long value = strtoull(text.c_str(), &end, 10);
+    if (end == text.c_str()) {
+        return 0;
+    }
+    if (*end == 'K' || *end == 'k') {
+        value <<= 10;
+        ++end;
+    } else if (*end == 'M' || *end == 'm') {
+        value <<= 20;
+        ++end;
+    }
+    return *end == '\0' ? static_cast<size_t>(value) : 0;
+}
+
+/**
+ * @brief Разбор аргументов командной строки
+ * @return false если аргументы некорректны
+ */
+bool parseOptions(int argc, char** argv, BenchOptions& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--reps" && i + 1 < argc) {
+            options.repetitions = max(1, atoi(argv[++i]));
+        } else if (arg == "--min-ms" && i + 1 < argc) {
+            options.minSeconds = max(0.0, atof(argv[++i])) / 1000;
+        } else if (arg == "--columns" && i + 1 < argc) {
+            options.columns = max(0, atoi(argv[++i]));
+        } else if (arg == "--json" && i + 1 < argc) {
+            options.jsonPath = argv[++i];
+        } else if (arg == "--no-counters") {
+            options.counters = false;
+        } else if (arg == "--latency") {
+            options.latency = true;
+        } else {
+            size_t size = parseSize(arg);
+            if (size < 2) {
+                return false;
+            }
+            options.sizes.push_back(size);
+        }
+    }
+    if (options.sizes.empty()) {
+        options.sizes = {4 << 10, 64 << 10, 1 << 20, 8 << 20};
+    }
+    return true;
+}
+
+/**
+ * @brief Текст из русских заглавных букв заданного размера в UTF-8
+ */
+string makeText(size_t bytes)
+{
+    static const char letters[] = "СЪЕШЬЖЕЕЩЁЭТИХМЯГКИХФРАНЦУЗСКИХБУЛОК";
+    const size_t count = (sizeof(letters) - 1) / 2;
+    string text;
+    text.reserve(bytes);
+    for (size_t i = 0; text.size() + 2 <= bytes; i = (i + 7) % count) {
+        text.append(letters + i * 2, 2);
+    }
+    return text;
+}
+
+/**
+ * @brief Текст из русских заглавных букв заданной длины в широких символах
+ */
+wstring makeWideText(size_t chars)
+{
+    wstring text(chars, L'А');
+    for (size_t i = 0; i < chars; ++i) {
+        text[i] = static_cast<wchar_t>(L'А' + (i * 7) % 32);
+    }
+    return text;
+}
+
+/**
+ * @brief Время calls вызовов случая в секундах
+ */
+double timeCalls(const BenchCase& bench, uint64_t calls)
+{
+    size_t produced = 0;
+    auto start = chrono::steady_clock::now();
+    for (uint64_t c = 0; c < calls; ++c) {
+        produced += bench.run();
+    }
+    auto stop = chrono::steady_clock::now();
+    sink = sink + produced;
+    return chrono::duration<double>(stop - start).count();
+}
+
+/**
+ * @brief Подготовка результата случая
+ * @details Прогрев подбирает число вызовов в замере, удваивая его, пока
+ *          замер не займёт minSeconds: одиночный вызов на малых размерах
+ *          длится десятки микросекунд, и его время - в основном шум
+ *          таймера и планировщика
+ */
+CaseResult prepareCase(const BenchCase& bench, double minSeconds, bool hasCounters)
+{
+    CaseResult result;
+    result.name = bench.name;
+    result.bytes = bench.bytes;
+    result.hasCounters = hasCounters;
+    for (size_t i = 0; i < perfEventCount; ++i) {
+        result.counters.valid[i] = true;
+    }
+    while (timeCalls(bench, result.calls) < minSeconds && result.calls < (uint64_t(1) << 30)) {
+        result.calls *= 2;
+    }
+    return result;
+}
+
+/**
+ * @brief Один замер случая
+ * @details В результат пишется время одного вызова
+ */
+void measureCase(const BenchCase& bench, CaseResult& result, PerfCounters* counters)
+{
+    if (counters != nullptr) {
+        counters->start();
+    }
+    PageFaults before = BufferArena::currentFaults();
+    double elapsed = timeCalls(bench, result.calls);
+    PageFaults after = BufferArena::currentFaults();
+    result.pageFaults += (after.minor - before.minor) + (after.major - before.major);
+    if (counters != nullptr) {
+        result.counters += counters->stop();
+    }
+    result.seconds.push_back(elapsed / static_cast<double>(result.calls));
+}
+
+/**
+ * @brief Медиана времени замеров
+ */
+double median(vector<double> values)
+{
+    sort(values.begin(), values.end());
+    size_t n = values.size();
+    return n % 2 == 1 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+}
+
+/**
+ * @brief Вывод числа или прочерка, если счётчик недоступен
+ */
+void printMetric(bool valid, double value, int precision)
+{
+    if (valid) {
+        cout << setw(10) << fixed << setprecision(precision) << value;
+    } else {
+        cout << setw(10) << "-";
+    }
+}
+
+/**
+ * @brief Вывод строки результата
+ */
+void printResult(const CaseResult& result)
+{
+    double totalCalls = static_cast<double>(result.seconds.size()) * static_cast<double>(result.calls);
+    double processed = static_cast<double>(result.bytes) * totalCalls;
+    double kilobytes = processed / 1024.0;
+    double ms = median(result.seconds) * 1000.0;
+    double mbps = static_cast<double>(result.bytes) / (ms / 1000.0) / (1 << 20);
+    const PerfSample& c = result.counters;
+    bool has = result.hasCounters;
+
+    cout << left << setw(24) << result.name << right
+         << setw(10) << result.bytes
+         << setw(12) << fixed << setprecision(3) << ms
+         << setw(10) << setprecision(1) << mbps;
+    printMetric(has && c.has(PerfEvent::Cycles), static_cast<double>(c[PerfEvent::Cycles]) / processed, 2);
+    printMetric(has && c.has(PerfEvent::Cycles) && c.has(PerfEvent::Instructions) && c[PerfEvent::Cycles] > 0,
+                static_cast<double>(c[PerfEvent::Instructions]) / static_cast<double>(c[PerfEvent::Cycles]), 2);
+    printMetric(has && c.has(PerfEvent::L1Misses), static_cast<double>(c[PerfEvent::L1Misses]) / kilobytes, 1);
+    printMetric(has && c.has(PerfEvent::LLCMisses), static_cast<double>(c[PerfEvent::LLCMisses]) / kilobytes, 1);
+    printMetric(has && c.has(PerfEvent::BranchMisses), static_cast<double>(c[PerfEvent::BranchMisses]) / kilobytes, 2);
+    printMetric(true, static_cast<double>(result.pageFaults) / totalCalls, 1);
+    cout << endl;
+}
+
+} // namespace
+
+/**
+ * @brief Точка входа
+ */
+int main(int argc, char** argv)
+{
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        cerr << "Использование: " << argv[0] << " [--reps N] [--min-ms N] [--columns N] [--no-counters] [--latency] [--json файл] [размер[K|M]...]" << endl;
+        return 2;
+    }
+
+    unique_ptr<PerfCounters> counters;
+    if (options.counters) {
+        counters.reset(new PerfCounters());
+        if (!counters->available()) {
+            cerr << "Аппаратные счётчики недоступны (" << counters->unavailableReason()
+                 << "), выводится только время" << endl;
+            counters.reset();
+        } else if (!counters->unavailableReason().empty()) {
+            cerr << "Часть счётчиков недоступна: " << counters->unavailableReason() << endl;
+        }
+    }
+
+    cout << left << setw(24) << "case" << right
+         << setw(10) << "bytes" << setw(12) << "median ms" << setw(10) << "MiB/s"
+         << setw(10) << "cyc/B" << setw(10) << "IPC" << setw(10) << "L1/KB"
+         << setw(10) << "LLC/KB" << setw(10) << "br/KB" << setw(10) << "faults" << endl;
+
+    LatencyRecorder::enable(options.latency);
+    vector<CaseResult> results;
+    BufferArena arena;
+    modAlphaCipher gronsfeld("БЕНЧМАРК");
+    for (size_t bytes : options.sizes) {
+        string open = makeText(bytes);
+        string closed = gronsfeld.encrypt(open);
+        size_t chars = open.size() / 2;
+        int columns = options.columns > 0 ? options.columns
+                                          : max(2, static_cast<int>(sqrt(static_cast<double>(chars))));
+        RouteCipher route(columns);
+        wstring wideOpen = makeWideText(chars);
+        wstring wideClosed = route.Encrypt(wideOpen);
+
+        vector<BenchCase> cases = {
+            {"gronsfeld/encrypt", open.size(), [&]() { return gronsfeld.encrypt(open).size(); }},
+            {"gronsfeld/decrypt", open.size(), [&]() { return gronsfeld.decrypt(closed).size(); }},
+            {"route/Encrypt", open.size(), [&]() { return route.Encrypt(wideOpen).size(); }},
+            {"route/Decrypt", open.size(), [&]() { return route.Decrypt(wideClosed).size(); }},
+            {"gronsfeld/encryptBulk", open.size(), [&]() {
+                arena.reset();
+                return gronsfeld.encryptBulk(open, arena).size();
+            }},
+            {"gronsfeld/decryptBulk", open.size(), [&]() {
+                arena.reset();
+                return gronsfeld.decryptBulk(closed, arena).size();
+            }},
+            {"route/EncryptBulk", open.size(), [&]() {
+                arena.reset();
+                return route.EncryptBulk(wideOpen, arena).size();
+            }},
+            {"route/DecryptBulk", open.size(), [&]() {
+                arena.reset();
+                return route.DecryptBulk(wideClosed, arena).size();
+            }},
+        };
+        // Замеры случаев чередуются, чтобы медленный период машины
+        // (частота, соседние процессы) пришёлся на все случаи понемногу,
+        // а не на все замеры одного случая
+        size_t first = results.size();
+        for (const BenchCase& bench : cases) {
+            results.push_back(prepareCase(bench, options.minSeconds, counters != nullptr));
+        }
+        for (int r = 0; r < options.repetitions; ++r) {
+            for (size_t c = 0; c < cases.size(); ++c) {
+                measureCase(cases[c], results[first + c], counters.get());
+            }
+        }
+        for (size_t c = first; c < results.size(); ++c) {
+            printResult(results[c]);
+        }
+    }
+    if (options.latency) {
+        cout << endl << LatencyRecorder::report();
+    }
+
+    if (!options.jsonPath.empty()) {
+        ofstream out(options.jsonPath);
+        writeResults(out, currentEnvironment(), results);
+        if (!out.flush()) {
+            cerr << "Не удалось записать " << options.jsonPath << endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,545 @@
+/**
+ * @file CipherDaemon.cpp
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Реализация демона шифрования
+ * @copyright ИБСТ ПГУ
+ */
+
+#include "CipherDaemon.h"
+#include "../Utf8.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+using namespace std;
+
+/**
+ * @brief Состояние одного соединения
+ */
+struct CipherDaemon::Connection {
+    int fd; ///< Сокет клиента
+    string in; ///< Принятые, но ещё не разобранные байты
+    string out; ///< Ответы, ожидающие отправки
+    size_t outPos = 0; ///< Отправленная часть out
+    bool writing = false; ///< Подписка на EPOLLOUT
+    bool reading = true; ///< Подписка на EPOLLIN (снимается, пока ответы не отправлены)
+    bool closing = false; ///< Клиент закрыл соединение или нарушил протокол
+};
+
+/**
+ * @brief Запрос в пакете
+ */
+struct CipherDaemon::Request {
+    Connection* conn; ///< Соединение, от которого пришёл запрос
+    CipherOp op; ///< Операция
+    string key; ///< Ключ
+    string text; ///< Текст
+    CipherStatus status = CipherStatus::Ok; ///< Статус ответа
+    string result; ///< Результат или сообщение об ошибке
+    string_view output; ///< Результат в арене пакета (вместо result)
+};
+
+namespace {
+
+string systemMessage(const string& what)
+{
+    return what + ": " + strerror(errno);
+}
+
+bool isGronsfeld(CipherOp op)
+{
+    return op == CipherOp::GronsfeldEncrypt || op == CipherOp::GronsfeldDecrypt;
+}
+
+/**
+ * @brief Предел неразобранных байт соединения
+ * @details Любой допустимый кадр помещается целиком, поэтому буфер,
+ *          заполненный до предела, всегда содержит полный кадр
+ */
+const size_t maxInputBuffer = frameHeaderSize + maxFrameSize;
+
+/**
+ * @brief Есть ли в буфере полный кадр
+ */
+bool hasCompleteFrame(const string& in)
+{
+    return in.size() >= frameHeaderSize && in.size() - frameHeaderSize >= getFrameLength(in.data());
+}
+
+/**
+ * @brief Сколько байт читать вперёд, если в буфере уже есть полный кадр
+ * @details Остальное ждёт в сокете: иначе клиент, не читающий ответы,
+ *          успел бы переложить в память демона до maxInputBuffer байт
+ *          запросов, прежде чем сработает предел ответов
+ */
+const size_t inputReadAhead = 256 << 10;
+
+} // namespace
+
+/**
+ * @brief Создание сокета и epoll
+ * @param [in] socketPath Путь к Unix-сокету
+ * @param [in] maxBatch Максимальное число запросов в пакете
+ * @param [in] maxCachedKeys Максимальное число разобранных ключей в кэше
+ * @param [in] maxPendingOutput Предел неотправленных ответов соединения в байтах
+ * @throw daemon_error при ошибке системных вызовов
+ */
+CipherDaemon::CipherDaemon(const string& socketPath, size_t maxBatch, size_t maxCachedKeys, size_t maxPendingOutput)
+    : socketPath(socketPath), maxBatch(max<size_t>(maxBatch, 1)), maxCachedKeys(max<size_t>(maxCachedKeys, 1)),
+      maxPendingOutput(max<size_t>(maxPendingOutput, 1))
+{
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(addr.sun_path)) {
+        throw daemon_error("Invalid socket path");
+    }
+    memcpy(addr.sun_path, socketPath.c_str(), socketPath.size());
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        throw daemon_error(systemMessage("socket failed"));
+    }
+    unlink(socketPath.c_str());
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(listenFd, 128) != 0) {
+        string message = systemMessage("Cannot listen on " + socketPath);
+        close(listenFd);
+        throw daemon_error(message);
+    }
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0) {
+        string message = systemMessage("Cannot create epoll");
+        if (epollFd >= 0) {
+            close(epollFd);
+        }
+        if (wakeFd >= 0) {
+            close(wakeFd);
+        }
+        close(listenFd);
+        unlink(socketPath.c_str());
+        throw daemon_error(message);
+    }
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = listenFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev);
+    ev.data.fd = wakeFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+}
+
+CipherDaemon::~CipherDaemon()
+{
+    for (auto& item : connections) {
+        close(item.first);
+    }
+    connections.clear();
+    if (wakeFd >= 0) {
+        close(wakeFd);
+        wakeFd = -1;
+    }
+    if (epollFd >= 0) {
+        close(epollFd);
+        epollFd = -1;
+    }
+    if (listenFd >= 0) {
+        close(listenFd);
+        listenFd = -1;
+        unlink(socketPath.c_str());
+    }
+}
+
+/**
+ * @brief Запрос остановки цикла
+ */
+void CipherDaemon::stop()
+{
+    uint64_t one = 1;
+    ssize_t ignored = write(wakeFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+/**
+ * @brief Цикл обработки событий
+ * @details События одной итерации epoll_wait образуют пакет. Если пакет
+ *          заполнился раньше, чем прочитаны все соединения, остаток
+ *          кадров остаётся в буферах и разбирается на следующей итерации.
+ *          Сокет к этому времени уже вычитан, и новых событий по нему
+ *          может не прийти, поэтому при недоразобранных кадрах epoll_wait
+ *          вызывается без ожидания. Исключение - соединения, упёршиеся в
+ *          предел неотправленных ответов: они ждут EPOLLOUT.
+ */
+void CipherDaemon::run()
+{
+    vector<epoll_event> events(64);
+    vector<Connection*> ready;
+    int timeout = -1;
+    for (;;) {
+        int n = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), timeout);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw daemon_error(systemMessage("epoll_wait failed"));
+        }
+
+        ready.clear();
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == wakeFd) {
+                return;
+            }
+            if (fd == listenFd) {
+                acceptConnections();
+                continue;
+            }
+            auto it = connections.find(fd);
+            if (it == connections.end()) {
+                continue;
+            }
+            Connection& conn = *it->second;
+            if ((events[i].events & EPOLLOUT) && conn.outPos < conn.out.size()) {
+                flushConnection(conn);
+            }
+            if ((events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) && !outputBlocked(conn)) {
+                readConnection(conn);
+            }
+            ready.push_back(&conn);
+        }
+
+        for (Connection* conn : ready) {
+            parseFrames(*conn);
+        }
+        // Соединения с недоразобранными кадрами (пакет был полон)
+        for (auto& item : connections) {
+            if (batch.size() >= maxBatch) {
+                break;
+            }
+            if (item.second->in.size() >= frameHeaderSize && !outputBlocked(*item.second)) {
+                parseFrames(*item.second);
+            }
+        }
+        processBatch();
+
+        vector<int> finished;
+        timeout = -1;
+        for (auto& item : connections) {
+            Connection& conn = *item.second;
+            if (conn.outPos < conn.out.size()) {
+                flushConnection(conn);
+            }
+            updateInterest(conn);
+            bool pendingFrame = hasCompleteFrame(conn.in);
+            if (pendingFrame && !outputBlocked(conn)) {
+                timeout = 0;
+            } else if (conn.closing && conn.outPos >= conn.out.size()) {
+                finished.push_back(item.first);
+            }
+        }
+        for (int fd : finished) {
+            closeConnection(fd);
+        }
+    }
+}
+
+void CipherDaemon::acceptConnections()
+{
+    for (;;) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+        epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            close(fd);
+            continue;
+        }
+        unique_ptr<Connection> conn(new Connection());
+        conn->fd = fd;
+        connections[fd] = move(conn);
+        ++counters.connections;
+    }
+}
+
+/**
+ * @brief Чтение доступных данных соединения
+ * @details Чтение прекращается, когда буфер достиг maxInputBuffer или
+ *          содержит полный кадр и не меньше inputReadAhead байт: остаток
+ *          ждёт в сокете, пока кадры из буфера не будут разобраны
+ */
+void CipherDaemon::readConnection(Connection& conn)
+{
+    char buf[65536];
+    while (conn.in.size() < maxInputBuffer && (conn.in.size() < inputReadAhead || !hasCompleteFrame(conn.in))) {
+        ssize_t n = recv(conn.fd, buf, min(sizeof(buf), maxInputBuffer - conn.in.size()), 0);
+        if (n > 0) {
+            conn.in.append(buf, static_cast<size_t>(n));
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+            conn.closing = true;
+        }
+        return;
+    }
+}
+
+/**
+ * @brief Разбор полных кадров соединения в пакет
+ * @details Кадр с недопустимой длиной не позволяет найти начало
+ *          следующего, поэтому такое соединение закрывается. Разбор
+ *          останавливается, когда неотправленные ответы вместе с
+ *          разобранными запросами (ответ не длиннее запроса с точностью
+ *          до заполнителей) превысили maxPendingOutput
+ */
+void CipherDaemon::parseFrames(Connection& conn)
+{
+    size_t pos = 0;
+    size_t pending = conn.out.size() - conn.outPos;
+    while (batch.size() < maxBatch && pending < maxPendingOutput && conn.in.size() - pos >= frameHeaderSize) {
+        uint32_t len = getFrameLength(conn.in.data() + pos);
+        if (len > maxFrameSize) {
+            conn.closing = true;
+            conn.in.clear();
+            return;
+        }
+        if (conn.in.size() - pos - frameHeaderSize < len) {
+            break;
+        }
+        const char* payload = conn.in.data() + pos + frameHeaderSize;
+        pos += frameHeaderSize + len;
+        pending += frameHeaderSize + len;
+
+        Request req;
+        req.conn = &conn;
+        if (len < 3) {
+            req.op = CipherOp::GronsfeldEncrypt;
+            req.status = CipherStatus::BadRequest;
+            req.result = "Truncated request";
+            batch.push_back(move(req));
+            continue;
+        }
+        unsigned char op = static_cast<unsigned char>(payload[0]);
+        size_t keyLen = static_cast<unsigned char>(payload[1]) | static_cast<size_t>(static_cast<unsigned char>(payload[2])) << 8;
+        req.op = static_cast<CipherOp>(op);
+        if (op < static_cast<unsigned char>(CipherOp::GronsfeldEncrypt) ||
+            op > static_cast<unsigned char>(CipherOp::RouteDecrypt)) {
+            req.status = CipherStatus::BadRequest;
+            req.result = "Unknown operation";
+        } else if (3 + keyLen > len) {
+            req.status = CipherStatus::BadRequest;
+            req.result = "Key length exceeds frame";
+        } else {
+            req.key.assign(payload + 3, keyLen);
+            req.text.assign(payload + 3 + keyLen, len - 3 - keyLen);
+        }
+        batch.push_back(move(req));
+    }
+    conn.in.erase(0, pos);
+}
+
+/**
+ * @brief Обработка пакета
+ * @details Запросы упорядочиваются по (операция, ключ) без нарушения
+ *          исходного порядка внутри группы, ответы дописываются в буферы
+ *          соединений в исходном порядке пакета
+ */
+void CipherDaemon::processBatch()
+{
+    if (batch.empty()) {
+        return;
+    }
+    vector<size_t> order;
+    order.reserve(batch.size());
+    for (size_t i = 0; i < batch.size(); ++i) {
+        if (batch[i].status == CipherStatus::Ok) {
+            order.push_back(i);
+        }
+    }
+    stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        if (batch[a].op != batch[b].op) {
+            return batch[a].op < batch[b].op;
+        }
+        return batch[a].key < batch[b].key;
+    });
+
+    size_t first = 0;
+    while (first < order.size()) {
+        size_t last = first + 1;
+        while (last < order.size() && batch[order[last]].op == batch[order[first]].op &&
+               batch[order[last]].key == batch[order[first]].key) {
+            ++last;
+        }
+        processGroup(order, first, last);
+        first = last;
+    }
+
+    for (Request& req : batch) {
+        bool inArena = req.status == CipherStatus::Ok && req.output.data() != nullptr;
+        appendResponse(req.conn->out, req.status, inArena ? req.output : string_view(req.result));
+    }
+    arena.reset();
+    counters.requests += batch.size();
+    ++counters.batches;
+    batch.clear();
+}
+
+/**
+ * @brief Выполнение группы запросов с одинаковыми операцией и ключом
+ * @details Ошибка в ключе отвечается всем запросам группы, ошибка
+ *          в тексте - только своему запросу. Результаты Гронсфельда
+ *          пишутся в арену пакета, которая сбрасывается после того, как
+ *          ответы скопированы в буферы соединений
+ */
+void CipherDaemon::processGroup(const vector<size_t>& order, size_t first, size_t last)
+{
+    const Request& head = batch[order[first]];
+    ++counters.keyLookups;
+    try {
+        if (isGronsfeld(head.op)) {
+            auto it = gronsfeldCache.find(head.key);
+            if (it == gronsfeldCache.end()) {
+                if (gronsfeldCache.size() >= maxCachedKeys) {
+                    gronsfeldCache.clear();
+                }
+                it = gronsfeldCache.emplace(head.key, unique_ptr<modAlphaCipher>(new modAlphaCipher(head.key))).first;
+            }
+            modAlphaCipher& cipher = *it->second;
+            bool decrypting = head.op == CipherOp::GronsfeldDecrypt;
+            for (size_t i = first; i < last; ++i) {
+                Request& req = batch[order[i]];
+                try {
+                    req.output = decrypting ? cipher.decryptBulk(req.text, arena) : cipher.encryptBulk(req.text, arena);
+                } catch (const exception& e) {
+                    req.status = CipherStatus::CipherError;
+                    req.result = e.what();
+                }
+            }
+        } else {
+            size_t used = 0;
+            int columns = 0;
+            try {
+                columns = stoi(head.key, &used);
+            } catch (const exception&) {
+                used = 0;
+            }
+            if (used == 0 || used != head.key.size()) {
+                throw CipherError("Ключ должен быть десятичным числом");
+            }
+            auto it = routeCache.find(columns);
+            if (it == routeCache.end()) {
+                if (routeCache.size() >= maxCachedKeys) {
+                    routeCache.clear();
+                }
+                it = routeCache.emplace(columns, unique_ptr<RouteCipher>(new RouteCipher(columns))).first;
+            }
+            RouteCipher& cipher = *it->second;
+            bool decrypting = head.op == CipherOp::RouteDecrypt;
+            wstring wide;
+            for (size_t i = first; i < last; ++i) {
+                Request& req = batch[order[i]];
+                try {
+                    if (!utf8ToWide(req.text, wide)) {
+                        throw CipherError("Некорректная последовательность UTF-8");
+                    }
+                    req.result = wideToUtf8(decrypting ? cipher.Decrypt(wide) : cipher.Encrypt(wide));
+                } catch (const exception& e) {
+                    req.status = CipherStatus::CipherError;
+                    req.result = e.what();
+                }
+            }
+        }
+    } catch (const exception& e) {
+        for (size_t i = first; i < last; ++i) {
+            Request& req = batch[order[i]];
+            req.status = CipherStatus::CipherError;
+            req.result = e.what();
+        }
+    }
+}
+
+void CipherDaemon::flushConnection(Connection& conn)
+{
+    while (conn.outPos < conn.out.size()) {
+        ssize_t n = send(conn.fd, conn.out.data() + conn.outPos, conn.out.size() - conn.outPos, MSG_NOSIGNAL);
+        if (n > 0) {
+            conn.outPos += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            updateInterest(conn);
+            return;
+        }
+        conn.closing = true;
+        conn.out.clear();
+        conn.outPos = 0;
+        return;
+    }
+    conn.out.clear();
+    conn.outPos = 0;
+    updateInterest(conn);
+}
+
+/**
+ * @brief Превышен ли предел неотправленных ответов соединения
+ */
+bool CipherDaemon::outputBlocked(const Connection& conn) const
+{
+    return conn.out.size() - conn.outPos >= maxPendingOutput;
+}
+
+/**
+ * @brief Подписка соединения на события по его состоянию
+ * @details EPOLLOUT - пока есть неотправленные ответы. EPOLLIN снимается,
+ *          пока ответов больше предела: иначе непрочитанные данные
+ *          будили бы цикл без возможности их разобрать
+ */
+void CipherDaemon::updateInterest(Connection& conn)
+{
+    bool wantWrite = conn.outPos < conn.out.size();
+    bool wantRead = !outputBlocked(conn);
+    if (conn.writing == wantWrite && conn.reading == wantRead) {
+        return;
+    }
+    if (conn.reading && !wantRead) {
+        ++counters.throttled;
+    }
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = 0;
+    if (wantRead) {
+        ev.events |= EPOLLIN;
+    }
+    if (wantWrite) {
+        ev.events |= EPOLLOUT;
+    }
+    ev.data.fd = conn.fd;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, conn.fd, &ev);
+    conn.writing = wantWrite;
+    conn.reading = wantRead;
+}
+
+void CipherDaemon::closeConnection(int fd)
+{
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    connections.erase(fd);
+}
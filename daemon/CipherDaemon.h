@@ -0,0 +1,150 @@
+/**
+ * @file CipherDaemon.h
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Демон шифрования на Unix-сокете
+ * @copyright ИБСТ ПГУ
+ * @details Долгоживущий процесс, который обслуживает запросы к
+ *          modAlphaCipher и RouteCipher по протоколу из CipherProtocol.h.
+ *          Разобранные ключи кэшируются, поэтому запрос не платит ни за
+ *          запуск процесса, ни за разбор ключа.
+ */
+
+#ifndef CIPHERDAEMON_H
+#define CIPHERDAEMON_H
+
+#include "CipherProtocol.h"
+#include "../modAlphaCipher.h"
+#include "../2/RouteCipher.h"
+#include "../BufferArena.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <stdexcept>
+#include <cstdint>
+
+/**
+ * @brief Класс исключений для системных ошибок демона
+ * @details Наследуется от std::runtime_error
+ */
+class daemon_error : public std::runtime_error {
+public:
+    /**
+     * @brief Конструктор с строкой
+     * @param what_arg Сообщение об ошибке
+     */
+    explicit daemon_error(const std::string& what_arg) : std::runtime_error(what_arg) {}
+
+    /**
+     * @brief Конструктор с C-строкой
+     * @param what_arg Сообщение об ошибке
+     */
+    explicit daemon_error(const char* what_arg) : std::runtime_error(what_arg) {}
+};
+
+/**
+ * @brief Счётчики работы демона
+ */
+struct DaemonStats {
+    uint64_t connections = 0; ///< Принято соединений
+    uint64_t requests = 0; ///< Обработано запросов
+    uint64_t batches = 0; ///< Обработано пакетов
+    uint64_t keyLookups = 0; ///< Поисков шифра в кэше (по одному на группу пакета)
+    uint64_t throttled = 0; ///< Приостановок чтения соединения из-за неотправленных ответов
+};
+
+/**
+ * @brief Демон шифрования с циклом событий на epoll
+ * @details За одну итерацию цикла демон читает все готовые соединения,
+ *          разбирает все полные кадры (клиент может отправлять запросы
+ *          конвейером) и складывает их в общий пакет. Пакет группируется
+ *          по операции и ключу: шифр для группы берётся из кэша один раз,
+ *          и запросы группы обрабатываются подряд на одних и тех же
+ *          таблицах. Тексты группы Гронсфельда проходят однопроходное ядро
+ *          encryptBulk/decryptBulk (фаза ключа с нуля для каждого запроса)
+ *          в общую арену пакета, так что результаты лежат подряд в уже
+ *          отображённой памяти и копируются один раз - сразу в буфер
+ *          ответа. Ответы возвращаются в порядке запросов соединения.
+ *
+ * Соединение, у которого неотправленных ответов больше maxPendingOutput
+ * (клиент шлёт запросы, но не читает ответы), не разбирается и не
+ * читается, пока ответы не уйдут в сокет. Так память на соединение
+ * ограничена буфером запросов, пределом ответов и одним кадром сверх него.
+ */
+class CipherDaemon
+{
+private:
+    struct Connection;
+    struct Request;
+
+    std::string socketPath; ///< Путь к сокету
+    size_t maxBatch; ///< Максимальный размер пакета
+    size_t maxCachedKeys; ///< Максимальное число ключей в кэше
+    size_t maxPendingOutput; ///< Предел неотправленных ответов соединения в байтах
+    int listenFd = -1; ///< Слушающий сокет
+    int epollFd = -1; ///< Дескриптор epoll
+    int wakeFd = -1; ///< eventfd для остановки
+    std::unordered_map<int, std::unique_ptr<Connection>> connections; ///< Открытые соединения
+    std::unordered_map<std::string, std::unique_ptr<modAlphaCipher>> gronsfeldCache; ///< Кэш шифров Гронсфельда
+    std::unordered_map<int, std::unique_ptr<RouteCipher>> routeCache; ///< Кэш шифров перестановки
+    std::vector<Request> batch; ///< Текущий пакет запросов
+    BufferArena arena; ///< Результаты Гронсфельда текущего пакета
+    DaemonStats counters; ///< Счётчики
+
+    void acceptConnections();
+    void readConnection(Connection& conn);
+    void parseFrames(Connection& conn);
+    void processBatch();
+    void flushConnection(Connection& conn);
+    void closeConnection(int fd);
+    void updateInterest(Connection& conn);
+
+    /**
+     * @brief Превышен ли предел неотправленных ответов соединения
+     */
+    bool outputBlocked(const Connection& conn) const;
+
+    /**
+     * @brief Выполнение группы запросов с одинаковыми операцией и ключом
+     * @param [in] first Начало группы в упорядоченном пакете
+     * @param [in] last Конец группы
+     */
+    void processGroup(const std::vector<size_t>& order, size_t first, size_t last);
+
+public:
+    /**
+     * @brief Создание сокета и epoll
+     * @param [in] socketPath Путь к Unix-сокету (существующий файл заменяется)
+     * @param [in] maxBatch Максимальное число запросов в пакете
+     * @param [in] maxCachedKeys Максимальное число разобранных ключей в кэше
+     * @param [in] maxPendingOutput Предел неотправленных ответов соединения в байтах
+     * @throw daemon_error при ошибке системных вызовов
+     */
+    explicit CipherDaemon(const std::string& socketPath, size_t maxBatch = 256, size_t maxCachedKeys = 1024,
+                          size_t maxPendingOutput = 16u << 20);
+    ~CipherDaemon();
+
+    CipherDaemon(const CipherDaemon&) = delete;
+    CipherDaemon& operator=(const CipherDaemon&) = delete;
+
+    /**
+     * @brief Цикл обработки событий до вызова stop()
+     * @throw daemon_error при ошибке epoll
+     */
+    void run();
+
+    /**
+     * @brief Запрос остановки цикла
+     * @details Безопасен для вызова из обработчика сигнала
+     */
+    void stop();
+
+    /**
+     * @brief Счётчики работы
+     */
+    const DaemonStats& stats() const { return counters; }
+};
+
+#endif // CIPHERDAEMON_H
@@ -0,0 +1,100 @@
+/**
+ * @file CipherProtocol.h
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Двоичный протокол демона шифрования
+ * @copyright ИБСТ ПГУ
+ * @details Каждое сообщение - кадр из 4-байтовой длины (little-endian)
+ *          и полезной нагрузки указанной длины.
+ *
+ * Запрос:  [u8 операция][u16 длина ключа][ключ][текст]
+ * Ответ:   [u8 статус][результат или сообщение об ошибке]
+ *
+ * Для шифра Гронсфельда ключ передаётся в UTF-8, для шифра маршрутной
+ * перестановки - десятичной записью количества столбцов. Ответы по
+ * одному соединению приходят в порядке запросов, поэтому клиент может
+ * отправлять запросы, не дожидаясь ответов.
+ */
+
+#ifndef CIPHERPROTOCOL_H
+#define CIPHERPROTOCOL_H
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Операции демона
+ */
+enum class CipherOp : uint8_t {
+    GronsfeldEncrypt = 1, ///< modAlphaCipher::encrypt
+    GronsfeldDecrypt = 2, ///< modAlphaCipher::decrypt
+    RouteEncrypt = 3,     ///< RouteCipher::Encrypt
+    RouteDecrypt = 4      ///< RouteCipher::Decrypt
+};
+
+/**
+ * @brief Статус ответа
+ */
+enum class CipherStatus : uint8_t {
+    Ok = 0,          ///< Результат в теле ответа
+    CipherError = 1, ///< Ошибка шифра, в теле - сообщение
+    BadRequest = 2   ///< Некорректный запрос, в теле - сообщение
+};
+
+const size_t frameHeaderSize = 4; ///< Размер заголовка кадра
+const uint32_t maxFrameSize = 64u << 20; ///< Максимальный размер полезной нагрузки
+
+/**
+ * @brief Запись 32-битной длины в little-endian
+ */
+inline void putFrameLength(std::string& buf, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i) {
+        buf += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+/**
+ * @brief Чтение 32-битной длины в little-endian
+ */
+inline uint32_t getFrameLength(const char* p)
+{
+    const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+    return static_cast<uint32_t>(u[0]) | static_cast<uint32_t>(u[1]) << 8 |
+           static_cast<uint32_t>(u[2]) << 16 | static_cast<uint32_t>(u[3]) << 24;
+}
+
+/**
+ * @brief Добавление кадра запроса в буфер
+ * @param [out] buf Буфер отправки
+ * @param [in] op Операция
+ * @param [in] key Ключ шифра
+ * @param [in] text Текст
+ */
+inline void appendRequest(std::string& buf, CipherOp op, const std::string& key, const std::string& text)
+{
+    putFrameLength(buf, static_cast<uint32_t>(1 + 2 + key.size() + text.size()));
+    buf += static_cast<char>(op);
+    buf += static_cast<char>(key.size() & 0xFF);
+    buf += static_cast<char>((key.size() >> 8) & 0xFF);
+    buf += key;
+    buf += text;
+}
+
+/**
+ * @brief Добавление кадра ответа в буфер
+ * @param [out] buf Буфер отправки
+ * @param [in] status Статус
+ * @param [in] body Результат или сообщение об ошибке
+ */
+inline void appendResponse(std::string& buf, CipherStatus status, std::string_view body)
+{
+    putFrameLength(buf, static_cast<uint32_t>(1 + body.size()));
+    buf += static_cast<char>(status);
+    buf += body;
+}
+
+#endif // CIPHERPROTOCOL_H
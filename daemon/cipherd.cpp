@@ -0,0 +1,71 @@
+/**
+ * @file cipherd.cpp
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Запуск демона шифрования
+ * @copyright ИБСТ ПГУ
+ * @details Использование: cipherd <путь к сокету> [размер пакета]
+ *
+ * Сборка:
+ *   g++ -std=c++17 -O2 -pthread cipherd.cpp CipherDaemon.cpp ../modAlphaCipher.cpp ../BufferArena.cpp
+ *       ../LatencyHistogram.cpp ../2/RouteCipher.cpp ../2/RoutePatterns.cpp ../2/RouteKernels.cpp -o cipherd
+ */
+
+#include "CipherDaemon.h"
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+
+namespace {
+
+CipherDaemon* activeDaemon = nullptr; ///< Демон, останавливаемый по сигналу
+
+void handleSignal(int)
+{
+    if (activeDaemon != nullptr) {
+        activeDaemon->stop();
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Главная функция демона
+ * @param argc Количество аргументов командной строки
+ * @param argv Массив аргументов командной строки
+ * @return Код завершения программы (0 - успешно)
+ */
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        cerr << "Использование: " << argv[0] << " <путь к сокету> [размер пакета]" << endl;
+        return 2;
+    }
+    size_t maxBatch = argc > 2 ? strtoul(argv[2], nullptr, 10) : 256;
+
+    try {
+        CipherDaemon daemon(argv[1], maxBatch);
+        activeDaemon = &daemon;
+        signal(SIGINT, handleSignal);
+        signal(SIGTERM, handleSignal);
+        signal(SIGPIPE, SIG_IGN);
+
+        cout << "Демон слушает " << argv[1] << endl;
+        daemon.run();
+        activeDaemon = nullptr;
+
+        const DaemonStats& stats = daemon.stats();
+        cout << "Соединений: " << stats.connections << endl;
+        cout << "Запросов: " << stats.requests << endl;
+        cout << "Пакетов: " << stats.batches << endl;
+        cout << "Поисков ключа: " << stats.keyLookups << endl;
+        cout << "Приостановок чтения: " << stats.throttled << endl;
+    } catch (const exception& e) {
+        cerr << "Ошибка: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,215 @@
+/**
+ * @file loadgen.cpp
+ * @author Мураев Никита
+ * @version 1.0
+ * @date 03.12.2025
+ * @brief Генератор нагрузки для демона шифрования
+ * @copyright ИБСТ ПГУ
+ * @details Открывает несколько соединений, в каждом держит заданное число
+ *          запросов в полёте и измеряет задержку каждого запроса от
+ *          отправки до получения ответа.
+ *
+ * Использование:
+ *   loadgen <сокет> [соединений=4] [глубина=8] [запросов на соединение=10000]
+ *           [букв в сообщении=64] [операция=1]
+ *
+ * Сборка:
+ *   g++ -std=c++17 -O2 -pthread loadgen.cpp -o loadgen
+ */
+
+#include "CipherProtocol.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+namespace {
+
+/**
+ * @brief Параметры нагрузки
+ */
+struct LoadOptions {
+    string socketPath;
+    int connections = 4;
+    int depth = 8;
+    int requests = 10000;
+    int letters = 64;
+    CipherOp op = CipherOp::GronsfeldEncrypt;
+};
+
+/**
+ * @brief Результат одного соединения
+ */
+struct ConnectionResult {
+    vector<double> latencies; ///< Задержки в микросекундах
+    int errors = 0; ///< Ответы с ненулевым статусом
+    string failure; ///< Описание сбоя соединения
+};
+
+bool sendAll(int fd, const string& data)
+{
+    size_t pos = 0;
+    while (pos < data.size()) {
+        ssize_t n = send(fd, data.data() + pos, data.size() - pos, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        pos += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool recvAll(int fd, char* data, size_t size)
+{
+    size_t pos = 0;
+    while (pos < size) {
+        ssize_t n = recv(fd, data + pos, size - pos, 0);
+        if (n <= 0) {
+            return false;
+        }
+        pos += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+/**
+ * @brief Формирование запроса для выбранной операции
+ */
+string makeRequest(const LoadOptions& options, int seed)
+{
+    static const char* letters[] = {"А", "Б", "В", "Г", "Д", "Е", "Ж", "З", "И", "К", "Л", "М", "Н", "О", "П", "Р"};
+    string text;
+    for (int i = 0; i < options.letters; ++i) {
+        text += letters[(seed + i * 7) % 16];
+    }
+    bool gronsfeld = options.op == CipherOp::GronsfeldEncrypt || options.op == CipherOp::GronsfeldDecrypt;
+    string key = gronsfeld ? "КЛЮЧ" : "7";
+    string buf;
+    appendRequest(buf, options.op, key, text);
+    return buf;
+}
+
+void runConnection(const LoadOptions& options, int id, ConnectionResult& result)
+{
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, options.socketPath.c_str(), sizeof(addr.sun_path) - 1);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        result.failure = string("connect: ") + strerror(errno);
+        if (fd >= 0) {
+            close(fd);
+        }
+        return;
+    }
+
+    result.latencies.reserve(options.requests);
+    deque<Clock::time_point> sent;
+    int issued = 0;
+    string body;
+    while (static_cast<int>(result.latencies.size()) < options.requests) {
+        string burst;
+        while (issued < options.requests && static_cast<int>(sent.size()) < options.depth) {
+            burst += makeRequest(options, id * 31 + issued);
+            sent.push_back(Clock::now());
+            ++issued;
+        }
+        if (!burst.empty() && !sendAll(fd, burst)) {
+            result.failure = "send failed";
+            break;
+        }
+
+        char header[frameHeaderSize];
+        if (!recvAll(fd, header, sizeof(header))) {
+            result.failure = "connection closed by server";
+            break;
+        }
+        body.resize(getFrameLength(header));
+        if (!body.empty() && !recvAll(fd, &body[0], body.size())) {
+            result.failure = "connection closed by server";
+            break;
+        }
+        Clock::time_point now = Clock::now();
+        result.latencies.push_back(chrono::duration<double, micro>(now - sent.front()).count());
+        sent.pop_front();
+        if (body.empty() || body[0] != static_cast<char>(CipherStatus::Ok)) {
+            ++result.errors;
+        }
+    }
+    close(fd);
+}
+
+double percentile(const vector<double>& sorted, double p)
+{
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t index = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[min(index, sorted.size() - 1)];
+}
+
+} // namespace
+
+/**
+ * @brief Главная функция генератора нагрузки
+ * @param argc Количество аргументов командной строки
+ * @param argv Массив аргументов командной строки
+ * @return Код завершения программы (0 - успешно)
+ */
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        cerr << "Использование: " << argv[0]
+             << " <сокет> [соединений] [глубина] [запросов] [букв] [операция 1-4]" << endl;
+        return 2;
+    }
+    LoadOptions options;
+    options.socketPath = argv[1];
+    if (argc > 2) options.connections = max(1, atoi(argv[2]));
+    if (argc > 3) options.depth = max(1, atoi(argv[3]));
+    if (argc > 4) options.requests = max(1, atoi(argv[4]));
+    if (argc > 5) options.letters = max(1, atoi(argv[5]));
+    if (argc > 6) options.op = static_cast<CipherOp>(min(4, max(1, atoi(argv[6]))));
+
+    vector<ConnectionResult> results(options.connections);
+    vector<thread> threads;
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < options.connections; ++i) {
+        threads.emplace_back(runConnection, cref(options), i, ref(results[i]));
+    }
+    for (thread& t : threads) {
+        t.join();
+    }
+    double seconds = chrono::duration<double>(Clock::now() - start).count();
+
+    vector<double> all;
+    int errors = 0;
+    for (const ConnectionResult& r : results) {
+        if (!r.failure.empty()) {
+            cerr << "Сбой соединения: " << r.failure << endl;
+        }
+        all.insert(all.end(), r.latencies.begin(), r.latencies.end());
+        errors += r.errors;
+    }
+    sort(all.begin(), all.end());
+
+    cout << "Запросов: " << all.size() << " (ошибок: " << errors << ")" << endl;
+    cout << "Запросов/с: " << (seconds > 0 ? all.size() / seconds : 0.0) << endl;
+    cout << "p50, мкс: " << percentile(all, 50) << endl;
+    cout << "p90, мкс: " << percentile(all, 90) << endl;
+    cout << "p99, мкс: " << percentile(all, 99) << endl;
+    cout << "max, мкс: " << (all.empty() ? 0.0 : all.back()) << endl;
+    return errors == 0 && all.size() == static_cast<size_t>(options.connections) * options.requests ? 0 : 1;
+}
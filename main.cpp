@@ -9,16 +9,65 @@
  *          Тестируются конструктор, шифрование и дешифрование.
  * @copyright ИБСТ ПГУ
  * @warning Для корректной работы требуется русская локаль
+ *
+ * Сборка:
+ *   g++ -std=c++17 -O2 -pthread main.cpp modAlphaCipher.cpp BufferArena.cpp RunningKeyCipher.cpp
+ *       EncryptedDocument.cpp LatencyHistogram.cpp FilePipeline.cpp daemon/CipherDaemon.cpp
+ *       CascadeCipher.cpp CipherContainer.cpp AutoTuner.cpp BatchProcessor.cpp bench/BenchStats.cpp
+ *       2/RouteCipher.cpp 2/RoutePatterns.cpp 2/RouteKernels.cpp -o tests
  */
 
 #include "modAlphaCipher.h"
+#include "BufferArena.h"
+#include "RunningKeyCipher.h"
+#include "EncryptedDocument.h"
+#include "LatencyHistogram.h"
+#include "FilePipeline.h"
+#include "CascadeCipher.h"
+#include "CipherContainer.h"
+#include "AutoTuner.h"
+#include "BatchProcessor.h"
+#include "Utf8.h"
+#include "daemon/CipherDaemon.h"
+#include "daemon/CipherProtocol.h"
+#include "bench/BenchStats.h"
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
 #include <iostream>
 #include <string>
+#include <vector>
 #include <locale>
 #include <codecvt>
+#include <fstream>
+#include <cstdio>
+#include <iterator>
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <chrono>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
 
 using namespace std;
 
+/**
+ * @brief Создание временного каталога для файлов тестов
+ * @return Путь к новому каталогу в системном временном каталоге
+ * @throws runtime_error если каталог не удалось создать
+ */
+string makeTestDir()
+{
+    string pattern = (filesystem::temp_directory_path() / "cipher_tests.XXXXXX").string();
+    if (mkdtemp(&pattern[0]) == nullptr) {
+        throw runtime_error("mkdtemp: " + string(strerror(errno)));
+    }
+    return pattern;
+}
+
 /**
  * @brief Функция для вывода результатов тестирования
  * @details Проверяет различные сценарии работы шифра:
@@ -36,6 +85,8 @@ void PrintTestResults() {
     
     int passed = 0;
     int total = 0;
+    // Все файлы тестов - во временном каталоге, удаляемом в конце
+    string testDir = makeTestDir();
     
     // 1. Тесты конструктора
     cout << "\n1. Тесты конструктора:" << endl;
@@ -278,6 +329,1091 @@ void PrintTestResults() {
         cout << "✗ 4.3 Длинный текст с коротким ключом - ОШИБКА: " << e.what() << endl;
     }
     
+    // 5. Потоковое шифрование
+    cout << "\n5. Потоковое шифрование:" << endl;
+    
+    // 5.1 Шифрование по фрагментам совпадает с шифрованием целиком
+    try {
+        total++;
+        modAlphaCipher cipher("КЛЮЧ");
+        string text = "ПРИВЕТ МИР ТЕКСТ";
+        size_t phase = 0;
+        string encrypted = cipher.encryptChunk("ПРИВЕТ М", phase);
+        encrypted += cipher.encryptChunk("ИР ТЕКСТ", phase);
+        
+        if (encrypted == cipher.encrypt(text)) {
+            cout << "✓ 5.1 Шифрование по фрагментам - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 5.1 Шифрование по фрагментам - ОШИБКА" << endl;
+        }
+    } catch (const cipher_error& e) {
+        cout << "✗ 5.1 Шифрование по фрагментам - ОШИБКА: " << e.what() << endl;
+    }
+    
+    // 5.2 Дешифрование по фрагментам
+    try {
+        total++;
+        modAlphaCipher cipher("СЕКРЕТ");
+        string encrypted = cipher.encrypt("ДЛИННЫЙТЕКСТ");
+        size_t phase = 0;
+        string decrypted = cipher.decryptChunk(encrypted.substr(0, 10), phase);
+        decrypted += cipher.decryptChunk(encrypted.substr(10), phase);
+        
+        if (decrypted == "ДЛИННЫЙТЕКСТ") {
+            cout << "✓ 5.2 Дешифрование по фрагментам - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 5.2 Дешифрование по фрагментам - ОШИБКА" << endl;
+        }
+    } catch (const cipher_error& e) {
+        cout << "✗ 5.2 Дешифрование по фрагментам - ОШИБКА: " << e.what() << endl;
+    }
+    
+    // 5.3 Конвейер файлов: буфер 7 байт режет двухбайтовые символы
+    string pipeIn = testDir + "/pipeline_in.txt";
+    string pipeOut = testDir + "/pipeline_out.txt";
+    try {
+        total++;
+        modAlphaCipher cipher("КЛЮЧ", TextMode::PassThrough);
+        string text;
+        for (int i = 0; i < 50; ++i) {
+            text += "Привет, МИР! 42 € ЁЖИК\n";
+        }
+        {
+            ofstream file(pipeIn, ios::binary);
+            file << text;
+        }
+        bool ok = true;
+        for (bool uring : {true, false}) {
+            PipelineOptions options;
+            options.bufferSize = 7;
+            options.queueDepth = 3;
+            options.useIoUring = uring;
+            GronsfeldStage stage(cipher, false);
+            PipelineStats stats = FilePipeline(options).run(pipeIn, pipeOut, stage);
+            ifstream file(pipeOut, ios::binary);
+            string result((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+            ok = ok && result == cipher.encrypt(text) && stats.bytesRead == text.size() &&
+                 stats.bytesWritten == text.size() && (uring || !stats.usedIoUring);
+        }
+        if (ok) {
+            cout << "✓ 5.3 Конвейер файлов (io_uring и потоки) - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 5.3 Конвейер файлов (io_uring и потоки) - ОШИБКА" << endl;
+        }
+    } catch (const exception& e) {
+        cout << "✗ 5.3 Конвейер файлов (io_uring и потоки) - ОШИБКА: " << e.what() << endl;
+    }
+    
+    // 5.4 Конвейер файлов со стадией перестановки
+    try {
+        total++;
+        RouteCipher cipher(5);
+        string text = "привет мир\nтекст для перестановки";
+        {
+            ofstream file(pipeIn, ios::binary);
+            file << text;
+        }
+        PipelineOptions options;
+        options.bufferSize = 3;
+        RouteStage stage(cipher, false);
+        FilePipeline(options).run(pipeIn, pipeOut, stage);
+        ifstream file(pipeOut, ios::binary);
+        string result((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+        wstring wide;
+        utf8ToWide(text, wide);
+        if (result == wideToUtf8(cipher.Encrypt(wide))) {
+            cout << "✓ 5.4 Конвейер со стадией перестановки - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 5.4 Конвейер со стадией перестановки - ОШИБКА" << endl;
+        }
+    } catch (const exception& e) {
+        cout << "✗ 5.4 Конвейер со стадией перестановки - ОШИБКА: " << e.what() << endl;
+    }
+    remove(pipeIn.c_str());
+    remove(pipeOut.c_str());
+    
+    // 6. Упакованный формат
+    cout << "\n6. Упакованный формат:" << endl;
+    
+    // 6.1 Шифрование в 6-битный формат и обратно
+    try {
+        total++;
+        modAlphaCipher cipher("КЛЮЧ");
+        string original = "ПРИВЕТМИРЭТОПРОВЕРКАУПАКОВКИ";
+        PackedText packed = cipher.encryptPacked(original);
+        
+        if (packed.count == 28 && packed.data.size() == 21 && cipher.decryptPacked(packed) == original &&
+            cipher.unpack(packed) == cipher.encrypt(original)) {
+            cout << "✓ 6.1 Формат 6 бит - ОК (" << packed.data.size() << " байт вместо "
+                 << original.size() << ")" << endl;
+            passed++;
+        } else {
+            cout << "✗ 6.1 Формат 6 бит - ОШИБКА" << endl;
+        }
+    } catch (const cipher_error& e) {
+        cout << "✗ 6.1 Формат 6 бит - ОШИБКА: " << e.what() << endl;
+    }
+    
+    // 6.2 Формат по основанию 33 с неполной последней тройкой
+    try {
+        total++;
+        modAlphaCipher cipher("ЯБЛОКО");
+        string original = "ЁЖИКВТУМАНЕ";
+        PackedText packed = cipher.encryptPacked(original, PackedFormat::Base33);
+        
+        if (packed.data.size() == 8 && cipher.decryptPacked(packed) == original) {
+            cout << "✓ 6.2 Формат по основанию 33 - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 6.2 Формат по основанию 33 - ОШИБКА" << endl;
+        }
+    } catch (const cipher_error& e) {
+        cout << "✗ 6.2 Формат по основанию 33 - ОШИБКА: " << e.what() << endl;
+    }
+    
+    // 6.3 Повреждённые данные (должно быть исключение)
+    try {
+        total++;
+        modAlphaCipher cipher("КЛЮЧ");
+        PackedText packed;
+        packed.count = 4;
+        packed.data = {0xFF, 0xFF, 0xFF};
+        cipher.decryptPacked(packed);
+        cout << "✗ 6.3 Повреждённые данные - ОШИБКА (должно быть исключение)" << endl;
+    } catch (const cipher_error& e) {
+        cout << "✓ 6.3 Повреждённые данные - ОК: " << e.what() << endl;
+        passed++;
+    } catch (...) {
+        cout << "✗ 6.3 Повреждённые данные - НЕВЕРНОЕ ИСКЛЮЧЕНИЕ" << endl;
+    }
+    
+    // 7. Режим сохранения символов вне алфавита
+    cout << "\n7. Сохранение символов вне алфавита:" << endl;
+    
+    // 7.1 Знаки, цифры и строчные буквы сохраняются, ключ сдвигается только на буквах
+    try {
+        total++;
+        modAlphaCipher cipher("БВ", TextMode::PassThrough);
+        string original = "ПРИВЕТ, мир! 2025 — ЁЖ";
+        string encrypted = cipher.encrypt(original);
+        
+        if (encrypted == "РТЙДЁФ, мир! 2025 — ЖИ" && cipher.decrypt(encrypted) == original) {
+            cout << "✓ 7.1 Сохранение знаков - ОК: " << encrypted << endl;
+            passed++;
+        } else {
+            cout << "✗ 7.1 Сохранение знаков - ОШИБКА: " << encrypted << endl;
+        }
+    } catch (const cipher_error& e) {
+        cout << "✗ 7.1 Сохранение знаков - ОШИБКА: " << e.what() << endl;
+    }
+    
+    // 7.2 Потоковое шифрование с сохранением знаков совпадает с обычным
+    try {
+        total++;
+        modAlphaCipher cipher("ШИФР", TextMode::PassThrough);
+        string original = "ДЛИННЫЙ ТЕКСТ, В КОТОРОМ 16 БАЙТ ПОДРЯД БЕЗ БУКВ: ................!";
+        string whole = cipher.encrypt(original);
+        
+        size_t phase = 0;
+        string streamed = cipher.encryptChunk(original.substr(0, 21), phase);
+        streamed += cipher.encryptChunk(original.substr(21), phase);
+        
+        if (streamed == whole && whole.size() == original.size()) {
+            cout << "✓ 7.2 Потоковое шифрование со знаками - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 7.2 Потоковое шифрование со знаками - ОШИБКА" << endl;
+        }
+    } catch (const cipher_error& e) {
+        cout << "✗ 7.2 Потоковое шифрование со знаками - ОШИБКА: " << e.what() << endl;
+    }
+    
+    // 8. Пакетный режим с ареной буферов
+    cout << "\n8. Пакетный режим:" << endl;
+    
+    // 8.1 Результат совпадает с encrypt, память арены переиспользуется
+    try {
+        total++;
+        modAlphaCipher cipher("АРЕНА");
+        BufferArena arena;
+        string original = "ПАКЕТНАЯ ОБРАБОТКА БОЛЬШИХ ТЕКСТОВ";
+        string_view encrypted = cipher.encryptBulk(original, arena);
+        bool same = encrypted == cipher.encrypt(original);
+        bool aligned = reinterpret_cast<uintptr_t>(encrypted.data()) % BufferArena::alignment == 0;
+        
+        arena.reset();
+        string_view decrypted = cipher.decryptBulk(cipher.encrypt(original), arena);
+        bool reused = decrypted.data() == encrypted.data() && arena.stats().regions == 1;
+        
+        if (same && aligned && reused && decrypted == cipher.decrypt(cipher.encrypt(original))) {
+            cout << "✓ 8.1 Пакетный режим - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 8.1 Пакетный режим - ОШИБКА" << endl;
+        }
+    } catch (const exception& e) {
+        cout << "✗ 8.1 Пакетный режим - ОШИБКА: " << e.what() << endl;
+    }
+    
+    // 9. Шифрование многими ключами
+    cout << "\n9. Шифрование многими ключами:" << endl;
+    
+    // 9.1 Каждый результат совпадает с encrypt своим ключом
+    try {
+        total++;
+        vector<modAlphaCipher> ciphers = {modAlphaCipher("А"), modAlphaCipher("КЛЮЧ"), modAlphaCipher("ЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯЯ")};
+        string original = "БЮЛЛЕТЕНЬ ДЛЯ ВСЕХ ПОЛУЧАТЕЛЕЙ";
+        vector<string> encrypted = modAlphaCipher::encryptFanOut(original, ciphers);
+        
+        bool same = encrypted.size() == ciphers.size();
+        for (size_t i = 0; same && i < ciphers.size(); ++i) {
+            same = encrypted[i] == ciphers[i].encrypt(original);
+        }
+        if (same) {
+            cout << "✓ 9.1 Три ключа за один проход - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 9.1 Три ключа за один проход - ОШИБКА" << endl;
+        }
+    } catch (const cipher_error& e) {
+        cout << "✗ 9.1 Три ключа за один проход - ОШИБКА: " << e.what() << endl;
+    }
+    
+    // 10. Бегущий ключ из файла
+    cout << "\n10. Бегущий ключ из файла:" << endl;
+    string keyPath = testDir + "/running_key.txt";
+    {
+        ofstream keyFile(keyPath, ios::binary);
+        keyFile << "Ключ, ключ; КЛЮЧ - ключ!\nключ ключ 42 ключ ключ";
+    }
+    
+    // 10.1 Ключ из повторов слова совпадает с обычным ключом, позиция продолжается
+    try {
+        total++;
+        RunningKeyCipher running(keyPath);
+        modAlphaCipher repeating("КЛЮЧ");
+        string first = running.encrypt("ПРИВЕТ МИР");
+        string second = running.encrypt("ПОКА");
+        if (first + second == repeating.encrypt("ПРИВЕТМИРПОКА")) {
+            cout << "✓ 10.1 Совпадение с повторяющимся ключом - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 10.1 Совпадение с повторяющимся ключом - ОШИБКА" << endl;
+        }
+    } catch (const cipher_error& e) {
+        cout << "✗ 10.1 Совпадение с повторяющимся ключом - ОШИБКА: " << e.what() << endl;
+    }
+    
+    // 10.2 Дешифрование со смещения и исчерпание ключа
+    try {
+        total++;
+        RunningKeyCipher sender(keyPath, 6);
+        uint64_t start = sender.position();
+        string encrypted = sender.encrypt("ШИФР");
+        RunningKeyCipher receiver(keyPath);
+        receiver.seek(start);
+        bool ok = receiver.decrypt(encrypted) == "ШИФР";
+        
+        uint64_t before = receiver.position();
+        try {
+            receiver.encrypt(string(200, ' ') + "ОЧЕНЬДЛИННОЕСООБЩЕНИЕДЛЯКОРОТКОГОКЛЮЧАИЗФАЙЛА");
+            ok = false;
+        } catch (const cipher_error&) {
+            ok = ok && receiver.position() == before;
+        }
+        if (ok) {
+            cout << "✓ 10.2 Смещение и исчерпание ключа - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 10.2 Смещение и исчерпание ключа - ОШИБКА" << endl;
+        }
+    } catch (const cipher_error& e) {
+        cout << "✗ 10.2 Смещение и исчерпание ключа - ОШИБКА: " << e.what() << endl;
+    }
+    remove(keyPath.c_str());
+    
+    // 11. Восстановление ключа по известному открытому тексту
+    cout << "\n11. Восстановление ключа:" << endl;
+    
+    // 11.1 Находится кратчайший ключ, повтор ключа не мешает
+    try {
+        total++;
+        string original = "ИЗВЕСТНЫЙ ОТКРЫТЫЙ ТЕКСТ И ЕГО ШИФР";
+        modAlphaCipher cipher("КЛЮЧКЛЮЧ");
+        string key = modAlphaCipher::recoverKey(original, cipher.encrypt(original));
+        vector<string> keys = modAlphaCipher::recoverKeys({{original, cipher.encrypt(original)},
+                                                           {"ПРИВЕТ", modAlphaCipher("ЯЯ").encrypt("ПРИВЕТ")}});
+        if (key == "КЛЮЧ" && keys.size() == 2 && keys[0] == "КЛЮЧ" && keys[1] == "Я") {
+            cout << "✓ 11.1 Кратчайший ключ - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 11.1 Кратчайший ключ - ОШИБКА (" << key << ")" << endl;
+        }
+    } catch (const cipher_error& e) {
+        cout << "✗ 11.1 Кратчайший ключ - ОШИБКА: " << e.what() << endl;
+    }
+    
+    // 11.2 Пара с разным количеством букв (должно быть исключение)
+    try {
+        total++;
+        modAlphaCipher::recoverKey("АБВ", "АБ");
+        cout << "✗ 11.2 Невыровненная пара - ОШИБКА: исключение не выброшено" << endl;
+    } catch (const cipher_error& e) {
+        cout << "✓ 11.2 Невыровненная пара - ОК: " << e.what() << endl;
+        passed++;
+    }
+    
+    // 12. Инкрементальное шифрование документа
+    cout << "\n12. Инкрементальное шифрование документа:" << endl;
+    
+    // 12.1 После вставок и удалений шифротекст совпадает с encrypt
+    try {
+        total++;
+        modAlphaCipher cipher("ПРАВКА");
+        string text = "ПЕРВАЯ СТРОКА ДОКУМЕНТА";
+        EncryptedDocument document(cipher, text);
+        document.insert(6, " НОВАЯ");
+        text.insert(6, " НОВАЯ");
+        document.erase(0, 7);
+        text.erase(0, 7);
+        document.insert(document.size(), " КОНЕЦ");
+        text += " КОНЕЦ";
+        
+        bool same = document.text() == text && document.encrypted() == cipher.encrypt(text);
+        size_t phase = cipher.countLetters(text.substr(0, 8));
+        bool range = document.encryptedRange(8, 9) == cipher.encryptChunk(text.substr(8, 9), phase);
+        if (same && range) {
+            cout << "✓ 12.1 Правки документа - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 12.1 Правки документа - ОШИБКА" << endl;
+        }
+    } catch (const cipher_error& e) {
+        cout << "✗ 12.1 Правки документа - ОШИБКА: " << e.what() << endl;
+    }
+    
+    // 12.2 Вставка в конец не перешифровывает предыдущие куски
+    try {
+        total++;
+        modAlphaCipher cipher("КЛЮЧ");
+        EncryptedDocument document(cipher, string(10000, ' ') + "АБВГД");
+        document.encrypted();
+        size_t before = document.pieceEncryptions();
+        document.insert(document.size(), "Е");
+        document.encrypted();
+        if (document.pieceEncryptions() - before == 1) {
+            cout << "✓ 12.2 Перешифрование только изменённого - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 12.2 Перешифрование только изменённого - ОШИБКА" << endl;
+        }
+    } catch (const cipher_error& e) {
+        cout << "✗ 12.2 Перешифрование только изменённого - ОШИБКА: " << e.what() << endl;
+    }
+    
+    // 13. Гистограммы задержек
+    cout << "\n13. Гистограммы задержек:" << endl;
+    
+    // 13.1 Перцентили с точностью до корзины, сложение гистограмм
+    total++;
+    {
+        LatencyHistogram first;
+        LatencyHistogram second;
+        for (uint64_t v = 1; v <= 1000; ++v) {
+            first.record(v * 1000);
+        }
+        second.record(5000000, 10);
+        first.merge(second);
+        uint64_t p50 = first.percentile(50);
+        uint64_t tail = first.percentile(99.5);
+        if (first.count() == 1010 && p50 >= 505000 && p50 <= 505000 + 505000 / 32 &&
+            tail == first.max() && first.max() == 5000000 && first.min() == 1000) {
+            cout << "✓ 13.1 Перцентили и сложение - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 13.1 Перцентили и сложение - ОШИБКА" << endl;
+        }
+    }
+    
+    // 13.2 Вызовы шифра записываются только при включённой записи
+    total++;
+    try {
+        modAlphaCipher cipher("КЛЮЧ");
+        LatencyRecorder::reset();
+        cipher.encrypt("ПРИВЕТ");
+        LatencyRecorder::enable();
+        cipher.encrypt("ПРИВЕТ");
+        cipher.encrypt(string(2500, ' ') + "ПРИВЕТ");
+        LatencyRecorder::enable(false);
+        size_t small = LatencyRecorder::sizeClass(12);
+        size_t large = LatencyRecorder::sizeClass(2512);
+        if (LatencyRecorder::snapshot(LatencyOp::GronsfeldEncrypt, small).count() == 1 &&
+            LatencyRecorder::snapshot(LatencyOp::GronsfeldEncrypt, large).count() == 1 &&
+            LatencyRecorder::snapshot(LatencyOp::GronsfeldEncrypt).count() == 2 &&
+            LatencyRecorder::report().find("gronsfeld.encrypt") != string::npos) {
+            cout << "✓ 13.2 Запись задержек шифра - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 13.2 Запись задержек шифра - ОШИБКА" << endl;
+        }
+    } catch (const cipher_error& e) {
+        cout << "✗ 13.2 Запись задержек шифра - ОШИБКА: " << e.what() << endl;
+    }
+    
+    // 14. Демон шифрования
+    cout << "\n14. Демон шифрования:" << endl;
+    
+    // 14.1 Конвейер запросов глубже размера пакета получает все ответы
+    total++;
+    try {
+        string socketPath = testDir + "/daemon.sock";
+        CipherDaemon daemon(socketPath, 4);
+        thread loop([&daemon]() { daemon.run(); });
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        memcpy(addr.sun_path, socketPath.c_str(), socketPath.size());
+        timeval wait = {5, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &wait, sizeof(wait));
+        bool ok = connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+        
+        const int depth = 100;
+        modAlphaCipher cipher("КЛЮЧ");
+        string requests;
+        vector<string> expected;
+        for (int i = 0; i < depth; ++i) {
+            // Тексты разной длины и ошибочный текст внутри одной группы:
+            // фаза ключа начинается заново для каждого запроса
+            string text = string(i % 7 + 1, ' ');
+            for (int k = 0; k <= i % 3; ++k) {
+                text += "ПРИВЕТ";
+            }
+            if (i % 10 == 9) {
+                text += "1";
+            }
+            appendRequest(requests, CipherOp::GronsfeldEncrypt, "КЛЮЧ", text);
+            expected.push_back(i % 10 == 9 ? string() : cipher.encrypt(text));
+        }
+        for (size_t sent = 0; ok && sent < requests.size();) {
+            ssize_t n = send(fd, requests.data() + sent, requests.size() - sent, MSG_NOSIGNAL);
+            if (n > 0) {
+                sent += static_cast<size_t>(n);
+            } else if (n < 0 && errno != EINTR) {
+                ok = false;
+            }
+        }
+        string replies;
+        int answered = 0;
+        char buf[4096];
+        while (ok && answered < depth) {
+            ssize_t n = recv(fd, buf, sizeof(buf), 0);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                ok = false;
+                break;
+            }
+            replies.append(buf, static_cast<size_t>(n));
+            while (replies.size() >= frameHeaderSize &&
+                   replies.size() - frameHeaderSize >= getFrameLength(replies.data())) {
+                uint32_t len = getFrameLength(replies.data());
+                if (expected[answered].empty()) {
+                    ok = ok && len >= 1 && replies[frameHeaderSize] == static_cast<char>(CipherStatus::CipherError);
+                } else {
+                    ok = ok && len >= 1 && replies[frameHeaderSize] == static_cast<char>(CipherStatus::Ok) &&
+                         replies.substr(frameHeaderSize + 1, len - 1) == expected[answered];
+                }
+                replies.erase(0, frameHeaderSize + len);
+                ++answered;
+            }
+        }
+        close(fd);
+        daemon.stop();
+        loop.join();
+        if (ok && answered == depth && daemon.stats().batches >= depth / 4) {
+            cout << "✓ 14.1 Конвейер запросов глубже пакета - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 14.1 Конвейер запросов глубже пакета - ОШИБКА" << endl;
+        }
+    } catch (const exception& e) {
+        cout << "✗ 14.1 Конвейер запросов глубже пакета - ОШИБКА: " << e.what() << endl;
+    }
+    
+    // 14.2 Клиент, не читающий ответы, упирается в предел неотправленных ответов
+    total++;
+    try {
+        string socketPath = testDir + "/daemon.sock";
+        CipherDaemon daemon(socketPath, 16, 1024, 4096);
+        thread loop([&daemon]() { daemon.run(); });
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        memcpy(addr.sun_path, socketPath.c_str(), socketPath.size());
+        timeval wait = {5, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &wait, sizeof(wait));
+        bool ok = connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+        
+        const int depth = 3000;
+        string text;
+        for (int i = 0; i < 50; ++i) {
+            text += "ПРИВЕТ";
+        }
+        modAlphaCipher cipher("КЛЮЧ");
+        string expected = cipher.encrypt(text);
+        string requests;
+        for (int i = 0; i < depth; ++i) {
+            appendRequest(requests, CipherOp::GronsfeldEncrypt, "КЛЮЧ", text);
+        }
+        // Отправка без чтения ответов, пока сокет не перестанет принимать данные
+        size_t sent = 0;
+        int idle = 0;
+        while (ok && sent < requests.size() && idle < 20) {
+            ssize_t n = send(fd, requests.data() + sent, requests.size() - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (n > 0) {
+                sent += static_cast<size_t>(n);
+                idle = 0;
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                ++idle;
+                this_thread::sleep_for(chrono::milliseconds(10));
+            } else {
+                ok = false;
+            }
+        }
+        bool stalled = sent < requests.size();
+        thread sender([&]() {
+            while (sent < requests.size()) {
+                ssize_t n = send(fd, requests.data() + sent, requests.size() - sent, MSG_NOSIGNAL);
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (n <= 0) {
+                    break;
+                }
+                sent += static_cast<size_t>(n);
+            }
+        });
+        string replies;
+        int answered = 0;
+        char buf[65536];
+        while (ok && answered < depth) {
+            ssize_t n = recv(fd, buf, sizeof(buf), 0);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                ok = false;
+                break;
+            }
+            replies.append(buf, static_cast<size_t>(n));
+            size_t pos = 0;
+            while (replies.size() - pos >= frameHeaderSize &&
+                   replies.size() - pos - frameHeaderSize >= getFrameLength(replies.data() + pos)) {
+                uint32_t len = getFrameLength(replies.data() + pos);
+                ok = ok && len >= 1 && replies[pos + frameHeaderSize] == static_cast<char>(CipherStatus::Ok) &&
+                     replies.compare(pos + frameHeaderSize + 1, len - 1, expected) == 0;
+                pos += frameHeaderSize + len;
+                ++answered;
+            }
+            replies.erase(0, pos);
+        }
+        shutdown(fd, SHUT_RDWR);
+        sender.join();
+        close(fd);
+        daemon.stop();
+        loop.join();
+        if (ok && stalled && answered == depth && daemon.stats().throttled > 0) {
+            cout << "✓ 14.2 Предел неотправленных ответов - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 14.2 Предел неотправленных ответов - ОШИБКА" << endl;
+        }
+    } catch (const exception& e) {
+        cout << "✗ 14.2 Предел неотправленных ответов - ОШИБКА: " << e.what() << endl;
+    }
+    
+    // 15. Составной шифр
+    cout << "\n15. Составной шифр:" << endl;
+    
+    // 15.1 Совпадение с последовательным применением шифров
+    total++;
+    try {
+        bool ok = true;
+        modAlphaCipher substitution("КЛЮЧ");
+        const string texts[] = {"ПРИВЕТ МИР", "А", "ШИФРОВАНИЕ ПЕРЕСТАНОВКОЙ", "ЁЖ"};
+        for (const string& text : texts) {
+            for (int columns : {1, 2, 4, 7, 30}) {
+                CascadeCipher cascade("КЛЮЧ", columns);
+                RouteCipher route(columns);
+                wstring wide;
+                utf8ToWide(substitution.encrypt(text), wide);
+                wstring expected = route.Encrypt(wide);
+                string encrypted = cascade.encrypt(text);
+                ok = ok && encrypted == wideToUtf8(expected) &&
+                     cascade.decrypt(encrypted) == substitution.decrypt(wideToUtf8(route.Decrypt(expected)));
+            }
+        }
+        if (ok) {
+            cout << "✓ 15.1 Совпадение с последовательным применением - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 15.1 Совпадение с последовательным применением - ОШИБКА" << endl;
+        }
+    } catch (const exception& e) {
+        cout << "✗ 15.1 Совпадение с последовательным применением - ОШИБКА: " << e.what() << endl;
+    }
+    
+    // 15.2 Дешифрование строчного шифротекста с заполнителями
+    total++;
+    try {
+        modAlphaCipher substitution("КЛЮЧ");
+        CascadeCipher cascade("КЛЮЧ", 4);
+        RouteCipher route(4);
+        string encrypted = cascade.encrypt("ПРИВЕТ МИР");
+        wstring wide;
+        utf8ToWide(encrypted, wide);
+        for (wchar_t& c : wide) {
+            if (c >= L'А' && c <= L'Я') {
+                c += L'а' - L'А';
+            } else if (c == L'Ё') {
+                c = L'ё';
+            } else if (c == L'X') {
+                c = L'x';
+            }
+        }
+        string lower = wideToUtf8(wide);
+        string expected = substitution.decrypt(wideToUtf8(route.Decrypt(wide)));
+        if (encrypted.find('X') != string::npos && lower != encrypted &&
+            cascade.decrypt(lower) == expected && expected == "ПРИВЕТМИР") {
+            cout << "✓ 15.2 Строчный шифротекст с заполнителями - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 15.2 Строчный шифротекст с заполнителями - ОШИБКА" << endl;
+        }
+    } catch (const exception& e) {
+        cout << "✗ 15.2 Строчный шифротекст с заполнителями - ОШИБКА: " << e.what() << endl;
+    }
+    
+    // 16. Контейнер шифротекста
+    cout << "\n16. Контейнер шифротекста:" << endl;
+    
+    // 16.1 Создание и дешифрование контейнера
+    try {
+        total++;
+        modAlphaCipher gronsfeld("КЛЮЧ");
+        RouteCipher route(4);
+        string text = "СЪЕШЬ ЖЕ ЕЩЁ ЭТИХ МЯГКИХ ФРАНЦУЗСКИХ БУЛОК";
+        CipherContainer letters(CipherContainer::create(gronsfeld, text, 5));
+        CipherContainer cells(CipherContainer::create(route, "съешь же ещё этих мягких", 3));
+        if (letters.index().size() == 8 && letters.decrypt(gronsfeld, 3) == gronsfeld.decrypt(gronsfeld.encrypt(text)) &&
+            cells.decrypt(route, 2) == "СЪЕШЬЖЕЕЩЁЭТИХМЯГКИХ") {
+            cout << "✓ 16.1 Создание и дешифрование - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 16.1 Создание и дешифрование - ОШИБКА" << endl;
+        }
+    } catch (const exception& e) {
+        cout << "✗ 16.1 Создание и дешифрование - ОШИБКА: " << e.what() << endl;
+    }
+    
+    // 16.2 Дешифрование диапазона через границы блоков
+    try {
+        total++;
+        modAlphaCipher gronsfeld("КЛЮЧ");
+        RouteCipher route(3);
+        string plain = "ВЕКТОРИЗАЦИЯРАЗБИЕНИЕНАБЛОКИ";
+        CipherContainer letters(CipherContainer::create(gronsfeld, plain, 4));
+        CipherContainer cells(CipherContainer::create(route, plain, 5));
+        bool ok = true;
+        for (uint64_t first = 0; first < letters.length(); first += 3) {
+            for (uint64_t count : {uint64_t(0), uint64_t(1), uint64_t(6)}) {
+                if (first + count > letters.length()) {
+                    continue;
+                }
+                string expected = plain.substr(first * 2, count * 2);
+                ok = ok && letters.decryptRange(gronsfeld, first, count) == expected &&
+                     cells.decryptRange(route, first, count) == expected;
+            }
+        }
+        if (ok) {
+            cout << "✓ 16.2 Дешифрование диапазона - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 16.2 Дешифрование диапазона - ОШИБКА" << endl;
+        }
+    } catch (const exception& e) {
+        cout << "✗ 16.2 Дешифрование диапазона - ОШИБКА: " << e.what() << endl;
+    }
+    
+    // 16.3 Контейнер другого ключа или шифра
+    try {
+        total++;
+        CipherContainer letters(CipherContainer::create(modAlphaCipher("КЛЮЧ"), "ПРИВЕТ", 2));
+        RouteCipher sameRoute(3);
+        RouteCipher otherRoute(4);
+        CipherContainer cells(CipherContainer::create(sameRoute, "ПРИВЕТ", 2));
+        int rejected = 0;
+        try { letters.decrypt(modAlphaCipher("ЗАМОК")); } catch (const container_error&) { rejected++; }
+        try { letters.decryptRange(modAlphaCipher("ЗАМОК"), 0, 1); } catch (const container_error&) { rejected++; }
+        try { letters.decrypt(sameRoute); } catch (const container_error&) { rejected++; }
+        try { cells.decrypt(otherRoute); } catch (const container_error&) { rejected++; }
+        try { cells.decrypt(modAlphaCipher("КЛЮЧ")); } catch (const container_error&) { rejected++; }
+        if (rejected == 5) {
+            cout << "✓ 16.3 Несовпадение ключа или шифра - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 16.3 Несовпадение ключа или шифра - ОШИБКА" << endl;
+        }
+    } catch (const exception& e) {
+        cout << "✗ 16.3 Несовпадение ключа или шифра - ОШИБКА: " << e.what() << endl;
+    }
+    
+    // 16.4 Повреждённый индекс
+    try {
+        total++;
+        string valid = CipherContainer::create(modAlphaCipher("КЛЮЧ"), "ШИФРОВАНИЕ", 3);
+        auto patch = [](string bytes, size_t pos, uint64_t value, int width) {
+            for (int i = 0; i < width; ++i) {
+                bytes[pos + i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+            }
+            return bytes;
+        };
+        size_t footer = valid.size() - 16;
+        uint64_t indexOffset = footer - 4 * 24;
+        // Количество блоков, при котором indexOffset + count * 24 переполняется
+        uint64_t hugeCount = 1000;
+        vector<string> broken = {
+            valid.substr(0, valid.size() - 1),
+            patch(valid, footer, indexOffset + 1, 8),
+            patch(valid, 28, 5, 4),
+            patch(valid, indexOffset + 24, 0, 8),
+            patch(valid, indexOffset + 8, 0xFFFFFFFF, 4),
+            patch(patch(valid, 28, hugeCount, 4), footer, footer - hugeCount * 24, 8)
+        };
+        int rejected = 0;
+        for (const string& bytes : broken) {
+            try {
+                CipherContainer container(bytes);
+            } catch (const container_error&) {
+                rejected++;
+            }
+        }
+        if (rejected == static_cast<int>(broken.size())) {
+            cout << "✓ 16.4 Повреждённый индекс - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 16.4 Повреждённый индекс - ОШИБКА" << endl;
+        }
+    } catch (const exception& e) {
+        cout << "✗ 16.4 Повреждённый индекс - ОШИБКА: " << e.what() << endl;
+    }
+    
+    // 16.5 Режим PassThrough не поддерживается контейнером
+    try {
+        total++;
+        modAlphaCipher cipher("КЛЮЧ", TextMode::PassThrough);
+        CipherContainer::create(cipher, "1А2Б3ВГДabc ЕЖЗ", 2);
+        cout << "✗ 16.5 Контейнер в режиме PassThrough - ОШИБКА (должно быть исключение)" << endl;
+    } catch (const container_error& e) {
+        string valid = CipherContainer::create(modAlphaCipher("КЛЮЧ"), "АБВГДЕЖЗ", 2);
+        valid[7] = static_cast<char>(TextMode::PassThrough);
+        try {
+            CipherContainer container(valid);
+            cout << "✗ 16.5 Контейнер в режиме PassThrough - ОШИБКА (режим в заголовке не проверен)" << endl;
+        } catch (const container_error&) {
+            cout << "✓ 16.5 Контейнер в режиме PassThrough - ОК: " << e.what() << endl;
+            passed++;
+        }
+    } catch (...) {
+        cout << "✗ 16.5 Контейнер в режиме PassThrough - НЕВЕРНОЕ ИСКЛЮЧЕНИЕ" << endl;
+    }
+    
+    // 17. Автонастройка реализаций
+    cout << "\n17. Автонастройка реализаций:" << endl;
+    string profile = testDir + "/autotune.profile";
+    {
+        // Профиль с диапазонами для каждой реализации, чтобы не ждать калибровки
+        unsigned hardware = max(1u, thread::hardware_concurrency());
+        ofstream file(profile);
+        file << "lb4-autotune 1\nhardware " << hardware << "\n"
+             << "gronsfeld 64 0 1\ngronsfeld 256 1 1\ngronsfeld 1000000 1 3\n"
+             << "route 64 0 1\nroute 1000000 1 8\n";
+    }
+    
+    // 17.1 Шифр Гронсфельда совпадает с прямыми вызовами
+    try {
+        total++;
+        AutoTuner tuner(profile);
+        modAlphaCipher cipher("КЛЮЧ");
+        bool ok = tuner.gronsfeldChoice(1000).param == 3;
+        for (int repeat : {1, 10, 100}) {
+            string text;
+            for (int i = 0; i < repeat; ++i) {
+                text += "ПРИВЕТ МИР ";
+            }
+            string encrypted = cipher.encrypt(text);
+            ok = ok && tuner.encrypt(cipher, text) == encrypted && tuner.decrypt(cipher, encrypted) == cipher.decrypt(encrypted);
+        }
+        if (ok) {
+            cout << "✓ 17.1 Шифр Гронсфельда через автонастройку - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 17.1 Шифр Гронсфельда через автонастройку - ОШИБКА" << endl;
+        }
+    } catch (const exception& e) {
+        cout << "✗ 17.1 Шифр Гронсфельда через автонастройку - ОШИБКА: " << e.what() << endl;
+    }
+    
+    // 17.2 Перестановка совпадает с прямыми вызовами и не меняет шифр
+    try {
+        total++;
+        AutoTuner tuner(profile);
+        bool ok = true;
+        for (int columns : {5, 20}) {
+            for (size_t length : {size_t(20), size_t(500)}) {
+                RouteCipher cipher(columns);
+                wstring text;
+                for (size_t i = 0; i < length; ++i) {
+                    text += static_cast<wchar_t>(L'А' + i % 32);
+                }
+                wstring encrypted = cipher.Encrypt(text);
+                ok = ok && tuner.encryptRoute(cipher, text) == encrypted &&
+                     tuner.decryptRoute(cipher, encrypted) == cipher.Decrypt(encrypted) && cipher.GetTile() == 32;
+            }
+        }
+        if (ok) {
+            cout << "✓ 17.2 Перестановка через автонастройку - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 17.2 Перестановка через автонастройку - ОШИБКА" << endl;
+        }
+    } catch (const exception& e) {
+        cout << "✗ 17.2 Перестановка через автонастройку - ОШИБКА: " << e.what() << endl;
+    }
+    // 17.3 Сохранение и повторная загрузка профиля
+    try {
+        total++;
+        AutoTuner writer(profile);
+        bool ok = writer.load() && writer.save();
+        AutoTuner reader(profile);
+        ok = ok && reader.load() && reader.routeChoice(1000).param == 8;
+        // Временные файлы mkstemp не остаются рядом с профилем
+        filesystem::path profilePath = filesystem::absolute(profile);
+        for (const auto& entry : filesystem::directory_iterator(profilePath.parent_path())) {
+            ok = ok && entry.path().filename().string().rfind(profilePath.filename().string() + ".", 0) != 0;
+        }
+        if (ok) {
+            cout << "✓ 17.3 Сохранение и загрузка профиля - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 17.3 Сохранение и загрузка профиля - ОШИБКА" << endl;
+        }
+    } catch (const exception& e) {
+        cout << "✗ 17.3 Сохранение и загрузка профиля - ОШИБКА: " << e.what() << endl;
+    }
+    remove(profile.c_str());
+    
+    // 18. Пакетная обработка каталогов
+    cout << "\n18. Пакетная обработка каталогов:" << endl;
+    string batchIn = testDir + "/batch_in";
+    string batchOut = testDir + "/batch_out";
+    vector<pair<string, string>> batchFiles;
+    {
+        string large;
+        for (int i = 0; i < 700; ++i) {
+            large += i % 5 == 0 ? "ШИФРОВАНИЕ КАТАЛОГА " : "ПРИВЕТ МИР ";
+        }
+        batchFiles = {{"large.txt", large}, {"sub/small.txt", "ЁЖИК В ТУМАНЕ"}, {"sub/deep/empty.txt", ""}};
+        filesystem::create_directories(batchIn + "/sub/deep");
+        for (const auto& file : batchFiles) {
+            ofstream(batchIn + "/" + file.first, ios::binary) << file.second;
+        }
+    }
+    auto readBatchOutput = [&](const string& name) {
+        ifstream file(batchOut + "/" + name, ios::binary);
+        return string((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    };
+    
+    // 18.1 Шифр Гронсфельда совпадает с encrypt при разных размерах задач
+    try {
+        total++;
+        bool ok = true;
+        for (TextMode mode : {TextMode::Strict, TextMode::PassThrough}) {
+            modAlphaCipher cipher("КЛЮЧ", mode);
+            for (size_t chunkSize : {size_t(16), size_t(1000), size_t(1) << 20}) {
+                BatchOptions options;
+                options.threads = 3;
+                options.chunkSize = chunkSize;
+                options.sync = false;
+                BatchReport report = BatchProcessor(cipher, options).run(batchIn, batchOut);
+                ok = ok && report.files == batchFiles.size() && report.failedFiles == 0;
+                for (const auto& file : batchFiles) {
+                    string expected = file.second.empty() ? string() : cipher.encrypt(file.second);
+                    ok = ok && readBatchOutput(file.first) == expected;
+                }
+                filesystem::remove_all(batchOut);
+            }
+        }
+        if (ok) {
+            cout << "✓ 18.1 Пакетный шифр Гронсфельда - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 18.1 Пакетный шифр Гронсфельда - ОШИБКА" << endl;
+        }
+    } catch (const exception& e) {
+        cout << "✗ 18.1 Пакетный шифр Гронсфельда - ОШИБКА: " << e.what() << endl;
+    }
+    
+    // 18.2 Перестановка совпадает с EncryptFramed при разных размерах задач
+    try {
+        total++;
+        RouteCipher cipher(7);
+        bool ok = true;
+        for (size_t chunkSize : {size_t(16), size_t(1000), size_t(1) << 20}) {
+            BatchOptions options;
+            options.threads = 3;
+            options.chunkSize = chunkSize;
+            options.frameRows = 4;
+            options.sync = false;
+            BatchReport report = BatchProcessor(cipher, options).run(batchIn, batchOut);
+            ok = ok && report.files == batchFiles.size() && report.failedFiles == 0;
+            for (const auto& file : batchFiles) {
+                wstring wide;
+                utf8ToWide(file.second, wide);
+                string expected = wide.empty() ? string() : wideToUtf8(cipher.EncryptFramed(wide, options.frameRows));
+                ok = ok && readBatchOutput(file.first) == expected;
+            }
+            filesystem::remove_all(batchOut);
+        }
+        if (ok) {
+            cout << "✓ 18.2 Пакетная перестановка - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 18.2 Пакетная перестановка - ОШИБКА" << endl;
+        }
+    } catch (const exception& e) {
+        cout << "✗ 18.2 Пакетная перестановка - ОШИБКА: " << e.what() << endl;
+    }
+    
+    // 18.3 Дешифрование зашифрованного каталога при разных размерах задач
+    try {
+        total++;
+        string batchBack = testDir + "/batch_back";
+        auto readBack = [&](const string& name) {
+            ifstream file(batchBack + "/" + name, ios::binary);
+            return string((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+        };
+        modAlphaCipher gronsfeld("КЛЮЧ", TextMode::PassThrough);
+        RouteCipher route(7);
+        bool ok = true;
+        for (size_t chunkSize : {size_t(16), size_t(200), size_t(1000), size_t(1) << 20}) {
+            BatchOptions options;
+            options.threads = 3;
+            options.chunkSize = chunkSize;
+            options.frameRows = 4;
+            options.sync = false;
+            BatchOptions reverse = options;
+            reverse.decrypting = true;
+
+            BatchProcessor(gronsfeld, options).run(batchIn, batchOut);
+            BatchReport report = BatchProcessor(gronsfeld, reverse).run(batchOut, batchBack);
+            ok = ok && report.files == batchFiles.size() && report.failedFiles == 0;
+            for (const auto& file : batchFiles) {
+                ok = ok && readBack(file.first) == file.second;
+            }
+            filesystem::remove_all(batchOut);
+            filesystem::remove_all(batchBack);
+
+            BatchProcessor(route, options).run(batchIn, batchOut);
+            report = BatchProcessor(route, reverse).run(batchOut, batchBack);
+            ok = ok && report.files == batchFiles.size() && report.failedFiles == 0;
+            for (const auto& file : batchFiles) {
+                wstring wide;
+                utf8ToWide(file.second, wide);
+                string expected = wide.empty() ? string() : wideToUtf8(route.PrepareText(wide));
+                ok = ok && readBack(file.first) == expected;
+            }
+            filesystem::remove_all(batchOut);
+            filesystem::remove_all(batchBack);
+        }
+        if (ok) {
+            cout << "✓ 18.3 Пакетное дешифрование - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 18.3 Пакетное дешифрование - ОШИБКА" << endl;
+        }
+    } catch (const exception& e) {
+        cout << "✗ 18.3 Пакетное дешифрование - ОШИБКА: " << e.what() << endl;
+    }
+    
+    // 19. Критерий Манна-Уитни
+    cout << "\n19. Критерий Манна-Уитни:" << endl;
+    
+    // 19.1 Точные вероятности совпадают с перечислением перестановок
+    try {
+        total++;
+        auto near = [](double a, double b) { return fabs(a - b) < 1e-9; };
+        bool ok = near(exactP(5, 5, 0), 2.0 / 252) && near(exactP(5, 5, 2), 8.0 / 252) &&
+                  near(exactP(5, 5, 3), 14.0 / 252) && near(exactP(4, 4, 0), 2.0 / 70) &&
+                  near(exactP(3, 3, 4.5), 1.0) && near(exactP(3, 3, 9), 2.0 / 20);
+        if (ok) {
+            cout << "✓ 19.1 Точное распределение U - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 19.1 Точное распределение U - ОШИБКА" << endl;
+        }
+    } catch (const exception& e) {
+        cout << "✗ 19.1 Точное распределение U - ОШИБКА: " << e.what() << endl;
+    }
+    
+    // 19.2 Критические значения U для alpha = 0.05 (двусторонний) по таблице
+    try {
+        total++;
+        bool ok = true;
+        for (auto [n, critical] : {pair<size_t, double>{5, 2}, {10, 23}, {15, 64}, {20, 127}}) {
+            ok = ok && exactP(n, n, critical) <= 0.05 && exactP(n, n, critical + 1) > 0.05;
+        }
+        if (ok) {
+            cout << "✓ 19.2 Табличные критические значения - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 19.2 Табличные критические значения - ОШИБКА" << endl;
+        }
+    } catch (const exception& e) {
+        cout << "✗ 19.2 Табличные критические значения - ОШИБКА: " << e.what() << endl;
+    }
+    
+    // 19.3 mannWhitney на разделённых, совпадающих и одинаковых выборках
+    try {
+        total++;
+        MannWhitney separated = mannWhitney({1, 2, 3, 4, 5}, {6, 7, 8, 9, 10});
+        MannWhitney reversed = mannWhitney({6, 7, 8, 9, 10}, {1, 2, 3, 4, 5});
+        MannWhitney tied = mannWhitney(vector<double>(8, 1.0), vector<double>(8, 1.0));
+        MannWhitney mixed = mannWhitney({1, 3, 5, 7, 9}, {2, 4, 6, 8, 10});
+        bool ok = separated.u == 0 && fabs(separated.p - 2.0 / 252) < 1e-9 &&
+                  reversed.u == 25 && fabs(reversed.p - separated.p) < 1e-12 &&
+                  tied.p == 1.0 && mixed.p > 0.5;
+        if (ok) {
+            cout << "✓ 19.3 Статистика U и p-значение - ОК" << endl;
+            passed++;
+        } else {
+            cout << "✗ 19.3 Статистика U и p-значение - ОШИБКА" << endl;
+        }
+    } catch (const exception& e) {
+        cout << "✗ 19.3 Статистика U и p-значение - ОШИБКА: " << e.what() << endl;
+    }
+    
+    filesystem::remove_all(testDir);
+    
     // Итоги тестирования
     cout << "\n========================================" << endl;
     cout << "ИТОГИ ТЕСТИРОВАНИЯ:" << endl;
@@ -9,9 +9,16 @@
  */
 
 #include "modAlphaCipher.h"
+#include "BufferArena.h"
+#include "LatencyHistogram.h"
 #include <stdexcept>
 #include <locale>
 #include <codecvt>
+#include <cstring>
+#include <algorithm>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 using namespace std;
 
@@ -31,6 +38,33 @@ string modAlphaCipher::removeSpaces(const string& s) const
     return result;
 }
 
+/**
+ * @brief Построение таблицы декодирования алфавита
+ * @details Все буквы алфавита занимают в UTF-8 два байта, поэтому
+ *          поиск символа сводится к одному обращению к таблице
+ *          размером 2048 элементов вместо перебора алфавита
+ */
+void modAlphaCipher::buildDecodeTable()
+{
+    decodeTable.assign(1 << 11, -1);
+    for (size_t pos = 0; pos + 1 < numAlpha.size(); pos += 2) {
+        unsigned char lead = static_cast<unsigned char>(numAlpha[pos]);
+        unsigned char trail = static_cast<unsigned char>(numAlpha[pos + 1]);
+        decodeTable[((lead & 0x1F) << 6) | (trail & 0x3F)] = static_cast<signed char>(pos / 2);
+    }
+
+    // Если все буквы начинаются с одного байта, ищется только он
+    leadMask = 0xFF;
+    leadValue = static_cast<unsigned char>(numAlpha[0]);
+    for (size_t pos = 0; pos < numAlpha.size(); pos += 2) {
+        if (static_cast<unsigned char>(numAlpha[pos]) != leadValue) {
+            leadMask = 0xE0;
+            leadValue = 0xC0;
+            break;
+        }
+    }
+}
+
 /**
  * @brief Преобразование текста в числовые индексы
  * @param [in] text Текст для преобразования
@@ -40,6 +74,7 @@ string modAlphaCipher::removeSpaces(const string& s) const
 vector<int> modAlphaCipher::textToIndices(const string& text) const
 {
     vector<int> indices;
+    indices.reserve(text.size() / 2);
     
     // Русские буквы в UTF-8 занимают 2 байта
     size_t i = 0;
@@ -48,21 +83,12 @@ vector<int> modAlphaCipher::textToIndices(const string& text) const
             throw cipher_error("Invalid character sequence in input");
         }
         
-        string letter = text.substr(i, 2);
-        bool found = false;
-        
-        // Поиск символа в алфавите
-        for (size_t pos = 0; pos < numAlpha.size(); pos += 2) {
-            if (numAlpha.substr(pos, 2) == letter) {
-                indices.push_back(static_cast<int>(pos / 2));
-                found = true;
-                break;
-            }
-        }
-
-        if (!found) {
+        int idx = decodeLetter(static_cast<unsigned char>(text[i]),
+                               static_cast<unsigned char>(text[i + 1]));
+        if (idx < 0) {
             throw cipher_error("Invalid character in input (not a Russian uppercase letter)");
         }
+        indices.push_back(idx);
 
         i += 2;
     }
@@ -93,10 +119,12 @@ string modAlphaCipher::indicesToText(const vector<int>& indices) const
 /**
  * @brief Основной конструктор с ключом
  * @param [in] skey Ключ шифрования в виде строки
+ * @param [in] textMode Режим обработки символов вне алфавита
  * @throw cipher_error если ключ пуст или содержит недопустимые символы
  */
-modAlphaCipher::modAlphaCipher(const string& skey)
+modAlphaCipher::modAlphaCipher(const string& skey, TextMode textMode) : mode(textMode)
 {
+    buildDecodeTable();
     string cleanKey = removeSpaces(skey);
     if (cleanKey.empty()) {
         throw cipher_error("Empty key");
@@ -112,6 +140,15 @@ modAlphaCipher::modAlphaCipher(const string& skey)
  */
 string modAlphaCipher::encrypt(const string& open_text)
 {
+    LatencyTimer timer(LatencyOp::GronsfeldEncrypt, open_text.size());
+    if (mode == TextMode::PassThrough) {
+        if (open_text.empty()) {
+            throw cipher_error("Empty open text");
+        }
+        size_t phase = 0;
+        return transformChunk(open_text, phase, false);
+    }
+
     string cleanText = removeSpaces(open_text);
     if (cleanText.empty()) {
         throw cipher_error("Empty open text");
@@ -134,6 +171,15 @@ string modAlphaCipher::encrypt(const string& open_text)
  */
 string modAlphaCipher::decrypt(const string& cipher_text)
 {
+    LatencyTimer timer(LatencyOp::GronsfeldDecrypt, cipher_text.size());
+    if (mode == TextMode::PassThrough) {
+        if (cipher_text.empty()) {
+            throw cipher_error("Empty cipher text");
+        }
+        size_t phase = 0;
+        return transformChunk(cipher_text, phase, true);
+    }
+
     string cleanText = removeSpaces(cipher_text);
     if (cleanText.empty()) {
         throw cipher_error("Empty cipher text");
@@ -147,3 +193,835 @@ string modAlphaCipher::decrypt(const string& cipher_text)
     }
     return indicesToText(work);
 }
+
+/**
+ * @brief Сдвиг букв фрагмента текста с заданной фазы ключа
+ * @param [in] chunk Фрагмент текста
+ * @param [in,out] phase Позиция в ключе для первой буквы фрагмента
+ * @param [in] decrypting true для дешифрования, false для шифрования
+ * @return Преобразованный фрагмент (без пробелов в режиме Strict)
+ * @throw cipher_error если фрагмент содержит недопустимые символы
+ */
+string modAlphaCipher::transformChunk(const string& chunk, size_t& phase, bool decrypting) const
+{
+    string result(chunk.size(), '\0');
+    result.resize(transformInto(chunk.data(), chunk.size(), &result[0], phase, decrypting));
+    return result;
+}
+
+/**
+ * @brief Сдвиг букв фрагмента в заранее выделенный буфер
+ * @param [in] in Фрагмент текста
+ * @param [in] size Размер фрагмента в байтах
+ * @param [out] out Буфер не меньше size байт
+ * @param [in,out] phase Позиция в ключе для первой буквы фрагмента
+ * @param [in] decrypting true для дешифрования, false для шифрования
+ * @return Количество записанных байт
+ * @throw cipher_error если фрагмент содержит недопустимые символы
+ * @details Декодирование, сдвиг и кодирование выполняются за один
+ *          проход без промежуточного вектора индексов.
+ *
+ * В режиме PassThrough буквы алфавита в UTF-8 занимают столько же байт,
+ * сколько их замены, поэтому фрагмент копируется целиком одним memcpy,
+ * а затем на месте переписываются только буквы. Промежутки между
+ * буквами пропускаются поиском findLead без разбора символов.
+ */
+size_t modAlphaCipher::transformInto(const char* in, size_t size, char* out, size_t& phase, bool decrypting) const
+{
+    int alphabetSize = static_cast<int>(numAlpha.size() / 2);
+    size_t keySize = key.size();
+    size_t pos = phase % keySize;
+
+    if (mode == TextMode::PassThrough) {
+        memcpy(out, in, size);
+        size_t i = findLead(in, 0, size);
+        while (i + 1 < size) {
+            int idx = decodeLetter(static_cast<unsigned char>(in[i]), static_cast<unsigned char>(in[i + 1]));
+            if (idx < 0) {
+                i = findLead(in, i + 1, size);
+                continue;
+            }
+
+            idx += decrypting ? alphabetSize - key[pos] : key[pos];
+            if (idx >= alphabetSize) {
+                idx -= alphabetSize;
+            }
+            if (++pos == keySize) {
+                pos = 0;
+            }
+            out[i] = numAlpha[idx * 2];
+            out[i + 1] = numAlpha[idx * 2 + 1];
+            i = findLead(in, i + 2, size);
+        }
+        phase = pos;
+        return size;
+    }
+
+    size_t written = 0;
+    size_t i = 0;
+    while (i < size) {
+        if (in[i] == ' ') {
+            ++i;
+            continue;
+        }
+        if (i + 1 >= size) {
+            throw cipher_error("Invalid character sequence in input");
+        }
+        int idx = decodeLetter(static_cast<unsigned char>(in[i]),
+                               static_cast<unsigned char>(in[i + 1]));
+        if (idx < 0) {
+            throw cipher_error("Invalid character in input (not a Russian uppercase letter)");
+        }
+
+        idx += decrypting ? alphabetSize - key[pos] : key[pos];
+        if (idx >= alphabetSize) {
+            idx -= alphabetSize;
+        }
+        if (++pos == keySize) {
+            pos = 0;
+        }
+
+        out[written++] = numAlpha[idx * 2];
+        out[written++] = numAlpha[idx * 2 + 1];
+        i += 2;
+    }
+    phase = pos;
+    return written;
+}
+
+/**
+ * @brief Шифрование одного текста многими ключами
+ * @param [in] open_text Открытый текст
+ * @param [in] ciphers Шифры получателей (с одинаковым режимом TextMode)
+ * @return Шифротексты в порядке ciphers
+ * @throw cipher_error если текст пуст, содержит недопустимые символы
+ *        или режимы шифров различаются
+ */
+vector<string> modAlphaCipher::encryptFanOut(const string& open_text, const vector<modAlphaCipher>& ciphers)
+{
+    vector<string> outputs(ciphers.size());
+    if (ciphers.empty()) {
+        return outputs;
+    }
+    const modAlphaCipher& first = ciphers.front();
+    for (const modAlphaCipher& cipher : ciphers) {
+        if (cipher.mode != first.mode) {
+            throw cipher_error("Fan-out ciphers must share the text mode");
+        }
+    }
+    if (open_text.empty()) {
+        throw cipher_error("Empty open text");
+    }
+
+    const size_t block = 2048;
+    const uint8_t alphabetSize = static_cast<uint8_t>(first.numAlpha.size() / 2);
+    bool passThrough = first.mode == TextMode::PassThrough;
+
+    // Ключ, повторенный на длину блока: сдвиги блока с фазы p - это streams[k][p..p+n)
+    vector<vector<uint8_t>> streams(ciphers.size());
+    for (size_t k = 0; k < ciphers.size(); ++k) {
+        const vector<int>& key = ciphers[k].key;
+        streams[k].resize(block + key.size());
+        for (size_t i = 0; i < streams[k].size(); ++i) {
+            streams[k][i] = static_cast<uint8_t>(key[i % key.size()]);
+        }
+        outputs[k] = passThrough ? open_text : string(open_text.size(), '\0');
+    }
+    vector<size_t> phases(ciphers.size(), 0);
+
+    uint16_t codes[64];
+    for (uint8_t i = 0; i < alphabetSize; ++i) {
+        memcpy(&codes[i], first.numAlpha.data() + i * 2, 2);
+    }
+
+    uint8_t letters[block];
+    uint8_t shifted[block];
+    size_t offsets[block];
+    size_t pos = 0;
+    size_t written = 0;
+    while (true) {
+        size_t n = first.extractLetters(open_text, pos, letters, offsets, block);
+        if (n == 0) {
+            break;
+        }
+
+        for (size_t k = 0; k < ciphers.size(); ++k) {
+            const uint8_t* shifts = streams[k].data() + phases[k];
+            for (size_t i = 0; i < n; ++i) {
+                uint8_t v = static_cast<uint8_t>(letters[i] + shifts[i]);
+                shifted[i] = v >= alphabetSize ? static_cast<uint8_t>(v - alphabetSize) : v;
+            }
+            char* out = &outputs[k][0];
+            if (passThrough) {
+                for (size_t i = 0; i < n; ++i) {
+                    memcpy(out + offsets[i], &codes[shifted[i]], 2);
+                }
+            } else {
+                out += written * 2;
+                for (size_t i = 0; i < n; ++i) {
+                    memcpy(out + i * 2, &codes[shifted[i]], 2);
+                }
+            }
+            phases[k] = (phases[k] + n) % ciphers[k].key.size();
+        }
+        written += n;
+    }
+
+    if (!passThrough) {
+        if (written == 0) {
+            throw cipher_error("Empty open text");
+        }
+        for (string& output : outputs) {
+            output.resize(written * 2);
+        }
+    }
+    return outputs;
+}
+
+/**
+ * @brief Извлечение очередных букв текста с учётом режима
+ * @param [in] text Текст в UTF-8
+ * @param [in,out] pos Позиция в тексте
+ * @param [out] letters Индексы букв
+ * @param [out] offsets Позиции букв в тексте (только в режиме PassThrough)
+ * @param [in] capacity Размер буферов
+ * @return Количество букв; 0 - конец текста
+ */
+size_t modAlphaCipher::extractLetters(const string& text, size_t& pos, uint8_t* letters, size_t* offsets,
+                                      size_t capacity) const
+{
+    if (mode == TextMode::Strict) {
+        size_t unused = 0;
+        return decodeLetters(text, pos, letters, capacity, unused, 0);
+    }
+
+    const char* data = text.data();
+    size_t size = text.size();
+    size_t n = 0;
+    pos = findLead(data, pos, size);
+    while (n < capacity && pos + 1 < size) {
+        int idx = decodeLetter(static_cast<unsigned char>(data[pos]), static_cast<unsigned char>(data[pos + 1]));
+        if (idx < 0) {
+            pos = findLead(data, pos + 1, size);
+            continue;
+        }
+        offsets[n] = pos;
+        letters[n++] = static_cast<uint8_t>(idx);
+        pos = findLead(data, pos + 2, size);
+    }
+    if (pos + 1 >= size) {
+        pos = size;
+    }
+    return n;
+}
+
+namespace {
+
+/**
+ * @brief Позиция первого нарушения периода
+ * @param [in] s Поток
+ * @param [in] from Позиция начала проверки (не меньше period)
+ * @param [in] size Длина потока
+ * @param [in] period Проверяемый период
+ * @return Наименьшее i >= from, где s[i] != s[i - period], или size
+ */
+size_t periodBreak(const uint8_t* s, size_t from, size_t size, size_t period)
+{
+    size_t i = from;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t a, b;
+        memcpy(&a, s + i, 8);
+        memcpy(&b, s + i - period, 8);
+        if (a != b) {
+            break;
+        }
+    }
+    while (i < size && s[i] == s[i - period]) {
+        ++i;
+    }
+    return i;
+}
+
+/**
+ * @brief Наименьший период потока
+ * @param [in] s Поток
+ * @param [in] size Длина потока
+ * @param [in,out] prefix Буфер префикс-функции
+ * @return Наименьшее p, при котором s[i] == s[i - p] для всех i >= p
+ * @details Префикс-функция считается на префиксе длины known; период
+ *          префикса known - pi[known - 1] проверяется на остатке потока.
+ *          Если он нарушен в позиции m, префикс продлевается не меньше
+ *          чем до m + 1 (и хотя бы вдвое), поэтому каждая позиция
+ *          проверяется один раз и время линейно.
+ */
+size_t minimalPeriod(const uint8_t* s, size_t size, vector<uint32_t>& prefix)
+{
+    size_t known = 0;
+    size_t target = min<size_t>(size, 4096);
+    while (true) {
+        prefix.resize(target);
+        if (known == 0) {
+            prefix[0] = 0;
+        }
+        for (size_t i = max<size_t>(known, 1); i < target; ++i) {
+            uint32_t k = prefix[i - 1];
+            while (k > 0 && s[i] != s[k]) {
+                k = prefix[k - 1];
+            }
+            prefix[i] = s[i] == s[k] ? k + 1 : k;
+        }
+        known = target;
+
+        size_t period = known - prefix[known - 1];
+        size_t broken = periodBreak(s, known, size, period);
+        if (broken == size) {
+            return period;
+        }
+        target = min(size, max(broken + 1, known * 2));
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Восстановление ключа с переиспользуемыми буферами
+ * @param [in] open_text Открытый текст
+ * @param [in] cipher_text Шифротекст
+ * @param [out] shifts Буфер потока сдвигов
+ * @param [out] prefix Буфер префикс-функции
+ * @return Кратчайший ключ
+ */
+string modAlphaCipher::recoverKeyInto(const string& open_text, const string& cipher_text,
+                                      vector<uint8_t>& shifts, vector<uint32_t>& prefix) const
+{
+    const size_t block = 4096;
+    const uint8_t alphabetSize = static_cast<uint8_t>(numAlpha.size() / 2);
+    uint8_t plain[block];
+    uint8_t cipher[block];
+    size_t offsets[block];
+    size_t openPos = 0;
+    size_t cipherPos = 0;
+
+    shifts.clear();
+    while (true) {
+        size_t n = extractLetters(open_text, openPos, plain, offsets, block);
+        size_t m = extractLetters(cipher_text, cipherPos, cipher, offsets, n > 0 ? n : 1);
+        if (n != m) {
+            throw cipher_error("Open text and cipher text have different letter counts");
+        }
+        if (n == 0) {
+            break;
+        }
+        size_t base = shifts.size();
+        shifts.resize(base + n);
+        uint8_t* out = shifts.data() + base;
+        for (size_t i = 0; i < n; ++i) {
+            uint8_t d = static_cast<uint8_t>(cipher[i] + alphabetSize - plain[i]);
+            out[i] = d >= alphabetSize ? static_cast<uint8_t>(d - alphabetSize) : d;
+        }
+    }
+    if (shifts.empty()) {
+        throw cipher_error("Empty open text");
+    }
+    if (shifts.size() > UINT32_MAX) {
+        throw cipher_error("Text too long for key recovery");
+    }
+
+    size_t period = minimalPeriod(shifts.data(), shifts.size(), prefix);
+    string recovered(period * 2, '\0');
+    for (size_t i = 0; i < period; ++i) {
+        recovered[i * 2] = numAlpha[shifts[i] * 2];
+        recovered[i * 2 + 1] = numAlpha[shifts[i] * 2 + 1];
+    }
+    return recovered;
+}
+
+/**
+ * @brief Восстановление ключа по открытому тексту и шифротексту
+ * @param [in] open_text Открытый текст
+ * @param [in] cipher_text Соответствующий шифротекст
+ * @param [in] textMode Режим, в котором шифровалась пара
+ * @return Кратчайший ключ
+ */
+string modAlphaCipher::recoverKey(const string& open_text, const string& cipher_text, TextMode textMode)
+{
+    modAlphaCipher tables("А", textMode);
+    vector<uint8_t> shifts;
+    vector<uint32_t> prefix;
+    return tables.recoverKeyInto(open_text, cipher_text, shifts, prefix);
+}
+
+/**
+ * @brief Восстановление ключей для многих пар
+ * @param [in] pairs Пары (открытый текст, шифротекст)
+ * @param [in] textMode Режим, в котором шифровались пары
+ * @return Ключи в порядке пар
+ */
+vector<string> modAlphaCipher::recoverKeys(const vector<pair<string, string>>& pairs, TextMode textMode)
+{
+    modAlphaCipher tables("А", textMode);
+    vector<uint8_t> shifts;
+    vector<uint32_t> prefix;
+    vector<string> keys;
+    keys.reserve(pairs.size());
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        try {
+            keys.push_back(tables.recoverKeyInto(pairs[i].first, pairs[i].second, shifts, prefix));
+        } catch (const cipher_error& e) {
+            throw cipher_error("Pair " + to_string(i) + ": " + e.what());
+        }
+    }
+    return keys;
+}
+
+/**
+ * @brief Пакетное преобразование текста в память арены
+ * @param [in] text Текст
+ * @param [in] arena Арена для результата
+ * @param [in] decrypting true для дешифрования, false для шифрования
+ * @return Результат в памяти арены
+ */
+string_view modAlphaCipher::transformBulk(string_view text, BufferArena& arena, bool decrypting) const
+{
+    const char* empty = decrypting ? "Empty cipher text" : "Empty open text";
+    if (text.empty()) {
+        throw cipher_error(empty);
+    }
+    char* out = arena.allocateArray<char>(text.size());
+    size_t phase = 0;
+    size_t written = transformInto(text.data(), text.size(), out, phase, decrypting);
+    if (written == 0) {
+        throw cipher_error(empty);
+    }
+    return string_view(out, written);
+}
+
+/**
+ * @brief Пакетное шифрование в память арены
+ * @param [in] open_text Открытый текст
+ * @param [in] arena Арена, из которой берётся буфер результата
+ * @return Зашифрованный текст; действителен до arena.reset()
+ * @throw cipher_error если текст пуст или содержит недопустимые символы
+ */
+string_view modAlphaCipher::encryptBulk(string_view open_text, BufferArena& arena) const
+{
+    LatencyTimer timer(LatencyOp::GronsfeldBulk, open_text.size());
+    return transformBulk(open_text, arena, false);
+}
+
+/**
+ * @brief Пакетное дешифрование в память арены
+ * @param [in] cipher_text Зашифрованный текст
+ * @param [in] arena Арена, из которой берётся буфер результата
+ * @return Расшифрованный текст; действителен до arena.reset()
+ * @throw cipher_error если текст пуст или содержит недопустимые символы
+ */
+string_view modAlphaCipher::decryptBulk(string_view cipher_text, BufferArena& arena) const
+{
+    LatencyTimer timer(LatencyOp::GronsfeldBulk, cipher_text.size());
+    return transformBulk(cipher_text, arena, true);
+}
+
+/**
+ * @brief Шифрование очередного фрагмента потока
+ * @param [in] chunk Фрагмент открытого текста, разрезанный по границе символов
+ * @param [in,out] phase Позиция в ключе для первой буквы фрагмента
+ * @return Зашифрованный фрагмент (может быть пустым)
+ * @throw cipher_error если фрагмент содержит недопустимые символы
+ */
+string modAlphaCipher::encryptChunk(const string& chunk, size_t& phase) const
+{
+    return transformChunk(chunk, phase, false);
+}
+
+/**
+ * @brief Дешифрование очередного фрагмента потока
+ * @param [in] chunk Фрагмент шифротекста, разрезанный по границе символов
+ * @param [in,out] phase Позиция в ключе для первой буквы фрагмента
+ * @return Расшифрованный фрагмент (может быть пустым)
+ * @throw cipher_error если фрагмент содержит недопустимые символы
+ */
+string modAlphaCipher::decryptChunk(const string& chunk, size_t& phase) const
+{
+    return transformChunk(chunk, phase, true);
+}
+
+/**
+ * @brief Отпечаток ключа
+ * @return 64-битный хэш FNV-1a числового ключа
+ */
+uint64_t modAlphaCipher::keyFingerprint() const
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (int k : key) {
+        hash ^= static_cast<uint64_t>(k);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/**
+ * @brief Количество букв алфавита в тексте
+ * @param [in] text Текст в UTF-8
+ * @return Количество букв, на которые сдвигается позиция в ключе
+ */
+size_t modAlphaCipher::countLetters(string_view text) const
+{
+    const char* data = text.data();
+    size_t size = text.size();
+    size_t count = 0;
+    size_t i = findLead(data, 0, size);
+    while (i + 1 < size) {
+        if (decodeLetter(static_cast<unsigned char>(data[i]), static_cast<unsigned char>(data[i + 1])) >= 0) {
+            ++count;
+            i = findLead(data, i + 2, size);
+        } else {
+            i = findLead(data, i + 1, size);
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Декодирование очередных букв текста в индексы со сдвигом
+ * @param [in] text Текст в UTF-8
+ * @param [in,out] pos Позиция в тексте
+ * @param [out] out Буфер индексов
+ * @param [in] capacity Размер буфера
+ * @param [in,out] phase Позиция в ключе
+ * @param [in] shift 1 - шифрование, -1 - дешифрование, 0 - без сдвига
+ * @return Количество декодированных букв; меньше capacity только в конце текста
+ * @throw cipher_error если текст содержит недопустимые символы
+ */
+size_t modAlphaCipher::decodeLetters(const string& text, size_t& pos, uint8_t* out, size_t capacity,
+                                     size_t& phase, int shift) const
+{
+    int alphabetSize = static_cast<int>(numAlpha.size() / 2);
+    size_t keySize = key.size();
+    size_t n = 0;
+    while (n < capacity && pos < text.size()) {
+        if (text[pos] == ' ') {
+            ++pos;
+            continue;
+        }
+        if (pos + 1 >= text.size()) {
+            throw cipher_error("Invalid character sequence in input");
+        }
+        int idx = decodeLetter(static_cast<unsigned char>(text[pos]),
+                               static_cast<unsigned char>(text[pos + 1]));
+        if (idx < 0) {
+            throw cipher_error("Invalid character in input (not a Russian uppercase letter)");
+        }
+        if (shift != 0) {
+            idx += shift > 0 ? key[phase] : alphabetSize - key[phase];
+            if (idx >= alphabetSize) {
+                idx -= alphabetSize;
+            }
+            if (++phase == keySize) {
+                phase = 0;
+            }
+        }
+        out[n++] = static_cast<uint8_t>(idx);
+        pos += 2;
+    }
+    return n;
+}
+
+/**
+ * @brief Кодирование индексов в UTF-8 со сдвигом
+ * @param [in] indices Индексы букв
+ * @param [in] count Количество букв
+ * @param [in,out] phase Позиция в ключе
+ * @param [in] shift 1 - шифрование, -1 - дешифрование, 0 - без сдвига
+ * @param [out] out Строка, к которой дописываются буквы
+ * @throw cipher_error если индекс вне алфавита
+ */
+void modAlphaCipher::encodeLetters(const uint8_t* indices, size_t count, size_t& phase, int shift, string& out) const
+{
+    int alphabetSize = static_cast<int>(numAlpha.size() / 2);
+    size_t keySize = key.size();
+    size_t base = out.size();
+    out.resize(base + count * 2);
+    for (size_t i = 0; i < count; ++i) {
+        int idx = indices[i];
+        if (idx >= alphabetSize) {
+            throw cipher_error("Corrupted packed text");
+        }
+        if (shift != 0) {
+            idx += shift > 0 ? key[phase] : alphabetSize - key[phase];
+            if (idx >= alphabetSize) {
+                idx -= alphabetSize;
+            }
+            if (++phase == keySize) {
+                phase = 0;
+            }
+        }
+        out[base + i * 2] = numAlpha[idx * 2];
+        out[base + i * 2 + 1] = numAlpha[idx * 2 + 1];
+    }
+}
+
+/**
+ * @brief Размер упакованных данных
+ * @param [in] count Количество букв
+ * @param [in] format Формат упаковки
+ * @return Размер в байтах
+ */
+size_t modAlphaCipher::packedSize(size_t count, PackedFormat format)
+{
+    return format == PackedFormat::Bits6 ? (count * 6 + 7) / 8 : (count + 2) / 3 * 2;
+}
+
+/**
+ * @brief Упаковка индексов
+ * @param [in] indices Индексы букв
+ * @param [in] count Количество индексов
+ * @param [in] format Формат упаковки
+ * @param [out] out Вектор, к которому дописываются упакованные байты
+ * @details Для Bits6 восемь индексов упаковываются в 6 байт сдвигами
+ *          внутри 64-битного слова (SWAR): соседние байты сливаются
+ *          в 12-битные, затем в 24-битные и 48-битные поля
+ */
+void modAlphaCipher::packIndices(const uint8_t* indices, size_t count, PackedFormat format, vector<uint8_t>& out)
+{
+    size_t base = out.size();
+    out.resize(base + packedSize(count, format));
+    uint8_t* dst = out.data() + base;
+    size_t i = 0;
+
+    if (format == PackedFormat::Base33) {
+        for (; i < count; i += 3) {
+            unsigned v = indices[i];
+            if (i + 1 < count) {
+                v += 33 * indices[i + 1];
+            }
+            if (i + 2 < count) {
+                v += 1089 * indices[i + 2];
+            }
+            *dst++ = static_cast<uint8_t>(v & 0xFF);
+            *dst++ = static_cast<uint8_t>(v >> 8);
+        }
+        return;
+    }
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    for (; i + 8 <= count; i += 8) {
+        uint64_t x;
+        memcpy(&x, indices + i, 8);
+        x &= 0x3F3F3F3F3F3F3F3Full;
+        x = (x & 0x00FF00FF00FF00FFull) | ((x & 0xFF00FF00FF00FF00ull) >> 2);
+        x = (x & 0x0000FFFF0000FFFFull) | ((x & 0xFFFF0000FFFF0000ull) >> 4);
+        x = (x & 0x00000000FFFFFFFFull) | ((x & 0xFFFFFFFF00000000ull) >> 8);
+        memcpy(dst, &x, 6);
+        dst += 6;
+    }
+#endif
+    for (; i + 4 <= count; i += 4) {
+        uint32_t v = (indices[i] & 0x3Fu) | (indices[i + 1] & 0x3Fu) << 6 |
+                     (indices[i + 2] & 0x3Fu) << 12 | (indices[i + 3] & 0x3Fu) << 18;
+        *dst++ = static_cast<uint8_t>(v);
+        *dst++ = static_cast<uint8_t>(v >> 8);
+        *dst++ = static_cast<uint8_t>(v >> 16);
+    }
+    if (i < count) {
+        uint32_t v = 0;
+        for (size_t k = 0; i + k < count; ++k) {
+            v |= (indices[i + k] & 0x3Fu) << (6 * k);
+        }
+        for (size_t b = 0; b < packedSize(count - i, format); ++b) {
+            *dst++ = static_cast<uint8_t>(v >> (8 * b));
+        }
+    }
+}
+
+/**
+ * @brief Распаковка индексов
+ * @param [in] data Упакованные байты
+ * @param [in] count Количество индексов
+ * @param [in] format Формат упаковки
+ * @param [out] indices Буфер для count индексов
+ * @details Обратные сдвиги SWAR раскладывают 6 байт в 8 индексов
+ */
+void modAlphaCipher::unpackIndices(const uint8_t* data, size_t count, PackedFormat format, uint8_t* indices)
+{
+    const uint8_t* src = data;
+    size_t i = 0;
+
+    if (format == PackedFormat::Base33) {
+        for (; i < count; i += 3) {
+            unsigned v = src[0] | static_cast<unsigned>(src[1]) << 8;
+            src += 2;
+            indices[i] = static_cast<uint8_t>(v % 33);
+            if (i + 1 < count) {
+                indices[i + 1] = static_cast<uint8_t>(v / 33 % 33);
+            }
+            if (i + 2 < count) {
+                // Значение больше 32 означает повреждённые данные
+                indices[i + 2] = static_cast<uint8_t>(min(v / 1089, 255u));
+            }
+        }
+        return;
+    }
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    for (; i + 8 <= count; i += 8) {
+        uint64_t x = 0;
+        memcpy(&x, src, 6);
+        x = (x & 0x0000000000FFFFFFull) | ((x & 0x0000FFFFFF000000ull) << 8);
+        x = (x & 0x00000FFF00000FFFull) | ((x & 0x00FFF00000FFF000ull) << 4);
+        x = (x & 0x003F003F003F003Full) | ((x & 0x0FC00FC00FC00FC0ull) << 2);
+        memcpy(indices + i, &x, 8);
+        src += 6;
+    }
+#endif
+    for (; i + 4 <= count; i += 4) {
+        uint32_t v = src[0] | static_cast<uint32_t>(src[1]) << 8 | static_cast<uint32_t>(src[2]) << 16;
+        src += 3;
+        indices[i] = v & 0x3F;
+        indices[i + 1] = (v >> 6) & 0x3F;
+        indices[i + 2] = (v >> 12) & 0x3F;
+        indices[i + 3] = (v >> 18) & 0x3F;
+    }
+    if (i < count) {
+        uint32_t v = 0;
+        for (size_t b = 0; b < packedSize(count - i, format); ++b) {
+            v |= static_cast<uint32_t>(src[b]) << (8 * b);
+        }
+        for (size_t k = 0; i + k < count; ++k) {
+            indices[i + k] = (v >> (6 * k)) & 0x3F;
+        }
+    }
+}
+
+/**
+ * @brief Упаковка текста с необязательным сдвигом
+ * @details Буквы обрабатываются блоками по 1536 (кратно и 4, и 3),
+ *          чтобы индексы оставались в кэше первого уровня
+ */
+PackedText modAlphaCipher::packText(const string& text, PackedFormat format, int shift) const
+{
+    PackedText packed;
+    packed.format = format;
+    packed.data.reserve(packedSize(text.size() / 2, format));
+    uint8_t block[1536];
+    size_t pos = 0;
+    size_t phase = 0;
+    for (;;) {
+        size_t n = decodeLetters(text, pos, block, sizeof(block), phase, shift);
+        if (n == 0) {
+            break;
+        }
+        packIndices(block, n, format, packed.data);
+        packed.count += n;
+    }
+    return packed;
+}
+
+/**
+ * @brief Распаковка текста с необязательным сдвигом
+ */
+string modAlphaCipher::unpackText(const PackedText& packed, int shift) const
+{
+    if (packed.data.size() != packedSize(packed.count, packed.format)) {
+        throw cipher_error("Corrupted packed text");
+    }
+    string result;
+    result.reserve(packed.count * 2);
+    uint8_t block[1536];
+    const uint8_t* src = packed.data.data();
+    size_t phase = 0;
+    for (size_t done = 0; done < packed.count;) {
+        size_t n = min(sizeof(block), packed.count - done);
+        unpackIndices(src, n, packed.format, block);
+        src += packedSize(n, packed.format);
+        encodeLetters(block, n, phase, shift, result);
+        done += n;
+    }
+    return result;
+}
+
+/**
+ * @brief Шифрование сразу в упакованный вид
+ * @param [in] open_text Открытый текст
+ * @param [in] format Формат упаковки
+ * @return Упакованный шифротекст
+ * @throw cipher_error если текст пуст или содержит недопустимые символы
+ */
+PackedText modAlphaCipher::encryptPacked(const string& open_text, PackedFormat format) const
+{
+    PackedText packed = packText(open_text, format, 1);
+    if (packed.count == 0) {
+        throw cipher_error("Empty open text");
+    }
+    return packed;
+}
+
+/**
+ * @brief Дешифрование из упакованного вида
+ * @param [in] packed Упакованный шифротекст
+ * @return Расшифрованный текст
+ * @throw cipher_error если упакованные данные повреждены
+ */
+string modAlphaCipher::decryptPacked(const PackedText& packed) const
+{
+    if (packed.count == 0) {
+        throw cipher_error("Empty cipher text");
+    }
+    return unpackText(packed, -1);
+}
+
+/**
+ * @brief Упаковка готового текста без шифрования
+ * @param [in] text Текст из букв алфавита и пробелов
+ * @param [in] format Формат упаковки
+ * @return Упакованный текст
+ * @throw cipher_error если текст пуст или содержит недопустимые символы
+ */
+PackedText modAlphaCipher::pack(const string& text, PackedFormat format) const
+{
+    PackedText packed = packText(text, format, 0);
+    if (packed.count == 0) {
+        throw cipher_error("Empty text after processing");
+    }
+    return packed;
+}
+
+/**
+ * @brief Распаковка текста в UTF-8 без дешифрования
+ * @param [in] packed Упакованный текст
+ * @return Текст в UTF-8
+ * @throw cipher_error если упакованные данные повреждены
+ */
+string modAlphaCipher::unpack(const PackedText& packed) const
+{
+    return unpackText(packed, 0);
+}
+
+/**
+ * @brief Поиск следующего байта, который может начинать букву алфавита
+ * @param [in] data Начало текста
+ * @param [in] from Позиция начала поиска
+ * @param [in] size Размер текста
+ * @return Позиция найденного байта или size
+ */
+size_t modAlphaCipher::findLead(const char* data, size_t from, size_t size) const
+{
+    size_t i = from;
+#ifdef __SSE2__
+    const __m128i mask = _mm_set1_epi8(static_cast<char>(leadMask));
+    const __m128i value = _mm_set1_epi8(static_cast<char>(leadValue));
+    for (; i + 16 <= size; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        int hits = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(bytes, mask), value));
+        if (hits != 0) {
+            return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(hits)));
+        }
+    }
+#endif
+    for (; i < size; ++i) {
+        if ((static_cast<unsigned char>(data[i]) & leadMask) == leadValue) {
+            return i;
+        }
+    }
+    return size;
+}
@@ -12,8 +12,13 @@
 #define MODALPHACIPHER_H
 
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 #include <stdexcept>
+#include <cstdint>
+
+class BufferArena;
 
 /**
  * @brief Класс исключений для модуля шифрования
@@ -34,6 +39,33 @@ public:
     explicit cipher_error(const char* what_arg) : std::invalid_argument(what_arg) {}
 };
 
+/**
+ * @brief Режим обработки символов вне алфавита
+ */
+enum class TextMode : uint8_t {
+    Strict = 0,     ///< Пробелы удаляются, остальные символы вне алфавита - ошибка
+    PassThrough = 1 ///< Все символы вне алфавита (включая пробелы) копируются без изменений
+};
+
+/**
+ * @brief Формат упаковки индексов букв
+ */
+enum class PackedFormat : uint8_t {
+    Bits6 = 0,  ///< По 6 бит на букву: 4 буквы в 3 байтах
+    Base33 = 1  ///< Три буквы числом по основанию 33 в 16 битах
+};
+
+/**
+ * @brief Текст в упакованном виде
+ * @details Хранит индексы букв алфавита без UTF-8: 0,75 байта на букву
+ *          для Bits6 и 2/3 байта для Base33 вместо 2 байт в UTF-8
+ */
+struct PackedText {
+    PackedFormat format = PackedFormat::Bits6; ///< Формат упаковки
+    size_t count = 0; ///< Количество букв
+    std::vector<uint8_t> data; ///< Упакованные индексы
+};
+
 /**
  * @brief Класс для шифрования методом Гронсфельда
  * @details Реализует шифрование и дешифрование текста на русском языке
@@ -42,9 +74,143 @@ public:
  */
 class modAlphaCipher
 {
+    friend class CascadeCipher;
+    friend class RunningKeyCipher;
+    friend class EncryptedDocument;
+    friend class BatchProcessor;
+
 private:
     const std::string numAlpha = "АБВГДЕЁЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯ"; ///< Русский алфавит в верхнем регистре
     std::vector<int> key; ///< Ключ в числовом виде
+    std::vector<signed char> decodeTable; ///< Таблица декодирования двухбайтовых символов UTF-8 в индексы алфавита
+    TextMode mode = TextMode::Strict; ///< Режим обработки символов вне алфавита
+    unsigned char leadMask = 0xE0; ///< Маска первого байта буквы алфавита
+    unsigned char leadValue = 0xC0; ///< Значение первого байта буквы алфавита под маской
+
+    /**
+     * @brief Построение таблицы декодирования алфавита
+     * @details Индекс таблицы составляется из значащих битов первого
+     *          и второго байтов символа UTF-8, значение -1 означает
+     *          символ вне алфавита
+     */
+    void buildDecodeTable();
+
+    /**
+     * @brief Поиск индекса символа в алфавите
+     * @param [in] lead Первый байт символа UTF-8
+     * @param [in] trail Второй байт символа UTF-8
+     * @return Индекс символа в алфавите или -1, если символ не из алфавита
+     */
+    int decodeLetter(unsigned char lead, unsigned char trail) const
+    {
+        if ((lead & 0xE0) != 0xC0 || (trail & 0xC0) != 0x80) {
+            return -1;
+        }
+        return decodeTable[((lead & 0x1F) << 6) | (trail & 0x3F)];
+    }
+
+    /**
+     * @brief Сдвиг букв фрагмента текста с заданной фазы ключа
+     * @param [in] chunk Фрагмент текста
+     * @param [in,out] phase Позиция в ключе для первой буквы фрагмента
+     * @param [in] decrypting true для дешифрования, false для шифрования
+     * @return Преобразованный фрагмент (без пробелов в режиме Strict)
+     * @throw cipher_error если фрагмент содержит недопустимые символы
+     */
+    std::string transformChunk(const std::string& chunk, size_t& phase, bool decrypting) const;
+
+    /**
+     * @brief Сдвиг букв фрагмента в заранее выделенный буфер
+     * @param [in] in Фрагмент текста
+     * @param [in] size Размер фрагмента в байтах
+     * @param [out] out Буфер не меньше size байт
+     * @param [in,out] phase Позиция в ключе для первой буквы фрагмента
+     * @param [in] decrypting true для дешифрования, false для шифрования
+     * @return Количество записанных байт
+     * @throw cipher_error если фрагмент содержит недопустимые символы
+     * @details Ядро transformChunk и пакетного режима; в режиме PassThrough
+     *          записывает ровно size байт
+     */
+    size_t transformInto(const char* in, size_t size, char* out, size_t& phase, bool decrypting) const;
+
+    /**
+     * @brief Поиск следующего байта, который может начинать букву алфавита
+     * @param [in] data Начало текста
+     * @param [in] from Позиция начала поиска
+     * @param [in] size Размер текста
+     * @return Позиция найденного байта или size
+     * @details Просматривает по 16 байт за шаг командами SSE2
+     */
+    size_t findLead(const char* data, size_t from, size_t size) const;
+
+    /**
+     * @brief Пакетное преобразование текста в память арены
+     * @param [in] text Текст
+     * @param [in] arena Арена для результата
+     * @param [in] decrypting true для дешифрования, false для шифрования
+     * @return Результат в памяти арены
+     */
+    std::string_view transformBulk(std::string_view text, BufferArena& arena, bool decrypting) const;
+
+    /**
+     * @brief Декодирование очередных букв текста в индексы со сдвигом
+     * @param [in] text Текст в UTF-8
+     * @param [in,out] pos Позиция в тексте
+     * @param [out] out Буфер индексов
+     * @param [in] capacity Размер буфера
+     * @param [in,out] phase Позиция в ключе
+     * @param [in] shift 1 - шифрование, -1 - дешифрование, 0 - без сдвига
+     * @return Количество декодированных букв (пробелы пропускаются)
+     * @throw cipher_error если текст содержит недопустимые символы
+     */
+    size_t decodeLetters(const std::string& text, size_t& pos, uint8_t* out, size_t capacity,
+                         size_t& phase, int shift) const;
+
+    /**
+     * @brief Кодирование индексов в UTF-8 со сдвигом
+     * @param [in] indices Индексы букв
+     * @param [in] count Количество букв
+     * @param [in,out] phase Позиция в ключе
+     * @param [in] shift 1 - шифрование, -1 - дешифрование, 0 - без сдвига
+     * @param [out] out Строка, к которой дописываются буквы
+     * @throw cipher_error если индекс вне алфавита
+     */
+    void encodeLetters(const uint8_t* indices, size_t count, size_t& phase, int shift, std::string& out) const;
+
+    /**
+     * @brief Извлечение очередных букв текста с учётом режима
+     * @param [in] text Текст в UTF-8
+     * @param [in,out] pos Позиция в тексте
+     * @param [out] letters Индексы букв
+     * @param [out] offsets Позиции букв в тексте (только в режиме PassThrough)
+     * @param [in] capacity Размер буферов
+     * @return Количество букв; 0 - конец текста
+     * @throw cipher_error если в режиме Strict текст содержит недопустимые символы
+     */
+    size_t extractLetters(const std::string& text, size_t& pos, uint8_t* letters, size_t* offsets,
+                          size_t capacity) const;
+
+    /**
+     * @brief Восстановление ключа с переиспользуемыми буферами
+     * @param [in] open_text Открытый текст
+     * @param [in] cipher_text Шифротекст
+     * @param [out] shifts Буфер потока сдвигов
+     * @param [out] prefix Буфер префикс-функции
+     * @return Кратчайший ключ
+     * @throw cipher_error если тексты пусты, не выровнены или содержат недопустимые символы
+     */
+    std::string recoverKeyInto(const std::string& open_text, const std::string& cipher_text,
+                               std::vector<uint8_t>& shifts, std::vector<uint32_t>& prefix) const;
+
+    /**
+     * @brief Упаковка текста с необязательным сдвигом
+     */
+    PackedText packText(const std::string& text, PackedFormat format, int shift) const;
+
+    /**
+     * @brief Распаковка текста с необязательным сдвигом
+     */
+    std::string unpackText(const PackedText& packed, int shift) const;
 
     /**
      * @brief Удаление пробелов из строки
@@ -74,9 +240,12 @@ public:
     /**
      * @brief Основной конструктор с ключом
      * @param [in] skey Ключ шифрования в виде строки
+     * @param [in] textMode Режим обработки символов вне алфавита
      * @throw cipher_error если ключ пуст или содержит недопустимые символы
+     * @details Режим влияет на encrypt, decrypt, encryptChunk и decryptChunk.
+     *          В режиме PassThrough ключ по-прежнему сдвигается только на буквах.
      */
-    modAlphaCipher(const std::string& skey);
+    modAlphaCipher(const std::string& skey, TextMode textMode = TextMode::Strict);
     
     /**
      * @brief Шифрование открытого текста
@@ -93,6 +262,191 @@ public:
      * @throw cipher_error если текст пуст или содержит недопустимые символы
      */
     std::string decrypt(const std::string& cipher_text);
+
+    /**
+     * @brief Шифрование очередного фрагмента потока
+     * @param [in] chunk Фрагмент открытого текста, разрезанный по границе символов
+     * @param [in,out] phase Позиция в ключе для первой буквы фрагмента,
+     *                 после вызова указывает на позицию для следующего фрагмента
+     * @return Зашифрованный фрагмент (может быть пустым)
+     * @throw cipher_error если фрагмент содержит недопустимые символы
+     * @details Конкатенация результатов для последовательных фрагментов
+     *          совпадает с результатом encrypt() для всего текста
+     */
+    std::string encryptChunk(const std::string& chunk, size_t& phase) const;
+
+    /**
+     * @brief Дешифрование очередного фрагмента потока
+     * @param [in] chunk Фрагмент шифротекста, разрезанный по границе символов
+     * @param [in,out] phase Позиция в ключе для первой буквы фрагмента
+     * @return Расшифрованный фрагмент (может быть пустым)
+     * @throw cipher_error если фрагмент содержит недопустимые символы
+     */
+    std::string decryptChunk(const std::string& chunk, size_t& phase) const;
+
+    /**
+     * @brief Шифрование одного текста многими ключами
+     * @param [in] open_text Открытый текст
+     * @param [in] ciphers Шифры получателей (с одинаковым режимом TextMode)
+     * @return Шифротексты в порядке ciphers; i-й совпадает с ciphers[i].encrypt(open_text)
+     * @throw cipher_error если текст пуст, содержит недопустимые символы
+     *        или режимы шифров различаются
+     * @details Текст проверяется и декодируется в индексы один раз. Индексы
+     *          обрабатываются блоками по 2048 букв: блок остаётся в кэше L1,
+     *          пока к нему применяются все ключи. Сдвиг блока одним ключом -
+     *          сложение с развёрнутым заранее ключом и вычитание модуля, этот
+     *          цикл компилятор векторизует.
+     */
+    static std::vector<std::string> encryptFanOut(const std::string& open_text,
+                                                  const std::vector<modAlphaCipher>& ciphers);
+
+    /**
+     * @brief Восстановление ключа по открытому тексту и шифротексту
+     * @param [in] open_text Открытый текст
+     * @param [in] cipher_text Соответствующий шифротекст
+     * @param [in] textMode Режим, в котором шифровалась пара
+     * @return Кратчайший ключ, с которым encrypt(open_text) даёт cipher_text
+     * @throw cipher_error если тексты пусты, содержат недопустимые символы
+     *        или количество букв в них различается
+     * @details За один проход по буквам пары строится поток сдвигов
+     *          (разность индексов по модулю размера алфавита; цикл
+     *          векторизуется). Наименьший период потока ищется
+     *          префикс-функцией (КМП): она считается на растущем префиксе,
+     *          а найденный период проверяется на остатке потока, так что
+     *          время линейно, а префикс-функция хранится только на длину
+     *          порядка периода. Если ключ короче пары, он находится
+     *          однозначно; если пара короче ключа, возвращается её поток
+     *          сдвигов целиком.
+     */
+    static std::string recoverKey(const std::string& open_text, const std::string& cipher_text,
+                                  TextMode textMode = TextMode::Strict);
+
+    /**
+     * @brief Восстановление ключей для многих пар
+     * @param [in] pairs Пары (открытый текст, шифротекст)
+     * @param [in] textMode Режим, в котором шифровались пары
+     * @return Ключи в порядке пар
+     * @throw cipher_error с номером пары, если одна из пар некорректна
+     * @details Таблицы алфавита и буферы потока сдвигов и префикс-функции
+     *          создаются один раз на все пары
+     */
+    static std::vector<std::string> recoverKeys(const std::vector<std::pair<std::string, std::string>>& pairs,
+                                                TextMode textMode = TextMode::Strict);
+
+    /**
+     * @brief Пакетное шифрование в память арены
+     * @param [in] open_text Открытый текст
+     * @param [in] arena Арена, из которой берётся буфер результата
+     * @return Зашифрованный текст; действителен до arena.reset()
+     * @throw cipher_error если текст пуст или содержит недопустимые символы
+     * @throw arena_error если арене не хватило памяти
+     * @details Результат совпадает с encrypt(), но текст проходится один раз
+     *          без промежуточных строк и вектора индексов, а буфер результата
+     *          переиспользуется между вызовами
+     */
+    std::string_view encryptBulk(std::string_view open_text, BufferArena& arena) const;
+
+    /**
+     * @brief Пакетное дешифрование в память арены
+     * @param [in] cipher_text Зашифрованный текст
+     * @param [in] arena Арена, из которой берётся буфер результата
+     * @return Расшифрованный текст; действителен до arena.reset()
+     * @throw cipher_error если текст пуст или содержит недопустимые символы
+     * @throw arena_error если арене не хватило памяти
+     */
+    std::string_view decryptBulk(std::string_view cipher_text, BufferArena& arena) const;
+
+    /**
+     * @brief Отпечаток ключа
+     * @return 64-битный хэш FNV-1a числового ключа
+     * @details Позволяет проверить, что шифротекст расшифровывается тем же
+     *          ключом, не сохраняя сам ключ
+     */
+    uint64_t keyFingerprint() const;
+
+    /**
+     * @brief Режим обработки символов вне алфавита
+     */
+    TextMode textMode() const { return mode; }
+
+    /**
+     * @brief Количество букв алфавита в тексте
+     * @param [in] text Текст в UTF-8
+     * @return Количество букв, на которые сдвигается позиция в ключе
+     * @details Позволяет вычислить фазу ключа для любого фрагмента текста
+     *          и шифровать фрагменты независимо друг от друга
+     */
+    size_t countLetters(std::string_view text) const;
+
+    /**
+     * @brief Длина ключа
+     * @return Количество сдвигов в ключе
+     */
+    size_t keyLength() const { return key.size(); }
+
+    /**
+     * @brief Шифрование сразу в упакованный вид
+     * @param [in] open_text Открытый текст
+     * @param [in] format Формат упаковки
+     * @return Упакованный шифротекст
+     * @throw cipher_error если текст пуст или содержит недопустимые символы
+     * @details Буквы декодируются, сдвигаются и упаковываются небольшими
+     *          блоками, шифротекст в UTF-8 не строится
+     */
+    PackedText encryptPacked(const std::string& open_text, PackedFormat format = PackedFormat::Bits6) const;
+
+    /**
+     * @brief Дешифрование из упакованного вида
+     * @param [in] packed Упакованный шифротекст
+     * @return Расшифрованный текст
+     * @throw cipher_error если упакованные данные повреждены
+     */
+    std::string decryptPacked(const PackedText& packed) const;
+
+    /**
+     * @brief Упаковка готового текста (например, архивного шифротекста) без шифрования
+     * @param [in] text Текст из букв алфавита и пробелов
+     * @param [in] format Формат упаковки
+     * @return Упакованный текст
+     * @throw cipher_error если текст пуст или содержит недопустимые символы
+     */
+    PackedText pack(const std::string& text, PackedFormat format = PackedFormat::Bits6) const;
+
+    /**
+     * @brief Распаковка текста в UTF-8 без дешифрования
+     * @param [in] packed Упакованный текст
+     * @return Текст в UTF-8
+     * @throw cipher_error если упакованные данные повреждены
+     */
+    std::string unpack(const PackedText& packed) const;
+
+    /**
+     * @brief Упаковка индексов
+     * @param [in] indices Индексы букв (каждый меньше 64, для Base33 - меньше 33)
+     * @param [in] count Количество индексов
+     * @param [in] format Формат упаковки
+     * @param [out] out Вектор, к которому дописываются упакованные байты
+     * @details Может вызываться порциями; для Bits6 порция кроме последней
+     *          должна быть кратна 4, для Base33 - кратна 3
+     */
+    static void packIndices(const uint8_t* indices, size_t count, PackedFormat format, std::vector<uint8_t>& out);
+
+    /**
+     * @brief Распаковка индексов
+     * @param [in] data Упакованные байты, начиная с первой распаковываемой буквы
+     * @param [in] count Количество индексов
+     * @param [in] format Формат упаковки
+     * @param [out] indices Буфер для count индексов
+     */
+    static void unpackIndices(const uint8_t* data, size_t count, PackedFormat format, uint8_t* indices);
+
+    /**
+     * @brief Размер упакованных данных
+     * @param [in] count Количество букв
+     * @param [in] format Формат упаковки
+     * @return Размер в байтах
+     */
+    static size_t packedSize(size_t count, PackedFormat format);
 };
 
 #endif // MODALPHACIPHER_H